@@ -2,9 +2,11 @@
 #include "diag_console.h"
 #include "events.h"
 #include "board.h"
+#include "boot_profile.h"
 #include "fw_version.h"
 #include "motor.h"
 #include "neopixel.h"
+#include "nvs_storage.h"
 #include "ir_emitter.h"
 #include "ir_sensor.h"
 #include "loadcell_scale.h"
@@ -17,18 +19,37 @@ void app_main(void)
     // Must run first: prevents any unintended motor twitch before the console/monitor attaches.
     board_force_motor_pins_safe_early();
     printf("\nFW0002 boot v%s (%s)\n", FW_VERSION, FW_BUILD);
+    boot_profile_begin(BOOT_PHASE_EVENTS_INIT);
     events_init();
+    boot_profile_end(BOOT_PHASE_EVENTS_INIT);
     events_emit("boot_reset", "system", (int)esp_reset_reason(), reset_reason_to_str(esp_reset_reason()));
+    boot_profile_begin(BOOT_PHASE_NVS_INIT);
+    nvs_storage_init();
+    boot_profile_end(BOOT_PHASE_NVS_INIT);
+    boot_profile_begin(BOOT_PHASE_BOARD_INIT_SAFE);
     board_init_safe();
+    boot_profile_end(BOOT_PHASE_BOARD_INIT_SAFE);
+    boot_profile_begin(BOOT_PHASE_MOTOR_INIT);
     motor_init();
+    boot_profile_end(BOOT_PHASE_MOTOR_INIT);
+    boot_profile_begin(BOOT_PHASE_NEOPIXEL_INIT);
     neopixel_init();
+    boot_profile_end(BOOT_PHASE_NEOPIXEL_INIT);
+    boot_profile_begin(BOOT_PHASE_IR_EMITTER_INIT);
     ir_emitter_init();
+    boot_profile_end(BOOT_PHASE_IR_EMITTER_INIT);
+    boot_profile_begin(BOOT_PHASE_IR_SENSOR_INIT);
     ir_sensor_init();
+    boot_profile_end(BOOT_PHASE_IR_SENSOR_INIT);
+    boot_profile_begin(BOOT_PHASE_LOADCELL_INIT);
     loadcell_scale_init();
+    boot_profile_end(BOOT_PHASE_LOADCELL_INIT);
     neopixel_set_mode(NEOPIXEL_MODE_BOOTING);
     // Boot-time motor canary: only run when explicitly enabled.
 #if defined(CONFIG_FW_BOOT_ACCEPTANCETEST_ON_BOOT) && CONFIG_FW_BOOT_ACCEPTANCETEST_ON_BOOT
     diag_console_run_startup_acceptancetest();
 #endif
+    // Ended inside diag_console_start() once the prompt is up (it never returns).
+    boot_profile_begin(BOOT_PHASE_CONSOLE_START);
     diag_console_start();
 }
@@ -0,0 +1,134 @@
+#include "boot_profile.h"
+
+#include <stdio.h>
+
+#include "esp_timer.h"
+#include "fw_version.h"
+
+typedef struct
+{
+    int64_t start_us;
+    int64_t end_us;
+} boot_phase_record_t;
+
+static const char *const k_phase_names[BOOT_PHASE_COUNT] = {
+    [BOOT_PHASE_EVENTS_INIT] = "events_init",
+    [BOOT_PHASE_NVS_INIT] = "nvs_init",
+    [BOOT_PHASE_BOARD_INIT_SAFE] = "board_init_safe",
+    [BOOT_PHASE_MOTOR_INIT] = "motor_init",
+    [BOOT_PHASE_NEOPIXEL_INIT] = "neopixel_init",
+    [BOOT_PHASE_IR_EMITTER_INIT] = "ir_emitter_init",
+    [BOOT_PHASE_IR_SENSOR_INIT] = "ir_sensor_init",
+    [BOOT_PHASE_LOADCELL_INIT] = "loadcell_scale_init",
+    [BOOT_PHASE_CONSOLE_START] = "console_start",
+};
+
+static boot_phase_record_t s_phases[BOOT_PHASE_COUNT];
+
+void boot_profile_begin(boot_phase_t phase)
+{
+    if (phase < BOOT_PHASE_COUNT)
+    {
+        s_phases[phase].start_us = esp_timer_get_time();
+    }
+}
+
+void boot_profile_end(boot_phase_t phase)
+{
+    if (phase < BOOT_PHASE_COUNT)
+    {
+        s_phases[phase].end_us = esp_timer_get_time();
+    }
+}
+
+static int64_t boot_phase_duration(const boot_phase_record_t *rec)
+{
+    if (rec->start_us == 0 || rec->end_us < rec->start_us)
+    {
+        return -1;
+    }
+    return rec->end_us - rec->start_us;
+}
+
+const char *boot_profile_phase_name(boot_phase_t phase)
+{
+    return (phase < BOOT_PHASE_COUNT) ? k_phase_names[phase] : "unknown";
+}
+
+int64_t boot_profile_phase_duration_us(boot_phase_t phase)
+{
+    return (phase < BOOT_PHASE_COUNT) ? boot_phase_duration(&s_phases[phase]) : -1;
+}
+
+int64_t boot_profile_total_us(void)
+{
+    return s_phases[BOOT_PHASE_CONSOLE_START].end_us;
+}
+
+bool boot_profile_write_json(json_writer_t *w)
+{
+    bool ok = json_obj_begin(w) &&
+              json_kv_str(w, "fw_build", FW_BUILD) &&
+              json_kv_i64(w, "app_start_us", s_phases[0].start_us) &&
+              json_write_key(w, "phases") &&
+              json_arr_begin(w);
+    for (size_t i = 0; ok && i < BOOT_PHASE_COUNT; ++i)
+    {
+        int64_t dur = boot_phase_duration(&s_phases[i]);
+        ok = json_obj_begin(w) && json_kv_str(w, "name", k_phase_names[i]);
+        if (dur >= 0)
+        {
+            ok = ok && json_kv_i64(w, "start_us", s_phases[i].start_us) && json_kv_i64(w, "dur_us", dur);
+        }
+        else
+        {
+            ok = ok && json_kv_null(w, "start_us") && json_kv_null(w, "dur_us");
+        }
+        ok = ok && json_obj_end(w);
+    }
+    ok = ok && json_arr_end(w);
+    const boot_phase_record_t *last = &s_phases[BOOT_PHASE_CONSOLE_START];
+    if (last->end_us > 0)
+    {
+        ok = ok && json_kv_i64(w, "total_us", last->end_us);
+    }
+    else
+    {
+        ok = ok && json_kv_null(w, "total_us");
+    }
+    return ok && json_obj_end(w);
+}
+
+bool boot_profile_get_json(char *buf, size_t len)
+{
+    if (buf == NULL || len == 0)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return boot_profile_write_json(&w);
+}
+
+bool boot_profile_write_summary_json(json_writer_t *w)
+{
+    if (!json_obj_begin(w))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < BOOT_PHASE_COUNT; ++i)
+    {
+        if (!json_kv_i64(w, k_phase_names[i], boot_phase_duration(&s_phases[i])))
+        {
+            return false;
+        }
+    }
+    return json_kv_i64(w, "total_us", s_phases[BOOT_PHASE_CONSOLE_START].end_us) && json_obj_end(w);
+}
+
+bool boot_profile_get_summary_json(char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return boot_profile_write_summary_json(&w);
+}
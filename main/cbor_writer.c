@@ -0,0 +1,169 @@
+#include "cbor_writer.h"
+
+#include <string.h>
+
+#define CBOR_MAJOR_UINT 0U
+#define CBOR_MAJOR_NINT 1U
+#define CBOR_MAJOR_TEXT 3U
+#define CBOR_MAJOR_ARRAY 4U
+#define CBOR_MAJOR_MAP 5U
+#define CBOR_MAJOR_SIMPLE 7U
+
+#define CBOR_SIMPLE_FALSE 20U
+#define CBOR_SIMPLE_TRUE 21U
+#define CBOR_SIMPLE_NULL 22U
+#define CBOR_AI_FLOAT32 26U
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t len)
+{
+    if (w == NULL)
+    {
+        return;
+    }
+    w->buf = buf;
+    w->len = (buf != NULL) ? len : 0;
+    w->used = 0;
+    w->overflow = false;
+}
+
+static bool cbor_reserve(cbor_writer_t *w, size_t n)
+{
+    if (w == NULL || w->overflow)
+    {
+        return false;
+    }
+    if (n > w->len - w->used)
+    {
+        w->overflow = true;
+        return false;
+    }
+    return true;
+}
+
+// Initial byte plus the shortest big-endian argument (0, 1, 2, 4 or 8 bytes).
+static bool cbor_write_head(cbor_writer_t *w, uint8_t major, uint64_t arg)
+{
+    uint8_t ai;
+    size_t extra;
+    if (arg < 24U)
+    {
+        ai = (uint8_t)arg;
+        extra = 0;
+    }
+    else if (arg <= UINT8_MAX)
+    {
+        ai = 24;
+        extra = 1;
+    }
+    else if (arg <= UINT16_MAX)
+    {
+        ai = 25;
+        extra = 2;
+    }
+    else if (arg <= UINT32_MAX)
+    {
+        ai = 26;
+        extra = 4;
+    }
+    else
+    {
+        ai = 27;
+        extra = 8;
+    }
+    if (!cbor_reserve(w, 1 + extra))
+    {
+        return false;
+    }
+    uint8_t *p = &w->buf[w->used];
+    p[0] = (uint8_t)((major << 5) | ai);
+    for (size_t i = 0; i < extra; ++i)
+    {
+        p[1 + i] = (uint8_t)(arg >> (8U * (extra - 1U - i)));
+    }
+    w->used += 1 + extra;
+    return true;
+}
+
+bool cbor_write_uint(cbor_writer_t *w, uint64_t value)
+{
+    return cbor_write_head(w, CBOR_MAJOR_UINT, value);
+}
+
+bool cbor_write_int(cbor_writer_t *w, int64_t value)
+{
+    if (value >= 0)
+    {
+        return cbor_write_head(w, CBOR_MAJOR_UINT, (uint64_t)value);
+    }
+    // -1 - n without overflowing at INT64_MIN.
+    return cbor_write_head(w, CBOR_MAJOR_NINT, ~(uint64_t)value);
+}
+
+bool cbor_write_bool(cbor_writer_t *w, bool value)
+{
+    return cbor_write_head(w, CBOR_MAJOR_SIMPLE, value ? CBOR_SIMPLE_TRUE : CBOR_SIMPLE_FALSE);
+}
+
+bool cbor_write_null(cbor_writer_t *w)
+{
+    return cbor_write_head(w, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_NULL);
+}
+
+bool cbor_write_float(cbor_writer_t *w, float value)
+{
+    if (!cbor_reserve(w, 5))
+    {
+        return false;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t *p = &w->buf[w->used];
+    p[0] = (uint8_t)((CBOR_MAJOR_SIMPLE << 5) | CBOR_AI_FLOAT32);
+    p[1] = (uint8_t)(bits >> 24);
+    p[2] = (uint8_t)(bits >> 16);
+    p[3] = (uint8_t)(bits >> 8);
+    p[4] = (uint8_t)bits;
+    w->used += 5;
+    return true;
+}
+
+bool cbor_write_text_n(cbor_writer_t *w, const char *s, size_t n)
+{
+    if (s == NULL && n > 0)
+    {
+        return false;
+    }
+    if (!cbor_write_head(w, CBOR_MAJOR_TEXT, n))
+    {
+        return false;
+    }
+    if (!cbor_reserve(w, n))
+    {
+        return false;
+    }
+    if (n > 0)
+    {
+        memcpy(&w->buf[w->used], s, n);
+    }
+    w->used += n;
+    return true;
+}
+
+bool cbor_write_text(cbor_writer_t *w, const char *s)
+{
+    if (s == NULL)
+    {
+        return false;
+    }
+    return cbor_write_text_n(w, s, strlen(s));
+}
+
+bool cbor_write_map(cbor_writer_t *w, size_t pairs)
+{
+    return cbor_write_head(w, CBOR_MAJOR_MAP, pairs);
+}
+
+bool cbor_write_array(cbor_writer_t *w, size_t items)
+{
+    return cbor_write_head(w, CBOR_MAJOR_ARRAY, items);
+}
@@ -4,28 +4,42 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "esp_console.h"
+#include "esp_cpu.h"
 #include "esp_err.h"
+#include "esp_rom_sys.h"
 #include "esp_system.h"
 #include "esp_timer.h"
 
 #include "json_helpers.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 #include "linenoise/linenoise.h"
 #include "argtable3/argtable3.h"
 #include "events.h"
 #include "snapshot.h"
+#include "snapshot_contract.h"
+#include "snapshot_watch.h"
 #include "remote_actions.h"
 #include "fw_version.h"
 #include "board.h"
 #include "motor.h"
 #include "stepper_driver_uart.h"
+#include "tmc_frame.h"
+#include "boot_profile.h"
+#include "driver_acceptance.h"
+#include "driver_profile.h"
+#include "tmc2209_sim.h"
+#include "torque_capture.h"
 #include "neopixel.h"
 #include "ir_emitter.h"
 #include "loadcell_scale.h"
+#include "loadcell_adc.h"
 #include "ir_sensor.h"
 
 #include "esp_mac.h"
@@ -54,6 +68,10 @@ static bool s_cmd_ir_emitter_registered = false;
 static bool s_cmd_ir_sensor_registered = false;
 static bool s_cmd_scale_registered = false;
 static bool s_cmd_motor_registered = false;
+static bool s_cmd_boot_registered = false;
+static bool s_cmd_bootprof_registered = false;
+static int64_t s_console_ready_us = 0;
+static SemaphoreHandle_t s_output_lock = NULL;
 
 static int cmd_help(int argc, char **argv);
 static int cmd_uptime(int argc, char **argv);
@@ -71,13 +89,15 @@ static int cmd_ir_emitter(int argc, char **argv);
 static int cmd_ir_sensor(int argc, char **argv);
 static int cmd_scale(int argc, char **argv);
 static int cmd_motor(int argc, char **argv);
+static int cmd_boot(int argc, char **argv);
+static int cmd_bootprof(int argc, char **argv);
 static void motor_driver_acceptancetest_run_and_print_json(void);
 
 static const diag_cmd_info_t k_diag_cmds[] = {
     {.name = "help", .usage = "[command]", .handler = &cmd_help, .registered = &s_cmd_help_registered},
     {.name = "uptime", .usage = "Print uptime in ms", .handler = &cmd_uptime, .registered = &s_cmd_uptime_registered},
     {.name = "reboot", .usage = "Restart the device", .handler = &cmd_reboot, .registered = &s_cmd_reboot_registered},
-    {.name = "snapshot", .usage = "Print one-line JSON system snapshot", .handler = &cmd_snapshot, .registered = &s_cmd_snapshot_registered},
+    {.name = "snapshot", .usage = "Print one-line JSON system snapshot | snapshot profile | snapshot cbor | snapshot bench [iterations] | snapshot watch [<period_ms>|stop]", .handler = &cmd_snapshot, .registered = &s_cmd_snapshot_registered},
     {.name = "version", .usage = "Print firmware version/build", .handler = &cmd_version, .registered = &s_cmd_version_registered},
     {.name = "id", .usage = "Print device ID", .handler = &cmd_id, .registered = &s_cmd_id_registered},
     {.name = "pins", .usage = "Print pin map", .handler = &cmd_pins, .registered = &s_cmd_pins_registered},
@@ -85,16 +105,36 @@ static const diag_cmd_info_t k_diag_cmds[] = {
     {.name = "neopixel", .usage = "off|r|g|b|booting|ready|fault|status|bright <0-255>", .handler = &cmd_neopixel, .registered = &s_cmd_neopixel_registered},
     {.name = "ir_emitter", .usage = "on|off|status", .handler = &cmd_ir_emitter, .registered = &s_cmd_ir_emitter_registered},
     {.name = "ir_sensor", .usage = "status", .handler = &cmd_ir_sensor, .registered = &s_cmd_ir_sensor_registered},
-    {.name = "scale", .usage = "read [n] | tare [n] | cal <known_grams> [n] | status", .handler = &cmd_scale, .registered = &s_cmd_scale_registered},
-    {.name = "motor", .usage = "enable|disable|dir CW|CCW|speed <hz 50-5000>|start|stop|status|clearfaults|driver ...", .handler = &cmd_motor, .registered = &s_cmd_motor_registered},
+    {.name = "scale", .usage = "read [n] | tare [n] | cal <known_grams> [n] | cal add <known_grams> [n] | cal show|clear | status | stream <rate> [duration_s] | filter [clear] | filter add median|ma|iir|notch <n> | gain a128|a64|b32 | rate 10|80 | adcstats [reset]", .handler = &cmd_scale, .registered = &s_cmd_scale_registered},
+    {.name = "motor", .usage = "enable|disable|dir CW|CCW|speed <hz 50-5000>|start|stop|status|clearfaults|torque ...|driver ...", .handler = &cmd_motor, .registered = &s_cmd_motor_registered},
     {.name = "selftest", .usage = "Verify required commands and snapshot format", .handler = &cmd_selftest, .registered = &s_cmd_selftest_registered},
     {.name = "events", .usage = "tail [n] | clear", .handler = &cmd_events, .registered = &s_cmd_events_registered},
+    {.name = "boot", .usage = "Print boot timing and driver bring-up steps", .handler = &cmd_boot, .registered = &s_cmd_boot_registered},
+    {.name = "bootprof", .usage = "Print per-phase app_main boot timing", .handler = &cmd_bootprof, .registered = &s_cmd_bootprof_registered},
     {.name = "remote", .usage = "list | exec <action> [args...] | unlock <seconds> | lock | unlock_status", .handler = &cmd_remote, .registered = &s_cmd_remote_registered},
 };
 
-#define SNAPSHOT_JSON_MAX 512
+#if defined(CONFIG_FW_SNAPSHOT_BOOT_PROFILE) && CONFIG_FW_SNAPSHOT_BOOT_PROFILE
+#define SNAPSHOT_JSON_MAX 1024
+#else
+#define SNAPSHOT_JSON_MAX 768
+#endif
 #define SCALE_DEFAULT_SAMPLES 5
 #define SCALE_MAX_SAMPLES 64
+#define CODEC_BENCH_DEFAULT_FRAMES 10000
+#define CODEC_BENCH_MAX_FRAMES 1000000
+#define XFER_BENCH_DEFAULT_PAIRS 100
+#define XFER_BENCH_MAX_PAIRS 10000
+#define STARTUP_DRIVER_WAIT_MS 2000
+#define TORQUE_MAX_DWELL_MS 10000
+#define TORQUE_MAX_ARM_MM 1000
+#define SCALE_STREAM_MAX_RATE 80
+#define SCALE_STREAM_MAX_DURATION_S 3600
+#define SCALE_STREAM_POLL_MS 50
+#define SCALE_STREAM_BATCH_BYTES 768
+#define SNAPSHOT_PROFILE_MAX_FIELDS 24
+#define SNAPSHOT_BENCH_DEFAULT_ITERATIONS 100
+#define SNAPSHOT_BENCH_MAX_ITERATIONS 10000
 
 static void print_json_string(const char *value)
 {
@@ -117,6 +157,58 @@ static void events_print_record(const events_record_t *rec, void *ctx)
     printf("}\n");
 }
 
+// Top-level snapshot keys promised by docs/firmware_contract.md, extracted at build time
+// (snapshot_contract.h); the compiled side comes from the schema table in snapshot.c.
+static const char *const k_snapshot_contract_keys[] = {SNAPSHOT_CONTRACT_KEYS NULL};
+static const char *const k_snapshot_contract_optional_keys[] = {SNAPSHOT_CONTRACT_OPTIONAL_KEYS NULL};
+
+static bool key_in_list(const char *const *list, const char *key)
+{
+    for (; *list != NULL; ++list)
+    {
+        if (strcmp(*list, key) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool snapshot_schema_has_key(const char *key)
+{
+    for (size_t i = 0; i < snapshot_field_count(); ++i)
+    {
+        if (strcmp(snapshot_field_key(i), key) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Set equality between schema and contract: every documented key is compiled in, and every
+// compiled key is documented (optional ones only exist with their build option). Returns the
+// first offending key, or NULL.
+static const char *snapshot_contract_mismatch(void)
+{
+    for (size_t i = 0; k_snapshot_contract_keys[i] != NULL; ++i)
+    {
+        if (!snapshot_schema_has_key(k_snapshot_contract_keys[i]))
+        {
+            return k_snapshot_contract_keys[i];
+        }
+    }
+    for (size_t i = 0; i < snapshot_field_count(); ++i)
+    {
+        const char *key = snapshot_field_key(i);
+        if (!key_in_list(k_snapshot_contract_keys, key) && !key_in_list(k_snapshot_contract_optional_keys, key))
+        {
+            return key;
+        }
+    }
+    return NULL;
+}
+
 static const diag_cmd_info_t *find_cmd_info(const char *name)
 {
     for (size_t i = 0; i < sizeof(k_diag_cmds) / sizeof(k_diag_cmds[0]); ++i)
@@ -148,6 +240,18 @@ static void print_err_json(const char *err)
     printf("ERR {\"err\":\"%s\"}\n", err);
 }
 
+// JSON commands build their line in a buffer and print it only when it is complete, so a
+// failed build is a single ERR line rather than a truncated object followed by one.
+static void print_json_line(const char *buf, bool ok)
+{
+    if (ok)
+    {
+        printf("%s\n", buf);
+        return;
+    }
+    print_err_json("internal");
+}
+
 static bool parse_samples_arg(const char *arg, int *samples)
 {
     if (samples == NULL || arg == NULL)
@@ -184,341 +288,762 @@ static const char *json_find_key(const char *json, const char *key)
     return found + written;
 }
 
-static bool json_get_int_field(const char *json, const char *key, int *out)
+// Shared by CLI and boot canary; prints one-line JSON used for regression checks.
+static void motor_driver_acceptancetest_run_and_print_json(void)
 {
-    if (out == NULL)
-    {
-        return false;
-    }
-    const char *p = json_find_key(json, key);
-    if (p == NULL)
+    driver_acceptance_result_t result;
+    driver_acceptance_run(&result);
+    char buf[512];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    print_json_line(buf, driver_acceptance_write_json(&result, &w));
+}
+
+// Decodes a synthetic echo+reply RX buffer repeatedly; prints frames/s for the codec alone.
+static void codec_bench_run_and_print_json(uint32_t frames)
+{
+    uint8_t rx[TMC_FRAME_READ_REQ_LEN + TMC_FRAME_REPLY_LEN];
+    tmc_frame_encode_read(rx, 0, STEPPER_TMC_REG_IFCNT);
+    uint8_t *reply = &rx[TMC_FRAME_READ_REQ_LEN];
+    reply[0] = TMC_FRAME_SYNC;
+    reply[1] = TMC_FRAME_MASTER_ADDR;
+    reply[2] = STEPPER_TMC_REG_IFCNT;
+    reply[3] = 0;
+    reply[4] = 0;
+    reply[5] = 0;
+    reply[6] = 0x2A;
+    reply[7] = tmc_frame_crc(reply, 7);
+
+    uint32_t decoded = 0;
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < frames; ++i)
     {
-        return false;
+        const uint8_t *found = NULL;
+        if (tmc_frame_decode_reply(rx, sizeof(rx), STEPPER_TMC_REG_IFCNT, &found) == TMC_FRAME_OK)
+        {
+            decoded++;
+        }
     }
-    if (strncmp(p, "null", 4) == 0)
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    uint64_t per_s = (elapsed_us > 0) ? ((uint64_t)decoded * 1000000ULL) / (uint64_t)elapsed_us : 0;
+    printf("{\"frames\":%u,\"decoded\":%u,\"elapsed_us\":%lld,\"frames_per_s\":%llu}\n",
+           (unsigned)frames, (unsigned)decoded, (long long)elapsed_us, (unsigned long long)per_s);
+}
+
+// Alternating IFCNT reads and GSTAT writes (write of 0 clears nothing) over the active transport.
+static void xfer_bench_run_and_print_json(uint32_t pairs)
+{
+    stepper_uart_stats_t before;
+    stepper_uart_stats_t after;
+    stepper_uart_get_stats(&before);
+    uint32_t failed = 0;
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < pairs; ++i)
     {
-        return false;
+        uint32_t value = 0;
+        if (stepper_uart_read_reg(stepper_driver_get_slave_addr(), STEPPER_TMC_REG_IFCNT, &value) != ESP_OK)
+        {
+            failed++;
+        }
+        if (stepper_uart_write_reg(stepper_driver_get_slave_addr(), TMC2209_REG_GSTAT, 0) != ESP_OK)
+        {
+            failed++;
+        }
     }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    stepper_uart_get_stats(&after);
+    uint32_t xfers = pairs * 2U;
+    uint64_t per_s = (elapsed_us > 0) ? ((uint64_t)xfers * 1000000ULL) / (uint64_t)elapsed_us : 0;
+    printf("{\"transport\":\"%s\",\"xfers\":%u,\"failed\":%u,\"retries\":%u,\"write_lost\":%u,"
+           "\"elapsed_us\":%lld,\"xfers_per_s\":%llu}\n",
+           stepper_uart_get_hal()->name, (unsigned)xfers, (unsigned)failed,
+           (unsigned)(after.retries - before.retries), (unsigned)(after.write_lost - before.write_lost),
+           (long long)elapsed_us, (unsigned long long)per_s);
+}
+
+static bool parse_ulong_arg(const char *arg, unsigned long max, unsigned long *out)
+{
     char *end = NULL;
-    long val = strtol(p, &end, 0);
-    if (end == p)
+    unsigned long v = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || v > max)
     {
         return false;
     }
-    *out = (int)val;
+    *out = v;
     return true;
 }
 
-static bool json_get_bool_field(const char *json, const char *key, bool *out)
+// motor driver sim on|off|status|reset|seed <n>|slave <0-3>|fault <kind> <value>|fault clear
+static void driver_sim_cmd(int argc, char **argv)
 {
-    if (out == NULL)
+    const char *op = argv[3];
+    if (argc == 4 && strcmp(op, "status") == 0)
     {
-        return false;
-    }
-    const char *p = json_find_key(json, key);
-    if (p == NULL)
-    {
-        return false;
-    }
-    if (strncmp(p, "true", 4) == 0)
-    {
-        *out = true;
-        return true;
-    }
-    if (strncmp(p, "false", 5) == 0)
-    {
-        *out = false;
-        return true;
+        char buf[384];
+        if (!tmc2209_sim_get_status_json(buf, sizeof(buf)))
+        {
+            print_err_json("internal");
+            return;
+        }
+        printf("%s\n", buf);
+        return;
     }
-    return false;
-}
-
-static void add_error(const char **errors, size_t *count, size_t max, const char *err)
-{
-    if (errors == NULL || count == NULL || err == NULL)
+    if (argc == 4 && (strcmp(op, "on") == 0 || strcmp(op, "off") == 0))
     {
+        const stepper_uart_hal_t *hal = (strcmp(op, "on") == 0) ? tmc2209_sim_hal() : NULL;
+        if (stepper_uart_set_hal(hal) != ESP_OK)
+        {
+            print_err_json("bus_busy");
+            return;
+        }
+        printf("OK\n");
         return;
     }
-    if (*count < max)
+    if (argc == 4 && strcmp(op, "reset") == 0)
     {
-        errors[*count] = err;
-        *count += 1;
+        tmc2209_sim_reset();
+        printf("OK\n");
+        return;
     }
-}
-
-// Shared by CLI and boot canary; prints one-line JSON used for regression checks.
-static void motor_driver_acceptancetest_run_and_print_json(void)
-{
-    const char *errors[12];
-    size_t err_count = 0;
-
-    int ifcnt_start = -1;
-    int ifcnt_end = -1;
-    int microsteps = -1;
-    int cs31 = -1;
-    int cs2 = -1;
-    const char *micro_str = "null";
-    const char *cs31_str = "null";
-    const char *cs2_str = "null";
-    const char *stealth_str = "null";
-    char micro_buf[8];
-    char cs31_buf[8];
-    char cs2_buf[8];
-    char status_buf[256];
-
-    if (motor_disable() != ESP_OK)
+    unsigned long v = 0;
+    if (argc == 5 && strcmp(op, "seed") == 0 && parse_ulong_arg(argv[4], UINT32_MAX, &v))
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "motor_disable");
+        tmc2209_sim_seed((uint32_t)v);
+        printf("OK\n");
+        return;
     }
-    if (stepper_driver_set_microsteps(16) != ESP_OK)
+    if (argc == 5 && strcmp(op, "slave") == 0 && parse_ulong_arg(argv[4], 3, &v))
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "microsteps_set");
+        tmc2209_sim_set_slave((uint8_t)v);
+        printf("OK\n");
+        return;
     }
-    if (stepper_driver_set_stealthchop(false) != ESP_OK)
+    if (strcmp(op, "fault") != 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stealthchop_set");
+        print_err_json("invalid_args");
+        return;
     }
-    if (stepper_driver_clear_faults() != ESP_OK)
+    if (argc == 5 && strcmp(argv[4], "clear") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "clearfaults");
+        tmc2209_sim_set_faults(NULL);
+        printf("OK\n");
+        return;
     }
-    uint8_t ifcnt = 0;
-    if (stepper_driver_read_ifcnt(&ifcnt) == ESP_OK)
+    if (argc != 6)
     {
-        ifcnt_start = (int)ifcnt;
+        print_err_json("invalid_args");
+        return;
     }
-    else
+    tmc2209_sim_faults_t faults;
+    tmc2209_sim_get_faults(&faults);
+    const char *kind = argv[4];
+    const char *arg = argv[5];
+    bool ok = true;
+    if (strcmp(kind, "echo") == 0 && (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0))
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "ifcnt_start");
+        faults.no_echo = (strcmp(arg, "off") == 0);
     }
-    if (!stepper_driver_get_status_json(status_buf, sizeof(status_buf)))
+    else if (strcmp(kind, "delay") == 0 && parse_ulong_arg(arg, 1000, &v))
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "status_start");
+        faults.delay_ms = (uint16_t)v;
     }
-    else
+    else if (parse_ulong_arg(arg, 100, &v))
     {
-        if (json_get_int_field(status_buf, "microsteps", &microsteps))
+        if (strcmp(kind, "drop") == 0)
         {
-            snprintf(micro_buf, sizeof(micro_buf), "%d", microsteps);
-            micro_str = micro_buf;
-            if (microsteps != 16)
-            {
-                add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "microsteps");
-            }
+            faults.drop_pct = (uint8_t)v;
         }
-        else
+        else if (strcmp(kind, "corrupt") == 0)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "microsteps");
+            faults.corrupt_pct = (uint8_t)v;
         }
-        bool stealth = false;
-        if (json_get_bool_field(status_buf, "stealthchop", &stealth))
+        else if (strcmp(kind, "lose") == 0)
         {
-            stealth_str = stealth ? "true" : "false";
-            if (stealth)
-            {
-                add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stealthchop");
-            }
+            faults.lose_pct = (uint8_t)v;
         }
         else
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stealthchop");
+            ok = false;
         }
     }
-    if (motor_enable() != ESP_OK)
+    else
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "motor_enable");
+        ok = false;
     }
-    if (motor_set_dir(MOTOR_DIR_REV) != ESP_OK)
+    if (!ok)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "dir");
+        print_err_json("invalid_args");
+        return;
     }
-    if (motor_set_speed_hz(200) != ESP_OK)
+    tmc2209_sim_set_faults(&faults);
+    printf("OK\n");
+}
+
+static void driver_scan_print_json(void)
+{
+    stepper_driver_scan_t scan;
+    esp_err_t err = stepper_driver_scan(&scan);
+    if (err == ESP_ERR_TIMEOUT)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "speed");
+        print_err_json("bus_busy");
+        return;
     }
-    if (stepper_driver_set_current(10, 2, 0) != ESP_OK)
+    printf("{\"elapsed_us\":%lu,\"count\":%u,", (unsigned long)scan.elapsed_us, (unsigned)scan.count);
+    if (scan.count > 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "current_2");
+        printf("\"active\":%u,\"slaves\":[", (unsigned)scan.active);
     }
-    if (motor_start() != ESP_OK)
+    else
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "start_2");
+        printf("\"active\":null,\"slaves\":[");
     }
-    vTaskDelay(pdMS_TO_TICKS(500));
-    if (motor_stop() != ESP_OK)
+    bool first = true;
+    for (uint8_t addr = 0; addr < STEPPER_TMC_MAX_SLAVES; ++addr)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stop_2");
+        const stepper_driver_slave_info_t *slave = &scan.slaves[addr];
+        if (!slave->present)
+        {
+            continue;
+        }
+        printf("%s{\"addr\":%u,\"version\":%u,\"ifcnt\":", first ? "" : ",", (unsigned)addr,
+               (unsigned)slave->version);
+        if (slave->ifcnt_ok)
+        {
+            printf("%u}", (unsigned)slave->ifcnt);
+        }
+        else
+        {
+            printf("null}");
+        }
+        first = false;
     }
-    if (motor_set_speed_hz(5000) != ESP_OK)
+    printf("]}\n");
+}
+
+// motor driver profile save <name> | load <name> | list
+static void driver_profile_cmd(int argc, char **argv)
+{
+    const char *op = argv[3];
+    if (argc == 4 && strcmp(op, "list") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "speed");
+        char buf[1024];
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf));
+        print_json_line(buf, driver_profile_write_list_json(&w));
+        return;
     }
-    if (stepper_driver_set_current(31, 31, 0) != ESP_OK)
+    if (argc != 5 || !driver_profile_name_valid(argv[4]))
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "current_31");
+        print_err_json("invalid_args");
+        return;
     }
-    // Jam-clear vibration: rapid direction bursts at MOTOR_MAX_HZ; raise limits only intentionally.
-    for (int i = 0; i < 100; ++i)
+    const char *name = argv[4];
+    if (strcmp(op, "save") == 0)
     {
-        if (motor_set_dir(MOTOR_DIR_REV) != ESP_OK)
+        motor_driver_defaults_t cfg;
+        stepper_driver_get_config(&cfg);
+        esp_err_t err = driver_profile_save(name, &cfg);
+        if (err == ESP_ERR_NO_MEM)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "dir");
+            print_err_json("profile_full");
+            return;
         }
-        if (motor_start() != ESP_OK)
+        if (err != ESP_OK)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "start_31");
+            print_err_json("nvs");
+            return;
         }
-        vTaskDelay(pdMS_TO_TICKS(20));
-        if (motor_stop() != ESP_OK)
+        printf("OK\n");
+        return;
+    }
+    if (strcmp(op, "load") == 0)
+    {
+        motor_driver_defaults_t cfg;
+        esp_err_t err = driver_profile_load(name, &cfg);
+        if (err == ESP_ERR_NOT_FOUND)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stop_31");
+            print_err_json("not_found");
+            return;
         }
-        if (motor_set_dir(MOTOR_DIR_FWD) != ESP_OK)
+        if (err != ESP_OK)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "dir");
+            print_err_json("nvs");
+            return;
         }
-        if (motor_start() != ESP_OK)
+        if (stepper_driver_apply_config(&cfg) != ESP_OK)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "start_31");
+            print_err_json("uart_no_response");
+            return;
         }
-        vTaskDelay(pdMS_TO_TICKS(20));
-        if (motor_stop() != ESP_OK)
+        if (driver_profile_set_active(name) != ESP_OK)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stop_31");
+            print_err_json("nvs");
+            return;
         }
+        printf("OK\n");
+        return;
     }
-    if (!stepper_driver_get_status_json(status_buf, sizeof(status_buf)))
-    {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "status_31");
+    print_err_json("invalid_args");
+}
+
+// Streams the register map as one JSON line; raw values are hex, fields decoded per map entry.
+static void driver_dump_print_json(void)
+{
+    stepper_driver_reg_value_t vals[TMC2209_REG_COUNT];
+    size_t count = stepper_driver_dump_regs(vals, sizeof(vals) / sizeof(vals[0]));
+    unsigned ok = 0;
+    unsigned failed = 0;
+    printf("{\"regs\":[");
+    for (size_t i = 0; i < count; ++i)
+    {
+        const tmc2209_reg_t *reg = vals[i].reg;
+        printf("%s{\"name\":\"%s\",\"addr\":%u,", (i > 0) ? "," : "", reg->name, (unsigned)reg->addr);
+        if (vals[i].err != ESP_OK)
+        {
+            failed++;
+            printf("\"raw\":null}");
+            continue;
+        }
+        ok++;
+        printf("\"raw\":\"0x%08lx\",\"fields\":{", (unsigned long)vals[i].value);
+        for (size_t f = 0; f < reg->field_count; ++f)
+        {
+            printf("%s\"%s\":%lu", (f > 0) ? "," : "", reg->fields[f].name,
+                   (unsigned long)tmc2209_field_value(&reg->fields[f], vals[i].value));
+        }
+        printf("}}");
     }
-    else if (json_get_int_field(status_buf, "cs_actual", &cs31))
-    {
-        snprintf(cs31_buf, sizeof(cs31_buf), "%d", cs31);
-        cs31_str = cs31_buf;
-        if (cs31 != 31)
+    printf("],\"ok\":%u,\"failed\":%u}\n", ok, failed);
+}
+
+static void torque_print_status(void)
+{
+    torque_capture_summary_t sum;
+    torque_capture_get_summary(&sum);
+    printf("{\"state\":\"%s\",\"reason\":\"%s\",\"levels\":%u,\"pullout_hz\":%lu,\"stall_hz\":%lu,"
+           "\"trace\":%u,\"trace_dropped\":%lu}\n",
+           torque_capture_state_name(sum.state), sum.reason, (unsigned)sum.level_count, (unsigned long)sum.pullout_hz,
+           (unsigned long)sum.stall_hz, (unsigned)sum.trace_count, (unsigned long)sum.trace_dropped);
+}
+
+// One JSON line; rows are arrays in "cols" order to keep the table compact.
+static void torque_print_table(void)
+{
+    torque_capture_summary_t sum;
+    torque_capture_get_summary(&sum);
+    int32_t base_mg = 0;
+    bool have_mg = (loadcell_scale_raw_to_mg(sum.baseline_raw, &base_mg) == ESP_OK);
+    printf("{\"state\":\"%s\",\"reason\":\"%s\",\"baseline_raw\":%ld,\"pullout_hz\":%lu,\"stall_hz\":%lu,"
+           "\"arm_mm\":%lu,\"cols\":[\"hz\",\"n\",\"raw\",\"min\",\"max\",\"steps\",\"force_mg\",\"torque_mNm\",\"drv\"],"
+           "\"rows\":[",
+           torque_capture_state_name(sum.state), sum.reason, (long)sum.baseline_raw, (unsigned long)sum.pullout_hz,
+           (unsigned long)sum.stall_hz, (unsigned long)sum.cfg.arm_mm);
+    for (size_t i = 0; i < sum.level_count; ++i)
+    {
+        torque_level_t lv;
+        if (!torque_capture_get_level(i, &lv))
+        {
+            break;
+        }
+        printf("%s[%lu,%lu,%ld,%ld,%ld,%ld,", (i > 0) ? "," : "", (unsigned long)lv.step_hz,
+               (unsigned long)lv.samples, (long)lv.raw_mean, (long)lv.raw_min, (long)lv.raw_max, (long)lv.steps);
+        int32_t mg = 0;
+        if (have_mg && lv.samples > 0 && loadcell_scale_raw_to_mg(lv.raw_mean, &mg) == ESP_OK)
+        {
+            int32_t force_mg = mg - base_mg;
+            printf("%ld,", (long)force_mg);
+            if (sum.cfg.arm_mm > 0)
+            {
+                // mg -> N is 9.80665e-6; N * mm is mN*m.
+                printf("%.3f,", (double)force_mg * 9.80665e-6 * (double)sum.cfg.arm_mm);
+            }
+            else
+            {
+                printf("null,");
+            }
+        }
+        else
+        {
+            printf("null,null,");
+        }
+        if (lv.drv_ok)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "cs_actual_31");
+            printf("\"0x%08lx\"]", (unsigned long)lv.drv_status);
+        }
+        else
+        {
+            printf("null]");
         }
     }
-    else
+    printf("]}\n");
+}
+
+// A header line, then one JSON line per chunk of 32 samples so every line stays parseable on
+// its own; rows are arrays in "fields" order.
+static void torque_print_trace(void)
+{
+    torque_capture_summary_t sum;
+    torque_capture_get_summary(&sum);
+    printf("{\"trace\":%u,\"dropped\":%lu,\"fields\":[\"level\",\"t_ms\",\"step_pos\",\"step_hz\",\"raw\"]}\n",
+           (unsigned)sum.trace_count, (unsigned long)sum.trace_dropped);
+    torque_sample_t chunk[32];
+    size_t pos = 0;
+    size_t n = 0;
+    while ((n = torque_capture_read_trace(pos, chunk, sizeof(chunk) / sizeof(chunk[0]))) > 0)
+    {
+        printf("{\"offset\":%u,\"rows\":[", (unsigned)pos);
+        for (size_t i = 0; i < n; ++i)
+        {
+            // Baseline samples carry level -1.
+            printf("%s[%d,%lu,%ld,%u,%ld]", (i > 0) ? "," : "",
+                   (chunk[i].level == UINT16_MAX) ? -1 : (int)chunk[i].level, (unsigned long)chunk[i].t_ms,
+                   (long)chunk[i].step_pos, (unsigned)chunk[i].step_hz, (long)chunk[i].raw);
+        }
+        printf("]}\n");
+        pos += n;
+    }
+    fflush(stdout);
+}
+
+// motor torque start <start_hz> <end_hz> <step_hz> [dwell_ms] [arm_mm] | stop | status | table | trace
+static void torque_cmd(int argc, char **argv)
+{
+    const char *op = argv[2];
+    if (argc == 3 && strcmp(op, "status") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "cs_actual_31");
+        torque_print_status();
+        return;
     }
-    if (motor_set_dir(MOTOR_DIR_REV) != ESP_OK)
+    if (argc == 3 && strcmp(op, "table") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "dir");
+        torque_print_table();
+        return;
     }
-    if (motor_set_speed_hz(200) != ESP_OK)
+    if (argc == 3 && strcmp(op, "trace") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "speed");
+        torque_print_trace();
+        return;
     }
-    if (stepper_driver_set_current(10, 2, 0) != ESP_OK)
+    if (argc == 3 && strcmp(op, "stop") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "current_2");
+        torque_capture_stop();
+        printf("OK\n");
+        return;
     }
-    if (motor_start() != ESP_OK)
+    if (strcmp(op, "start") != 0 || argc < 6 || argc > 8)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "start_2");
+        print_err_json("invalid_args");
+        return;
     }
-    vTaskDelay(pdMS_TO_TICKS(500));
-    if (!stepper_driver_get_status_json(status_buf, sizeof(status_buf)))
+    torque_capture_config_t cfg;
+    torque_capture_default_config(&cfg);
+    unsigned long start_hz = 0;
+    unsigned long end_hz = 0;
+    unsigned long step_hz = 0;
+    unsigned long dwell_ms = cfg.dwell_ms;
+    unsigned long arm_mm = 0;
+    if (!parse_ulong_arg(argv[3], MOTOR_MAX_HZ, &start_hz) || !parse_ulong_arg(argv[4], MOTOR_MAX_HZ, &end_hz) ||
+        !parse_ulong_arg(argv[5], MOTOR_MAX_HZ, &step_hz) ||
+        (argc >= 7 && !parse_ulong_arg(argv[6], TORQUE_MAX_DWELL_MS, &dwell_ms)) ||
+        (argc == 8 && !parse_ulong_arg(argv[7], TORQUE_MAX_ARM_MM, &arm_mm)))
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "status_2");
+        print_err_json("invalid_args");
+        return;
     }
-    else if (json_get_int_field(status_buf, "cs_actual", &cs2))
+    cfg.start_hz = (uint32_t)start_hz;
+    cfg.end_hz = (uint32_t)end_hz;
+    cfg.step_hz = (uint32_t)step_hz;
+    cfg.dwell_ms = (uint32_t)dwell_ms;
+    cfg.arm_mm = (uint32_t)arm_mm;
+    esp_err_t err = torque_capture_start(&cfg);
+    if (err != ESP_OK)
     {
-        snprintf(cs2_buf, sizeof(cs2_buf), "%d", cs2);
-        cs2_str = cs2_buf;
-        if (cs2 != 10)
+        const char *code = "invalid_args";
+        if (err == ESP_ERR_INVALID_STATE)
         {
-            add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "cs_actual_2");
+            code = "not_ready";
         }
+        else if (err == ESP_ERR_NO_MEM)
+        {
+            code = "no_mem";
+        }
+        print_err_json(code);
+        return;
     }
-    else
+    printf("OK\n");
+}
+
+static int cmd_help(int argc, char **argv)
+{
+    if (argc == 1)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "cs_actual_2");
+        printf("Commands:\n");
+        for (size_t i = 0; i < sizeof(k_diag_cmds) / sizeof(k_diag_cmds[0]); ++i)
+        {
+            printf("%-10s %s\n", k_diag_cmds[i].name, k_diag_cmds[i].usage);
+        }
+        return 0;
     }
-    if (motor_stop() != ESP_OK)
+    if (argc == 2)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "stop_2");
+        const diag_cmd_info_t *info = find_cmd_info(argv[1]);
+        if (info == NULL)
+        {
+            printf("ERR unknown_command\n");
+            return 0;
+        }
+        printf("%s %s\n", info->name, info->usage);
+        return 0;
     }
-    if (motor_disable() != ESP_OK)
+    if (argc == 3 && strcmp(argv[1], "motor") == 0 && strcmp(argv[2], "driver") == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "motor_disable_end");
+        printf("motor driver ping | ifcnt | stealthchop on|off | microsteps <1|2|4|8|16|32|64|128|256> | current run <0-31> hold <0-31> [hold_delay <0-15>] | status | clearfaults | acceptancetest | uartstats [reset] | reliable [on|off] | codecbench [frames] | scan | dump | profile save|load <name> | profile list | xferbench [pairs] | sim on|off|status|reset|seed <n>|slave <0-3>|fault drop|corrupt|lose <pct>|fault delay <ms>|fault echo on|off|fault clear\n");
+        return 0;
     }
-    if (stepper_driver_read_ifcnt(&ifcnt) == ESP_OK)
+    printf("ERR invalid_args\n");
+    return 0;
+}
+
+static int cmd_uptime(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    int64_t us = esp_timer_get_time();
+    printf("uptime_ms=%lld\n", (long long)(us / 1000));
+    return 0;
+}
+
+static int cmd_boot(int argc, char **argv)
+{
+    (void)argv;
+    if (argc != 1)
     {
-        ifcnt_end = (int)ifcnt;
+        print_err_json("invalid_args");
+        return 0;
     }
-    else
+    // Driver bring-up object (up to 512 bytes) plus the wrapper.
+    char buf[576];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    bool ok = json_obj_begin(&w) &&
+              json_kv_i64(&w, "console_ready_us", s_console_ready_us) &&
+              json_write_key(&w, "driver") &&
+              motor_write_driver_init_json(&w) &&
+              json_obj_end(&w);
+    print_json_line(buf, ok);
+    return 0;
+}
+
+static int cmd_bootprof(int argc, char **argv)
+{
+    (void)argv;
+    if (argc != 1)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "ifcnt_end");
+        print_err_json("invalid_args");
+        return 0;
     }
-    if (ifcnt_start >= 0 && ifcnt_end >= 0 && ifcnt_end <= ifcnt_start)
+    char buf[768];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    print_json_line(buf, boot_profile_write_json(&w));
+    return 0;
+}
+
+// Cycles to microseconds with two decimals; most fields take well under 1 us.
+static void snapshot_profile_format_us(char *out, size_t len, uint32_t cycles, uint32_t ticks_per_us)
+{
+    uint64_t centi_us = ((uint64_t)cycles * 100U + ticks_per_us / 2U) / ticks_per_us;
+    snprintf(out, len, "%llu.%02u", (unsigned long long)(centi_us / 100U), (unsigned)(centi_us % 100U));
+}
+
+static int snapshot_profile_run(void)
+{
+    static char buf[SNAPSHOT_JSON_MAX];
+    snapshot_field_timing_t timings[SNAPSHOT_PROFILE_MAX_FIELDS];
+    size_t count = 0;
+    uint32_t start = esp_cpu_get_cycle_count();
+    bool built = snapshot_build_profiled(buf, sizeof(buf), timings, SNAPSHOT_PROFILE_MAX_FIELDS, &count);
+    uint32_t total = esp_cpu_get_cycle_count() - start;
+    uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+    if (ticks_per_us == 0)
     {
-        add_error(errors, &err_count, sizeof(errors) / sizeof(errors[0]), "ifcnt_delta");
+        ticks_per_us = 1;
     }
 
-    const char *overall = (err_count == 0) ? "PASS" : "FAIL";
-    printf("{\"overall\":\"%s\",\"ifcnt_start\":%d,\"ifcnt_end\":%d,"
-           "\"cs31\":%s,\"cs2\":%s,\"microsteps\":%s,\"stealthchop\":%s,\"errors\":[",
-           overall, ifcnt_start, ifcnt_end,
-           cs31_str, cs2_str, micro_str, stealth_str);
-    for (size_t i = 0; i < err_count; ++i)
+    char out[640];
+    char us[24];
+    snapshot_profile_format_us(us, sizeof(us), total, ticks_per_us);
+    int written = snprintf(out, sizeof(out), "{\"ok\":%s,\"bytes\":%u,\"total_us\":%s,\"fields_us\":{",
+                           built ? "true" : "false", built ? (unsigned)strlen(buf) : 0U, us);
+    if (written < 0 || (size_t)written >= sizeof(out))
+    {
+        print_err_json("internal");
+        return 0;
+    }
+    size_t used = (size_t)written;
+    for (size_t i = 0; i < count; ++i)
     {
-        if (i > 0)
+        snapshot_profile_format_us(us, sizeof(us), timings[i].cycles, ticks_per_us);
+        written = snprintf(out + used, sizeof(out) - used, "%s\"%s\":%s", (i > 0) ? "," : "", timings[i].key, us);
+        if (written < 0 || (size_t)written >= sizeof(out) - used)
         {
-            printf(",");
+            print_err_json("internal");
+            return 0;
         }
-        print_json_string(errors[i]);
+        used += (size_t)written;
     }
-    printf("]}\n");
+    written = snprintf(out + used, sizeof(out) - used, "}}");
+    if (written < 0 || (size_t)written >= sizeof(out) - used)
+    {
+        print_err_json("internal");
+        return 0;
+    }
+    printf("%s\n", out);
+    return 0;
 }
 
-static int cmd_help(int argc, char **argv)
+static void print_base64_line(const uint8_t *data, size_t len)
 {
-    if (argc == 1)
+    static const char k_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char chunk[64];
+    size_t out = 0;
+    for (size_t i = 0; i < len; i += 3)
     {
-        printf("Commands:\n");
-        for (size_t i = 0; i < sizeof(k_diag_cmds) / sizeof(k_diag_cmds[0]); ++i)
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len)
         {
-            printf("%-10s %s\n", k_diag_cmds[i].name, k_diag_cmds[i].usage);
+            v |= (uint32_t)data[i + 1] << 8;
+        }
+        if (i + 2 < len)
+        {
+            v |= data[i + 2];
+        }
+        chunk[out++] = k_alphabet[(v >> 18) & 0x3F];
+        chunk[out++] = k_alphabet[(v >> 12) & 0x3F];
+        chunk[out++] = (i + 1 < len) ? k_alphabet[(v >> 6) & 0x3F] : '=';
+        chunk[out++] = (i + 2 < len) ? k_alphabet[v & 0x3F] : '=';
+        if (out == sizeof(chunk))
+        {
+            fwrite(chunk, 1, out, stdout);
+            out = 0;
+        }
+    }
+    fwrite(chunk, 1, out, stdout);
+    printf("\n");
+}
+
+static void snapshot_bench_run_and_print_json(uint32_t iterations)
+{
+    static char json_buf[SNAPSHOT_JSON_MAX];
+    static uint8_t cbor_buf[SNAPSHOT_JSON_MAX];
+    size_t json_bytes = 0;
+    size_t cbor_bytes = 0;
+    bool ok = true;
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        ok = snapshot_build(json_buf, sizeof(json_buf));
+    }
+    int64_t json_us = esp_timer_get_time() - start;
+    if (ok)
+    {
+        json_bytes = strlen(json_buf);
+    }
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        ok = snapshot_build_cbor(cbor_buf, sizeof(cbor_buf), &cbor_bytes);
+    }
+    int64_t cbor_us = esp_timer_get_time() - start;
+
+    // Module status producers alone, written back to back into one buffer.
+    size_t status_bytes = 0;
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        json_writer_t w;
+        json_writer_init(&w, json_buf, sizeof(json_buf));
+        ok = json_arr_begin(&w) && motor_write_status_json(&w) && loadcell_scale_write_status_json(&w) &&
+             stepper_uart_write_stats_summary_json(&w) && json_arr_end(&w);
+        status_bytes = w.used;
+    }
+    int64_t status_us = esp_timer_get_time() - start;
+    if (!ok)
+    {
+        print_err_json("snapshot_format");
+        return;
+    }
+    printf("{\"iterations\":%lu,\"json_bytes\":%u,\"json_elapsed_us\":%lld,"
+           "\"cbor_bytes\":%u,\"cbor_elapsed_us\":%lld,"
+           "\"status_bytes\":%u,\"status_elapsed_us\":%lld}\n",
+           (unsigned long)iterations, (unsigned)json_bytes, (long long)json_us, (unsigned)cbor_bytes,
+           (long long)cbor_us, (unsigned)status_bytes, (long long)status_us);
+}
+
+static int cmd_snapshot(int argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "profile") == 0)
+    {
+        return snapshot_profile_run();
+    }
+    if (argc == 2 && strcmp(argv[1], "cbor") == 0)
+    {
+        static uint8_t cbor_buf[SNAPSHOT_JSON_MAX];
+        size_t cbor_len = 0;
+        if (!snapshot_build_cbor(cbor_buf, sizeof(cbor_buf), &cbor_len))
+        {
+            printf("{\"error\":\"snapshot_format\"}\n");
+            return 0;
         }
+        print_base64_line(cbor_buf, cbor_len);
         return 0;
     }
-    if (argc == 2)
+    if (argc >= 2 && strcmp(argv[1], "watch") == 0)
     {
-        const diag_cmd_info_t *info = find_cmd_info(argv[1]);
-        if (info == NULL)
+        if (argc == 2)
         {
-            printf("ERR unknown_command\n");
+            char buf[96];
+            json_writer_t w;
+            json_writer_init(&w, buf, sizeof(buf));
+            print_json_line(buf, snapshot_watch_write_json(&w));
             return 0;
         }
-        printf("%s %s\n", info->name, info->usage);
+        if (argc == 3 && strcmp(argv[2], "stop") == 0)
+        {
+            snapshot_watch_stop();
+            printf("OK\n");
+            return 0;
+        }
+        unsigned long period_ms = 0;
+        if (argc != 3 || !parse_ulong_arg(argv[2], SNAPSHOT_WATCH_MAX_PERIOD_MS, &period_ms) ||
+            period_ms < SNAPSHOT_WATCH_MIN_PERIOD_MS)
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        esp_err_t err = snapshot_watch_start((uint32_t)period_ms);
+        if (err != ESP_OK)
+        {
+            print_err_json((err == ESP_ERR_NO_MEM) ? "no_mem" : "internal");
+            return 0;
+        }
+        printf("OK\n");
         return 0;
     }
-    if (argc == 3 && strcmp(argv[1], "motor") == 0 && strcmp(argv[2], "driver") == 0)
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0)
     {
-        printf("motor driver ping | ifcnt | stealthchop on|off | microsteps <1|2|4|8|16|32|64|128|256> | current run <0-31> hold <0-31> [hold_delay <0-15>] | status | clearfaults | acceptancetest\n");
+        unsigned long iterations = SNAPSHOT_BENCH_DEFAULT_ITERATIONS;
+        if (argc > 3 || (argc == 3 && (!parse_ulong_arg(argv[2], SNAPSHOT_BENCH_MAX_ITERATIONS, &iterations) ||
+                                       iterations == 0)))
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        snapshot_bench_run_and_print_json((uint32_t)iterations);
         return 0;
     }
-    printf("ERR invalid_args\n");
-    return 0;
-}
-
-static int cmd_uptime(int argc, char **argv)
-{
-    (void)argc;
-    (void)argv;
-    int64_t us = esp_timer_get_time();
-    printf("uptime_ms=%lld\n", (long long)(us / 1000));
-    return 0;
-}
-
-static int cmd_snapshot(int argc, char **argv)
-{
-    (void)argc;
-    (void)argv;
 
     char buf[SNAPSHOT_JSON_MAX];
     if (!snapshot_build(buf, sizeof(buf)))
@@ -749,6 +1274,112 @@ static int cmd_ir_sensor(int argc, char **argv)
     return 0;
 }
 
+// Non-blocking check for any byte on the console; drains the rest of the line so it is not
+// executed as a command once the prompt returns.
+static bool scale_stream_key_pressed(void)
+{
+    uint8_t c = 0;
+    if (read(STDIN_FILENO, &c, 1) <= 0)
+    {
+        return false;
+    }
+    while (read(STDIN_FILENO, &c, 1) > 0)
+    {
+    }
+    return true;
+}
+
+// scale stream <rate> [duration_s]: one header line, then "seq,t_us,raw" per sample
+// (t_us relative to the first sample), then a JSON trailer. Lines are batched into one
+// write per poll so console overhead does not throttle 80 SPS.
+static void scale_stream_run(unsigned long rate, unsigned long duration_s)
+{
+    if (!loadcell_adc_is_running())
+    {
+        print_err_json("no_data");
+        return;
+    }
+    int stdin_fd = STDIN_FILENO;
+    int flags = fcntl(stdin_fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(stdin_fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        print_err_json("internal");
+        return;
+    }
+    printf("{\"stream\":\"scale\",\"rate\":%lu,\"duration_s\":%lu,\"fields\":[\"seq\",\"t_us\",\"raw\"]}\n",
+           rate, duration_s);
+    fflush(stdout);
+
+    // Keep samples at least one period apart, with a quarter-period of slack for edge jitter.
+    const int64_t min_gap_us = (1000000LL / (int64_t)rate) * 3 / 4;
+    const int64_t start_us = esp_timer_get_time();
+    const int64_t end_us = (duration_s > 0) ? start_us + (int64_t)duration_s * 1000000LL : INT64_MAX;
+    uint32_t cursor = loadcell_adc_cursor_now();
+    int64_t first_ts = -1;
+    int64_t last_emit_ts = INT64_MIN / 2;
+    uint32_t emitted = 0;
+    uint32_t dropped_total = 0;
+    const char *reason = "duration";
+    char batch[SCALE_STREAM_BATCH_BYTES];
+    while (true)
+    {
+        size_t used = 0;
+        loadcell_sample_t samples[16];
+        size_t n = 0;
+        do
+        {
+            uint32_t dropped = 0;
+            n = loadcell_adc_read_since(&cursor, samples, sizeof(samples) / sizeof(samples[0]), &dropped);
+            dropped_total += dropped;
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (samples[i].ts_us - last_emit_ts < min_gap_us)
+                {
+                    continue;
+                }
+                if (first_ts < 0)
+                {
+                    first_ts = samples[i].ts_us;
+                }
+                last_emit_ts = samples[i].ts_us;
+                if (sizeof(batch) - used < 40)
+                {
+                    fwrite(batch, 1, used, stdout);
+                    used = 0;
+                }
+                int w = snprintf(batch + used, sizeof(batch) - used, "%lu,%lu,%ld\n",
+                                 (unsigned long)samples[i].seq, (unsigned long)(samples[i].ts_us - first_ts),
+                                 (long)samples[i].raw);
+                if (w > 0)
+                {
+                    used += (size_t)w;
+                    emitted++;
+                }
+            }
+        } while (n == sizeof(samples) / sizeof(samples[0]));
+        if (used > 0)
+        {
+            fwrite(batch, 1, used, stdout);
+            fflush(stdout);
+        }
+        if (scale_stream_key_pressed())
+        {
+            reason = "key";
+            break;
+        }
+        if (esp_timer_get_time() >= end_us)
+        {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(SCALE_STREAM_POLL_MS));
+    }
+    fcntl(stdin_fd, F_SETFL, flags);
+    printf("{\"stream_end\":\"%s\",\"samples\":%lu,\"dropped\":%lu,\"elapsed_ms\":%lu}\n", reason,
+           (unsigned long)emitted, (unsigned long)dropped_total,
+           (unsigned long)((esp_timer_get_time() - start_us) / 1000));
+    fflush(stdout);
+}
+
 static int cmd_scale(int argc, char **argv)
 {
     if (argc < 2)
@@ -826,6 +1457,27 @@ static int cmd_scale(int argc, char **argv)
     }
     if (strcmp(argv[1], "cal") == 0)
     {
+        if (argc == 3 && strcmp(argv[2], "show") == 0)
+        {
+            char buf[448];
+            json_writer_t w;
+            json_writer_init(&w, buf, sizeof(buf));
+            print_json_line(buf, loadcell_scale_write_cal_json(&w));
+            return 0;
+        }
+        if (argc == 3 && strcmp(argv[2], "clear") == 0)
+        {
+            loadcell_scale_cal_clear();
+            printf("OK\n");
+            return 0;
+        }
+        bool add = (argc >= 3 && strcmp(argv[2], "add") == 0);
+        if (add)
+        {
+            // Shift so the grams/samples parsing below is shared with single-point cal.
+            argc--;
+            argv++;
+        }
         if (argc < 3 || argc > 4)
         {
             print_err_json("invalid_args");
@@ -844,10 +1496,23 @@ static int cmd_scale(int argc, char **argv)
             print_err_json("invalid_args");
             return 0;
         }
-        esp_err_t err = loadcell_scale_calibrate(samples, known_grams);
+        esp_err_t err = add ? loadcell_scale_cal_add(samples, known_grams) : loadcell_scale_calibrate(samples, known_grams);
         if (err != ESP_OK)
         {
-            print_err_json(err == ESP_ERR_INVALID_ARG ? "invalid_args" : "no_data");
+            const char *code = "no_data";
+            if (err == ESP_ERR_INVALID_ARG)
+            {
+                code = "invalid_args";
+            }
+            else if (err == ESP_ERR_NO_MEM)
+            {
+                code = "cal_full";
+            }
+            else if (add && err == ESP_ERR_INVALID_STATE)
+            {
+                code = "bad_point";
+            }
+            print_err_json(code);
             return 0;
         }
         printf("OK\n");
@@ -861,12 +1526,101 @@ static int cmd_scale(int argc, char **argv)
             return 0;
         }
         char buf[160];
-        if (!loadcell_scale_get_status_json(buf, sizeof(buf)))
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf));
+        print_json_line(buf, loadcell_scale_write_status_json(&w));
+        return 0;
+    }
+    if (strcmp(argv[1], "stream") == 0)
+    {
+        unsigned long rate = 0;
+        unsigned long duration_s = 0;
+        if (argc < 3 || argc > 4 || !parse_ulong_arg(argv[2], SCALE_STREAM_MAX_RATE, &rate) || rate == 0 ||
+            (argc == 4 && !parse_ulong_arg(argv[3], SCALE_STREAM_MAX_DURATION_S, &duration_s)))
         {
-            print_err_json("internal");
+            print_err_json("invalid_args");
             return 0;
         }
-        printf("%s\n", buf);
+        scale_stream_run(rate, duration_s);
+        return 0;
+    }
+    if (strcmp(argv[1], "filter") == 0)
+    {
+        if (argc == 2)
+        {
+            char buf[256];
+            json_writer_t w;
+            json_writer_init(&w, buf, sizeof(buf));
+            print_json_line(buf, loadcell_scale_filter_write_json(&w));
+            return 0;
+        }
+        if (argc == 3 && strcmp(argv[2], "clear") == 0)
+        {
+            loadcell_scale_filter_clear();
+            printf("OK\n");
+            return 0;
+        }
+        loadcell_filter_kind_t kind;
+        unsigned long param = 0;
+        if (argc != 5 || strcmp(argv[2], "add") != 0 || !loadcell_filter_kind_from_name(argv[3], &kind) ||
+            !parse_ulong_arg(argv[4], UINT16_MAX, &param))
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        esp_err_t err = loadcell_scale_filter_add(kind, (uint16_t)param);
+        if (err != ESP_OK)
+        {
+            print_err_json(err == ESP_ERR_NO_MEM ? "chain_full" : "invalid_args");
+            return 0;
+        }
+        printf("OK\n");
+        return 0;
+    }
+    if (strcmp(argv[1], "gain") == 0)
+    {
+        loadcell_adc_gain_t gain;
+        if (argc != 3 || !loadcell_adc_gain_from_name(argv[2], &gain))
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        if (loadcell_scale_set_gain(gain) != ESP_OK)
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        printf("OK\n");
+        return 0;
+    }
+    if (strcmp(argv[1], "rate") == 0)
+    {
+        unsigned long sps = 0;
+        if (argc != 3 || !parse_ulong_arg(argv[2], UINT16_MAX, &sps) || loadcell_scale_set_rate((uint16_t)sps) != ESP_OK)
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        printf("OK\n");
+        return 0;
+    }
+    if (strcmp(argv[1], "adcstats") == 0)
+    {
+        if (argc == 3 && strcmp(argv[2], "reset") == 0)
+        {
+            loadcell_adc_reset_stats();
+            printf("OK\n");
+            return 0;
+        }
+        if (argc != 2)
+        {
+            print_err_json("invalid_args");
+            return 0;
+        }
+        char buf[320];
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf));
+        print_json_line(buf, loadcell_adc_write_stats_json(&w));
         return 0;
     }
     print_err_json("invalid_args");
@@ -1042,13 +1796,16 @@ static int cmd_motor(int argc, char **argv)
                 print_err_json("invalid_args");
                 return 0;
             }
-            char buf[256];
-            if (!stepper_driver_get_status_json(buf, sizeof(buf)))
+            stepper_driver_status_t status;
+            if (stepper_driver_get_status(&status) != ESP_OK)
             {
                 print_err_json("uart_no_response");
                 return 0;
             }
-            printf("%s\n", buf);
+            char buf[256];
+            json_writer_t w;
+            json_writer_init(&w, buf, sizeof(buf));
+            print_json_line(buf, stepper_driver_write_status_json(&status, &w));
             return 0;
         }
         if (strcmp(sub, "clearfaults") == 0)
@@ -1067,6 +1824,129 @@ static int cmd_motor(int argc, char **argv)
             printf("OK\n");
             return 0;
         }
+        if (strcmp(sub, "uartstats") == 0)
+        {
+            if (argc == 4 && strcmp(argv[3], "reset") == 0)
+            {
+                if (stepper_uart_reset_stats() != ESP_OK)
+                {
+                    print_err_json("bus_busy");
+                    return 0;
+                }
+                printf("OK\n");
+                return 0;
+            }
+            if (argc != 3)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            char buf[384];
+            json_writer_t w;
+            json_writer_init(&w, buf, sizeof(buf));
+            print_json_line(buf, stepper_uart_write_stats_json(&w));
+            return 0;
+        }
+        if (strcmp(sub, "reliable") == 0)
+        {
+            if (argc == 3)
+            {
+                printf("{\"reliable\":%s}\n", stepper_driver_get_reliable_writes() ? "true" : "false");
+                return 0;
+            }
+            if (argc != 4)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            if (strcmp(argv[3], "on") == 0)
+            {
+                stepper_driver_set_reliable_writes(true);
+            }
+            else if (strcmp(argv[3], "off") == 0)
+            {
+                stepper_driver_set_reliable_writes(false);
+            }
+            else
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            printf("OK\n");
+            return 0;
+        }
+        if (strcmp(sub, "codecbench") == 0)
+        {
+            long frames = CODEC_BENCH_DEFAULT_FRAMES;
+            if (argc == 4)
+            {
+                char *end = NULL;
+                frames = strtol(argv[3], &end, 10);
+                if (end == argv[3] || *end != '\0' || frames <= 0 || frames > CODEC_BENCH_MAX_FRAMES)
+                {
+                    print_err_json("invalid_args");
+                    return 0;
+                }
+            }
+            else if (argc != 3)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            codec_bench_run_and_print_json((uint32_t)frames);
+            return 0;
+        }
+        if (strcmp(sub, "sim") == 0)
+        {
+            if (argc < 4)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            driver_sim_cmd(argc, argv);
+            return 0;
+        }
+        if (strcmp(sub, "xferbench") == 0)
+        {
+            unsigned long pairs = XFER_BENCH_DEFAULT_PAIRS;
+            if ((argc == 4 && (!parse_ulong_arg(argv[3], XFER_BENCH_MAX_PAIRS, &pairs) || pairs == 0)) || argc > 4)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            xfer_bench_run_and_print_json((uint32_t)pairs);
+            return 0;
+        }
+        if (strcmp(sub, "profile") == 0)
+        {
+            if (argc < 4)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            driver_profile_cmd(argc, argv);
+            return 0;
+        }
+        if (strcmp(sub, "scan") == 0)
+        {
+            if (argc != 3)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            driver_scan_print_json();
+            return 0;
+        }
+        if (strcmp(sub, "dump") == 0)
+        {
+            if (argc != 3)
+            {
+                print_err_json("invalid_args");
+                return 0;
+            }
+            driver_dump_print_json();
+            return 0;
+        }
         if (strcmp(sub, "acceptancetest") == 0)
         {
             if (argc != 3)
@@ -1088,12 +1968,9 @@ static int cmd_motor(int argc, char **argv)
             return 0;
         }
         char buf[256];
-        if (!motor_get_status_json(buf, sizeof(buf)))
-        {
-            print_err_json("motor");
-            return 0;
-        }
-        printf("%s\n", buf);
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf));
+        print_json_line(buf, motor_write_status_json(&w));
         return 0;
     }
     if (strcmp(argv[1], "enable") == 0)
@@ -1229,12 +2106,23 @@ static int cmd_motor(int argc, char **argv)
         printf("OK\n");
         return 0;
     }
+    if (strcmp(argv[1], "torque") == 0 && argc >= 3)
+    {
+        torque_cmd(argc, argv);
+        return 0;
+    }
     print_err_json("invalid_args");
     return 0;
 }
 
 void diag_console_run_startup_acceptancetest(void)
 {
+    // Driver bring-up is asynchronous; the canary is only meaningful once it has finished.
+    if (!motor_wait_driver_init(STARTUP_DRIVER_WAIT_MS))
+    {
+        print_err_json("driver_init_pending");
+        return;
+    }
     motor_driver_acceptancetest_run_and_print_json();
 }
 
@@ -1275,11 +2163,19 @@ static int cmd_selftest(int argc, char **argv)
     }
 
     char buf[SNAPSHOT_JSON_MAX];
-    if (!snapshot_build(buf, sizeof(buf)))
+    int64_t snap_start_us = esp_timer_get_time();
+    bool built = snapshot_build(buf, sizeof(buf));
+    int64_t snap_us = esp_timer_get_time() - snap_start_us;
+    if (!built)
     {
         printf("ERR snapshot_format\n");
         return 0;
     }
+    if (snap_us > SNAPSHOT_BUILD_BUDGET_US)
+    {
+        printf("ERR snapshot_latency %lldus\n", (long long)snap_us);
+        return 0;
+    }
     if (strpbrk(buf, "\r\n") != NULL)
     {
         printf("ERR snapshot_multiline\n");
@@ -1291,6 +2187,21 @@ static int cmd_selftest(int argc, char **argv)
         printf("ERR snapshot_format\n");
         return 0;
     }
+    const char *mismatch = snapshot_contract_mismatch();
+    if (mismatch != NULL)
+    {
+        printf("ERR snapshot_key %s\n", mismatch);
+        return 0;
+    }
+    for (size_t i = 0; i < snapshot_field_count(); ++i)
+    {
+        const char *key = snapshot_field_key(i);
+        if (json_find_key(buf, key) == NULL)
+        {
+            printf("ERR snapshot_key %s\n", key);
+            return 0;
+        }
+    }
 
     printf("OK\n");
     return 0;
@@ -1532,8 +2443,27 @@ static void register_commands(void)
     }
 }
 
+void diag_console_output_lock(void)
+{
+    if (s_output_lock != NULL)
+    {
+        xSemaphoreTakeRecursive(s_output_lock, portMAX_DELAY);
+    }
+}
+
+void diag_console_output_unlock(void)
+{
+    if (s_output_lock != NULL)
+    {
+        xSemaphoreGiveRecursive(s_output_lock);
+    }
+}
+
 void diag_console_start(void)
 {
+    // Before any command can start a background printer.
+    s_output_lock = xSemaphoreCreateRecursiveMutex();
+    ESP_ERROR_CHECK(s_output_lock != NULL ? ESP_OK : ESP_ERR_NO_MEM);
     esp_console_config_t console_config = {
         .max_cmdline_args = 8,
         .max_cmdline_length = 256,
@@ -1552,6 +2482,8 @@ void diag_console_start(void)
     printf("Type 'help' to list commands.\n\n");
 
     neopixel_set_mode(NEOPIXEL_MODE_READY);
+    boot_profile_end(BOOT_PHASE_CONSOLE_START);
+    s_console_ready_us = esp_timer_get_time();
     while (true)
     {
         char *line = linenoise("fw0002> ");
@@ -1565,6 +2497,7 @@ void diag_console_start(void)
         {
             linenoiseHistoryAdd(line);
             int ret = 0;
+            diag_console_output_lock();
             esp_err_t err = esp_console_run(line, &ret);
             if (err == ESP_ERR_NOT_FOUND)
             {
@@ -1578,6 +2511,8 @@ void diag_console_start(void)
             {
                 printf("Command error: %s\n", esp_err_to_name(err));
             }
+            fflush(stdout);
+            diag_console_output_unlock();
         }
         linenoiseFree(line);
     }
@@ -0,0 +1,179 @@
+#include "driver_acceptance.h"
+
+#include <string.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "motor.h"
+#include "stepper_driver_uart.h"
+
+#define ACCEPTANCE_MICROSTEPS 16
+#define ACCEPTANCE_LOW_HZ 200
+#define ACCEPTANCE_LOW_RUN_CURRENT 10
+#define ACCEPTANCE_LOW_HOLD_CURRENT 2
+#define ACCEPTANCE_BURSTS 100
+#define ACCEPTANCE_BURST_MS 20
+#define ACCEPTANCE_SETTLE_MS 500
+
+static void acceptance_fail(driver_acceptance_result_t *r, const char *err)
+{
+    if (r->error_count < DRIVER_ACCEPTANCE_MAX_ERRORS)
+    {
+        r->errors[r->error_count++] = err;
+    }
+}
+
+static void acceptance_expect_ok(driver_acceptance_result_t *r, esp_err_t err, const char *name)
+{
+    if (err != ESP_OK)
+    {
+        acceptance_fail(r, name);
+    }
+}
+
+// Reads DRV_STATUS and checks CS_ACTUAL against the commanded run current.
+static int acceptance_check_cs(driver_acceptance_result_t *r, uint8_t expected, const char *status_err,
+                               const char *cs_err)
+{
+    stepper_driver_status_t status;
+    if (stepper_driver_get_status(&status) != ESP_OK)
+    {
+        acceptance_fail(r, status_err);
+        return -1;
+    }
+    if (!status.drv_status_valid)
+    {
+        acceptance_fail(r, cs_err);
+        return -1;
+    }
+    if (status.cs_actual != expected)
+    {
+        acceptance_fail(r, cs_err);
+    }
+    return (int)status.cs_actual;
+}
+
+void driver_acceptance_run(driver_acceptance_result_t *out)
+{
+    driver_acceptance_result_t *r = out;
+    memset(r, 0, sizeof(*r));
+    r->ifcnt_start = -1;
+    r->ifcnt_end = -1;
+    r->cs31 = -1;
+    r->cs2 = -1;
+    r->stealthchop = -1;
+
+    acceptance_expect_ok(r, motor_disable(), "motor_disable");
+    acceptance_expect_ok(r, stepper_driver_set_microsteps(ACCEPTANCE_MICROSTEPS), "microsteps_set");
+    acceptance_expect_ok(r, stepper_driver_set_stealthchop(false), "stealthchop_set");
+    acceptance_expect_ok(r, stepper_driver_clear_faults(), "clearfaults");
+    uint8_t ifcnt = 0;
+    if (stepper_driver_read_ifcnt(&ifcnt) == ESP_OK)
+    {
+        r->ifcnt_start = (int)ifcnt;
+    }
+    else
+    {
+        acceptance_fail(r, "ifcnt_start");
+    }
+    stepper_driver_status_t status;
+    if (stepper_driver_get_status(&status) != ESP_OK)
+    {
+        acceptance_fail(r, "status_start");
+    }
+    else
+    {
+        r->microsteps = (int)status.microsteps;
+        if (status.microsteps != ACCEPTANCE_MICROSTEPS)
+        {
+            acceptance_fail(r, "microsteps");
+        }
+        if (status.stealthchop_valid)
+        {
+            r->stealthchop = status.stealthchop ? 1 : 0;
+        }
+        if (!status.stealthchop_valid || status.stealthchop)
+        {
+            acceptance_fail(r, "stealthchop");
+        }
+    }
+
+    acceptance_expect_ok(r, motor_enable(), "motor_enable");
+    acceptance_expect_ok(r, motor_set_dir(MOTOR_DIR_REV), "dir");
+    acceptance_expect_ok(r, motor_set_speed_hz(ACCEPTANCE_LOW_HZ), "speed");
+    acceptance_expect_ok(r, stepper_driver_set_current(ACCEPTANCE_LOW_RUN_CURRENT, ACCEPTANCE_LOW_HOLD_CURRENT, 0),
+                         "current_2");
+    acceptance_expect_ok(r, motor_start(), "start_2");
+    vTaskDelay(pdMS_TO_TICKS(ACCEPTANCE_SETTLE_MS));
+    acceptance_expect_ok(r, motor_stop(), "stop_2");
+    acceptance_expect_ok(r, motor_set_speed_hz(MOTOR_MAX_HZ), "speed");
+    acceptance_expect_ok(r, stepper_driver_set_current(31, 31, 0), "current_31");
+    // Jam-clear vibration: rapid direction bursts at MOTOR_MAX_HZ; raise limits only intentionally.
+    for (int i = 0; i < ACCEPTANCE_BURSTS; ++i)
+    {
+        acceptance_expect_ok(r, motor_set_dir(MOTOR_DIR_REV), "dir");
+        acceptance_expect_ok(r, motor_start(), "start_31");
+        vTaskDelay(pdMS_TO_TICKS(ACCEPTANCE_BURST_MS));
+        acceptance_expect_ok(r, motor_stop(), "stop_31");
+        acceptance_expect_ok(r, motor_set_dir(MOTOR_DIR_FWD), "dir");
+        acceptance_expect_ok(r, motor_start(), "start_31");
+        vTaskDelay(pdMS_TO_TICKS(ACCEPTANCE_BURST_MS));
+        acceptance_expect_ok(r, motor_stop(), "stop_31");
+    }
+    r->cs31 = acceptance_check_cs(r, 31, "status_31", "cs_actual_31");
+
+    acceptance_expect_ok(r, motor_set_dir(MOTOR_DIR_REV), "dir");
+    acceptance_expect_ok(r, motor_set_speed_hz(ACCEPTANCE_LOW_HZ), "speed");
+    acceptance_expect_ok(r, stepper_driver_set_current(ACCEPTANCE_LOW_RUN_CURRENT, ACCEPTANCE_LOW_HOLD_CURRENT, 0),
+                         "current_2");
+    acceptance_expect_ok(r, motor_start(), "start_2");
+    vTaskDelay(pdMS_TO_TICKS(ACCEPTANCE_SETTLE_MS));
+    r->cs2 = acceptance_check_cs(r, ACCEPTANCE_LOW_RUN_CURRENT, "status_2", "cs_actual_2");
+    acceptance_expect_ok(r, motor_stop(), "stop_2");
+    acceptance_expect_ok(r, motor_disable(), "motor_disable_end");
+    if (stepper_driver_read_ifcnt(&ifcnt) == ESP_OK)
+    {
+        r->ifcnt_end = (int)ifcnt;
+    }
+    else
+    {
+        acceptance_fail(r, "ifcnt_end");
+    }
+    if (r->ifcnt_start >= 0 && r->ifcnt_end >= 0 && r->ifcnt_end <= r->ifcnt_start)
+    {
+        acceptance_fail(r, "ifcnt_delta");
+    }
+}
+
+static bool acceptance_kv_int_or_null(json_writer_t *w, const char *key, int value, bool valid)
+{
+    return valid ? json_kv_i32(w, key, value) : json_kv_null(w, key);
+}
+
+bool driver_acceptance_write_json(const driver_acceptance_result_t *r, json_writer_t *w)
+{
+    json_obj_begin(w);
+    json_kv_str(w, "overall", (r->error_count == 0) ? "PASS" : "FAIL");
+    json_kv_i32(w, "ifcnt_start", r->ifcnt_start);
+    json_kv_i32(w, "ifcnt_end", r->ifcnt_end);
+    acceptance_kv_int_or_null(w, "cs31", r->cs31, r->cs31 >= 0);
+    acceptance_kv_int_or_null(w, "cs2", r->cs2, r->cs2 >= 0);
+    acceptance_kv_int_or_null(w, "microsteps", r->microsteps, r->microsteps > 0);
+    if (r->stealthchop >= 0)
+    {
+        json_kv_bool(w, "stealthchop", r->stealthchop != 0);
+    }
+    else
+    {
+        json_kv_null(w, "stealthchop");
+    }
+    json_write_key(w, "errors");
+    json_arr_begin(w);
+    for (size_t i = 0; i < r->error_count; ++i)
+    {
+        json_write_str(w, r->errors[i]);
+    }
+    json_arr_end(w);
+    return json_obj_end(w);
+}
@@ -0,0 +1,281 @@
+#include "driver_profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_storage.h"
+
+static const char *TAG = "driver_profile";
+
+#define DRIVER_PROFILE_NAMESPACE "drv_prof"
+#define DRIVER_PROFILE_KEY_PREFIX "p."
+#define DRIVER_PROFILE_ACTIVE_KEY "active"
+#define DRIVER_PROFILE_BLOB_VERSION 1
+
+// Stored layout; bump DRIVER_PROFILE_BLOB_VERSION when it changes.
+typedef struct
+{
+    uint8_t version;
+    uint8_t run_current;
+    uint8_t hold_current;
+    uint8_t hold_delay;
+    uint16_t microsteps;
+    uint8_t stealthchop;
+    uint8_t reserved;
+} driver_profile_blob_t;
+
+bool driver_profile_name_valid(const char *name)
+{
+    if (name == NULL)
+    {
+        return false;
+    }
+    size_t n = strlen(name);
+    if (n == 0 || n > DRIVER_PROFILE_NAME_MAX)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        char c = name[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' ||
+                  c == '-';
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void driver_profile_key(const char *name, char *key, size_t len)
+{
+    snprintf(key, len, DRIVER_PROFILE_KEY_PREFIX "%s", name);
+}
+
+static esp_err_t driver_profile_open(nvs_open_mode_t mode, nvs_handle_t *out)
+{
+    if (!nvs_storage_is_ready())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return nvs_open(DRIVER_PROFILE_NAMESPACE, mode, out);
+}
+
+static size_t driver_profile_count(void)
+{
+    size_t count = 0;
+    nvs_iterator_t it = NULL;
+    esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, DRIVER_PROFILE_NAMESPACE, NVS_TYPE_BLOB, &it);
+    while (err == ESP_OK)
+    {
+        count++;
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    return count;
+}
+
+esp_err_t driver_profile_save(const char *name, const motor_driver_defaults_t *cfg)
+{
+    if (!driver_profile_name_valid(name) || cfg == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    motor_driver_defaults_t existing;
+    if (driver_profile_load(name, &existing) == ESP_ERR_NOT_FOUND &&
+        driver_profile_count() >= DRIVER_PROFILE_MAX_COUNT)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = driver_profile_open(NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    const driver_profile_blob_t blob = {
+        .version = DRIVER_PROFILE_BLOB_VERSION,
+        .run_current = cfg->run_current,
+        .hold_current = cfg->hold_current,
+        .hold_delay = cfg->hold_delay,
+        .microsteps = cfg->microsteps,
+        .stealthchop = cfg->stealthchop ? 1 : 0,
+    };
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    driver_profile_key(name, key, sizeof(key));
+    err = nvs_set_blob(handle, key, &blob, sizeof(blob));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+static esp_err_t driver_profile_read_blob(nvs_handle_t handle, const char *key, motor_driver_defaults_t *out)
+{
+    driver_profile_blob_t blob;
+    size_t size = sizeof(blob);
+    esp_err_t err = nvs_get_blob(handle, key, &blob, &size);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (size != sizeof(blob) || blob.version != DRIVER_PROFILE_BLOB_VERSION)
+    {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    out->run_current = blob.run_current;
+    out->hold_current = blob.hold_current;
+    out->hold_delay = blob.hold_delay;
+    out->microsteps = blob.microsteps;
+    out->stealthchop = (blob.stealthchop != 0);
+    return ESP_OK;
+}
+
+esp_err_t driver_profile_load(const char *name, motor_driver_defaults_t *out)
+{
+    if (!driver_profile_name_valid(name) || out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = driver_profile_open(NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        // Namespace is created on first save.
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    driver_profile_key(name, key, sizeof(key));
+    err = driver_profile_read_blob(handle, key, out);
+    nvs_close(handle);
+    return err;
+}
+
+esp_err_t driver_profile_set_active(const char *name)
+{
+    if (!driver_profile_name_valid(name))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = driver_profile_open(NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = nvs_set_str(handle, DRIVER_PROFILE_ACTIVE_KEY, name);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+bool driver_profile_get_active(char *name, size_t len)
+{
+    if (name == NULL || len == 0)
+    {
+        return false;
+    }
+    nvs_handle_t handle;
+    if (driver_profile_open(NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+    size_t size = len;
+    esp_err_t err = nvs_get_str(handle, DRIVER_PROFILE_ACTIVE_KEY, name, &size);
+    nvs_close(handle);
+    return (err == ESP_OK);
+}
+
+bool driver_profile_boot_config(motor_driver_defaults_t *out, char *name, size_t name_len)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+    *out = motor_driver_defaults();
+    char active[DRIVER_PROFILE_NAME_MAX + 1];
+    if (!driver_profile_get_active(active, sizeof(active)))
+    {
+        return false;
+    }
+    motor_driver_defaults_t cfg;
+    esp_err_t err = driver_profile_load(active, &cfg);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "active profile '%s' unusable: %s", active, esp_err_to_name(err));
+        return false;
+    }
+    *out = cfg;
+    if (name != NULL && name_len > 0)
+    {
+        snprintf(name, name_len, "%s", active);
+    }
+    return true;
+}
+
+bool driver_profile_write_list_json(json_writer_t *w)
+{
+    char active[DRIVER_PROFILE_NAME_MAX + 1];
+    bool has_active = driver_profile_get_active(active, sizeof(active));
+    bool ok = json_obj_begin(w) &&
+              json_kv_str(w, "active", has_active ? active : NULL) &&
+              json_write_key(w, "profiles") &&
+              json_arr_begin(w);
+    nvs_handle_t handle;
+    bool opened = (driver_profile_open(NVS_READONLY, &handle) == ESP_OK);
+    nvs_iterator_t it = NULL;
+    esp_err_t err = opened ? nvs_entry_find(NVS_DEFAULT_PART_NAME, DRIVER_PROFILE_NAMESPACE, NVS_TYPE_BLOB, &it)
+                           : ESP_ERR_NOT_FOUND;
+    while (err == ESP_OK && ok)
+    {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+        motor_driver_defaults_t cfg;
+        if (strncmp(info.key, DRIVER_PROFILE_KEY_PREFIX, strlen(DRIVER_PROFILE_KEY_PREFIX)) == 0 &&
+            driver_profile_read_blob(handle, info.key, &cfg) == ESP_OK)
+        {
+            ok = json_obj_begin(w) &&
+                 json_kv_str(w, "name", info.key + strlen(DRIVER_PROFILE_KEY_PREFIX)) &&
+                 json_kv_u32(w, "run_current", cfg.run_current) &&
+                 json_kv_u32(w, "hold_current", cfg.hold_current) &&
+                 json_kv_u32(w, "hold_delay", cfg.hold_delay) &&
+                 json_kv_u32(w, "microsteps", cfg.microsteps) &&
+                 json_kv_bool(w, "stealthchop", cfg.stealthchop) &&
+                 json_obj_end(w);
+        }
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    if (opened)
+    {
+        nvs_close(handle);
+    }
+    return ok && json_arr_end(w) && json_obj_end(w);
+}
+
+bool driver_profile_list_json(char *buf, size_t len)
+{
+    if (buf == NULL || len == 0)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return driver_profile_write_list_json(&w);
+}
@@ -2,16 +2,28 @@
 
 #include <string.h>
 
+#include "esp_attr.h"
 #include "esp_timer.h"
 
-#define EVENTS_CAPACITY 64
+#define EVENTS_CAPACITY 64 // power of two
+#define EVENTS_SLOT_EMPTY 0U
+#define EVENTS_SLOT_BUSY UINT32_MAX
 
-static events_record_t s_events[EVENTS_CAPACITY];
-static size_t s_head = 0;
-static size_t s_count = 0;
+_Static_assert((EVENTS_CAPACITY & (EVENTS_CAPACITY - 1)) == 0, "EVENTS_CAPACITY must be a power of two");
+
+// stamp holds the id of the committed record, EMPTY, or BUSY while a producer writes it.
+typedef struct
+{
+    uint32_t stamp;
+    events_record_t rec;
+} events_slot_t;
+
+static events_slot_t s_slots[EVENTS_CAPACITY];
 static uint32_t s_next_id = 1;
+// Records with id <= s_clear_id are hidden by events_clear().
+static uint32_t s_clear_id = 0;
 
-static void events_copy_string(char *dst, size_t dst_len, const char *src)
+static void IRAM_ATTR events_copy_string(char *dst, size_t dst_len, const char *src)
 {
     if (dst_len == 0)
     {
@@ -30,60 +42,88 @@ static void events_copy_string(char *dst, size_t dst_len, const char *src)
     dst[i] = '\0';
 }
 
+FORCE_INLINE_ATTR events_slot_t *events_slot(uint32_t id)
+{
+    return &s_slots[(id - 1U) & (EVENTS_CAPACITY - 1U)];
+}
+
 void events_init(void)
 {
-    s_head = 0;
-    s_count = 0;
-    s_next_id = 1;
-    memset(s_events, 0, sizeof(s_events));
+    memset(s_slots, 0, sizeof(s_slots));
+    __atomic_store_n(&s_clear_id, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_next_id, 1, __ATOMIC_RELEASE);
 }
 
-bool events_emit(const char *type, const char *subsystem, int code, const char *reason)
+bool IRAM_ATTR events_emit(const char *type, const char *subsystem, int code, const char *reason)
 {
-    events_record_t *rec = &s_events[s_head];
-    rec->id = s_next_id++;
+    // Reserve an id; 0 and UINT32_MAX are slot markers, so skip them when the counter wraps.
+    uint32_t id;
+    do
+    {
+        id = __atomic_fetch_add(&s_next_id, 1, __ATOMIC_RELAXED);
+    } while (id == EVENTS_SLOT_EMPTY || id == EVENTS_SLOT_BUSY);
+
+    events_slot_t *slot = events_slot(id);
+    uint32_t prev = __atomic_load_n(&slot->stamp, __ATOMIC_ACQUIRE);
+    // Claim the slot unless another producer is writing it or already stored a newer record
+    // there (this one was preempted for a full lap); dropping beats interleaving two writes.
+    if (prev == EVENTS_SLOT_BUSY || (prev != EVENTS_SLOT_EMPTY && (int32_t)(prev - id) > 0) ||
+        !__atomic_compare_exchange_n(&slot->stamp, &prev, EVENTS_SLOT_BUSY, false, __ATOMIC_ACQUIRE,
+                                     __ATOMIC_RELAXED))
+    {
+        return false;
+    }
+    // The record writes below must not become visible before BUSY, or a reader could copy a
+    // half-written record while still seeing the old stamp on both sides of its copy.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    events_record_t *rec = &slot->rec;
+    rec->id = id;
     rec->ts_ms = esp_timer_get_time() / 1000;
     rec->code = code;
     events_copy_string(rec->type, sizeof(rec->type), type);
     events_copy_string(rec->subsystem, sizeof(rec->subsystem), subsystem);
     events_copy_string(rec->reason, sizeof(rec->reason), reason);
-
-    s_head = (s_head + 1) % EVENTS_CAPACITY;
-    if (s_count < EVENTS_CAPACITY)
-    {
-        s_count++;
-    }
+    __atomic_store_n(&slot->stamp, id, __ATOMIC_RELEASE);
     return true;
 }
 
 bool events_clear(void)
 {
-    s_head = 0;
-    s_count = 0;
-    memset(s_events, 0, sizeof(s_events));
+    __atomic_store_n(&s_clear_id, __atomic_load_n(&s_next_id, __ATOMIC_ACQUIRE) - 1U, __ATOMIC_RELEASE);
     return true;
 }
 
-void events_tail(size_t n, events_iter_cb_t cb, void *ctx)
+static bool events_read(uint32_t id, events_record_t *out)
 {
-    if (cb == NULL)
+    const events_slot_t *slot = events_slot(id);
+    if (__atomic_load_n(&slot->stamp, __ATOMIC_ACQUIRE) != id)
     {
-        return;
+        return false;
     }
-    if (n == 0 || s_count == 0)
+    *out = slot->rec;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (__atomic_load_n(&slot->stamp, __ATOMIC_RELAXED) == id);
+}
+
+void events_tail(size_t n, events_iter_cb_t cb, void *ctx)
+{
+    if (cb == NULL || n == 0)
     {
         return;
     }
-    size_t take = n;
-    if (take > s_count)
+    uint32_t last = __atomic_load_n(&s_next_id, __ATOMIC_ACQUIRE) - 1U;
+    uint32_t span = last - __atomic_load_n(&s_clear_id, __ATOMIC_ACQUIRE);
+    if (span > EVENTS_CAPACITY)
     {
-        take = s_count;
+        span = EVENTS_CAPACITY;
     }
-    size_t oldest = (s_head + EVENTS_CAPACITY - s_count) % EVENTS_CAPACITY;
-    size_t start = (oldest + (s_count - take)) % EVENTS_CAPACITY;
-    for (size_t i = 0; i < take; ++i)
+    uint32_t take = (n < span) ? (uint32_t)n : span;
+    for (uint32_t id = last - take + 1U; id != last + 1U; ++id)
     {
-        size_t idx = (start + i) % EVENTS_CAPACITY;
-        cb(&s_events[idx], ctx);
+        events_record_t copy;
+        if (events_read(id, &copy))
+        {
+            cb(&copy, ctx);
+        }
     }
 }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_helpers.h"
+
+// Fixed per-phase timestamps for app_main(); filled once per boot, read by `bootprof`.
+typedef enum
+{
+    BOOT_PHASE_EVENTS_INIT = 0,
+    BOOT_PHASE_NVS_INIT,
+    BOOT_PHASE_BOARD_INIT_SAFE,
+    BOOT_PHASE_MOTOR_INIT,
+    BOOT_PHASE_NEOPIXEL_INIT,
+    BOOT_PHASE_IR_EMITTER_INIT,
+    BOOT_PHASE_IR_SENSOR_INIT,
+    BOOT_PHASE_LOADCELL_INIT,
+    BOOT_PHASE_CONSOLE_START,
+    BOOT_PHASE_COUNT,
+} boot_phase_t;
+
+void boot_profile_begin(boot_phase_t phase);
+void boot_profile_end(boot_phase_t phase);
+const char *boot_profile_phase_name(boot_phase_t phase);
+// -1 if the phase was not recorded.
+int64_t boot_profile_phase_duration_us(boot_phase_t phase);
+// Time from boot to console ready.
+int64_t boot_profile_total_us(void);
+// Full record: app start, per-phase start/duration, total to console ready.
+bool boot_profile_write_json(json_writer_t *w);
+bool boot_profile_get_json(char *buf, size_t len);
+// Compact per-phase durations only (used by the optional snapshot field).
+bool boot_profile_write_summary_json(json_writer_t *w);
+bool boot_profile_get_summary_json(char *buf, size_t len);
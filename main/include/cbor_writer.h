@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal streaming CBOR (RFC 8949) encoder into a caller-owned buffer. Maps and arrays use
+// definite lengths, so callers must know the item count up front. Every call returns false
+// once the buffer is full; after that the writer stays failed and writes nothing more.
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t len;
+    size_t used;
+    bool overflow;
+} cbor_writer_t;
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t len);
+bool cbor_write_uint(cbor_writer_t *w, uint64_t value);
+bool cbor_write_int(cbor_writer_t *w, int64_t value);
+bool cbor_write_bool(cbor_writer_t *w, bool value);
+bool cbor_write_null(cbor_writer_t *w);
+// Single precision; the values we report never need more.
+bool cbor_write_float(cbor_writer_t *w, float value);
+bool cbor_write_text(cbor_writer_t *w, const char *s);
+bool cbor_write_text_n(cbor_writer_t *w, const char *s, size_t n);
+bool cbor_write_map(cbor_writer_t *w, size_t pairs);
+bool cbor_write_array(cbor_writer_t *w, size_t items);
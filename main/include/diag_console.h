@@ -1,4 +1,8 @@
 #pragma once
 void diag_console_start(void);
 void diag_console_run_startup_acceptancetest(void);
-
+// Console output lock, held by the console for the whole of each command. Background printers
+// (snapshot watch) take it around every line so their records never land inside a command's
+// multi-printf output. Recursive; a no-op until the console has started.
+void diag_console_output_lock(void);
+void diag_console_output_unlock(void);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "json_helpers.h"
+
+// TMC2209 acceptance sequence behind `motor driver acceptancetest` and the boot canary:
+// configures 16 microsteps / SpreadCycle, runs at low current, runs direction bursts at full
+// current, and checks CS_ACTUAL, the mode bits and that IFCNT advanced. Uses only the motor
+// and stepper driver APIs, so it runs unchanged against the simulator on the host.
+
+#define DRIVER_ACCEPTANCE_MAX_ERRORS 12
+
+typedef struct
+{
+    int ifcnt_start;  // -1 if the read failed
+    int ifcnt_end;    // -1 if the read failed
+    int cs31;         // CS_ACTUAL at run current 31; -1 if unread
+    int cs2;          // CS_ACTUAL back at run current 10; -1 if unread
+    int microsteps;   // 0 if unread or not register-selected
+    int stealthchop;  // 1/0, -1 if unread
+    size_t error_count;
+    const char *errors[DRIVER_ACCEPTANCE_MAX_ERRORS]; // static strings, first failures only
+} driver_acceptance_result_t;
+
+// Blocks for roughly 5 s while the motor runs.
+void driver_acceptance_run(driver_acceptance_result_t *out);
+// {"overall","ifcnt_start","ifcnt_end","cs31","cs2","microsteps","stealthchop","errors"}
+bool driver_acceptance_write_json(const driver_acceptance_result_t *r, json_writer_t *w);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "json_helpers.h"
+#include "motor_driver_defaults.h"
+
+// Named TMC2209 configurations in NVS. One profile may be marked active; it replaces the
+// compile-time motor_driver_defaults() at boot.
+#define DRIVER_PROFILE_NAME_MAX 12
+#define DRIVER_PROFILE_MAX_COUNT 8
+
+bool driver_profile_name_valid(const char *name);
+esp_err_t driver_profile_save(const char *name, const motor_driver_defaults_t *cfg);
+// ESP_ERR_NOT_FOUND if the profile does not exist.
+esp_err_t driver_profile_load(const char *name, motor_driver_defaults_t *out);
+esp_err_t driver_profile_set_active(const char *name);
+bool driver_profile_get_active(char *name, size_t len);
+// Active profile if one is set and readable, otherwise motor_driver_defaults().
+// Returns true when the settings came from NVS.
+bool driver_profile_boot_config(motor_driver_defaults_t *out, char *name, size_t name_len);
+bool driver_profile_write_list_json(json_writer_t *w);
+bool driver_profile_list_json(char *buf, size_t len);
@@ -21,6 +21,11 @@ typedef struct
 typedef void (*events_iter_cb_t)(const events_record_t *rec, void *ctx);
 
 void events_init(void);
+// Lock-free: safe from any task on either core and from ISRs (the function is in IRAM; an
+// ISR that runs with the flash cache disabled must pass strings placed in DRAM). Returns
+// false if the record was dropped because a stalled producer still held its slot.
 bool events_emit(const char *type, const char *subsystem, int code, const char *reason);
 bool events_clear(void);
+// Calls cb oldest-first for up to the n newest records. Records still being written are
+// skipped rather than waited for.
 void events_tail(size_t n, events_iter_cb_t cb, void *ctx);
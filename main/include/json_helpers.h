@@ -3,8 +3,59 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 void json_print_escaped_string(const char *s);
 bool json_escape_to_buf(const char *in, char *out, size_t out_len);
 
+// Bounded streaming JSON writer. Output goes straight into the caller's buffer (always
+// NUL-terminated) or, with json_writer_init_stdout(), straight to stdout, so producers need
+// no temporary buffers. Commas are inserted automatically between values and keys. Once a
+// write does not fit, the writer stays failed: every later call returns false and the
+// buffer holds the output up to the last complete write.
+typedef struct
+{
+    char *buf; // NULL: stdout
+    size_t len;
+    size_t used;
+    bool overflow;
+    bool need_comma;
+} json_writer_t;
+
+void json_writer_init(json_writer_t *w, char *buf, size_t len);
+void json_writer_init_stdout(json_writer_t *w);
+bool json_writer_ok(const json_writer_t *w);
+// Buffer mode: drop output after mark (an earlier w->used) and clear a failure it caused.
+void json_writer_rewind(json_writer_t *w, size_t mark, bool need_comma);
+
+bool json_obj_begin(json_writer_t *w);
+bool json_obj_end(json_writer_t *w);
+bool json_arr_begin(json_writer_t *w);
+bool json_arr_end(json_writer_t *w);
+bool json_write_key(json_writer_t *w, const char *key);
+// Key already encoded as "key": (quoted, escaped, with the colon), e.g. built from a literal.
+bool json_write_key_raw(json_writer_t *w, const char *encoded, size_t len);
+
+bool json_write_null(json_writer_t *w);
+bool json_write_bool(json_writer_t *w, bool value);
+bool json_write_u32(json_writer_t *w, uint32_t value);
+bool json_write_i32(json_writer_t *w, int32_t value);
+bool json_write_i64(json_writer_t *w, int64_t value);
+bool json_write_float(json_writer_t *w, float value, int decimals);
+// Escaped string; NULL writes null.
+bool json_write_str(json_writer_t *w, const char *s);
+// Pre-formatted JSON value, copied verbatim.
+bool json_write_raw(json_writer_t *w, const char *json);
+bool json_write_fmt(json_writer_t *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// "key":value shorthands.
+bool json_kv_null(json_writer_t *w, const char *key);
+bool json_kv_bool(json_writer_t *w, const char *key, bool value);
+bool json_kv_u32(json_writer_t *w, const char *key, uint32_t value);
+bool json_kv_i32(json_writer_t *w, const char *key, int32_t value);
+bool json_kv_i64(json_writer_t *w, const char *key, int64_t value);
+bool json_kv_float(json_writer_t *w, const char *key, float value, int decimals);
+bool json_kv_str(json_writer_t *w, const char *key, const char *s);
+bool json_kv_raw(json_writer_t *w, const char *key, const char *json);
+
 #endif
@@ -1,13 +1,72 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "json_helpers.h"
+#include "loadcell_ring.h"
+
+#define LOADCELL_ADC_RING_LEN LOADCELL_RING_LEN
+
+// Channel and gain for the next conversions (25, 26 or 27 SCK pulses per readout).
+typedef enum
+{
+    LOADCELL_ADC_GAIN_A128 = 0,
+    LOADCELL_ADC_GAIN_B32,
+    LOADCELL_ADC_GAIN_A64,
+    LOADCELL_ADC_GAIN_COUNT,
+} loadcell_adc_gain_t;
+
+typedef struct
+{
+    uint32_t samples;         // good conversions read
+    uint32_t corrupt;         // DOUT not released after the gain pulses; sample discarded
+    uint32_t out_of_range;    // saturated codes 0x7FFFFF / 0x800000 (kept)
+    uint32_t overlong;        // readouts that took longer than the clocking budget
+    uint32_t ready_timeouts;  // no DOUT edge within the sampling task's wait
+    uint32_t settle_discards; // conversions dropped after a channel/gain switch
+    uint32_t readout_last_ns;
+    uint32_t readout_max_ns;
+} loadcell_adc_stats_t;
+
+// Called from the sampling task for every good sample, after it is in the ring.
+typedef void (*loadcell_adc_sample_cb_t)(const loadcell_sample_t *sample);
 
 esp_err_t loadcell_adc_init(void);
+// Starts DOUT-edge driven sampling into the ring buffer. Once running, the read functions
+// below return buffered data and never wait for a conversion.
+esp_err_t loadcell_adc_start(void);
+bool loadcell_adc_is_running(void);
+void loadcell_adc_set_sample_cb(loadcell_adc_sample_cb_t cb);
+bool loadcell_adc_get_latest(loadcell_sample_t *out);
+// Cursor-based streaming: copies samples newer than *cursor, advances it, and reports
+// samples that were overwritten before they could be read.
+size_t loadcell_adc_read_since(uint32_t *cursor, loadcell_sample_t *out, size_t max, uint32_t *dropped);
+uint32_t loadcell_adc_cursor_now(void);
 bool loadcell_adc_is_ready(void);
 esp_err_t loadcell_adc_read_raw(int32_t *out);
 esp_err_t loadcell_adc_read_average(int samples, int32_t *avg_out);
+// Average of the newest buffered samples and the timestamp of the newest one, regardless
+// of age. ESP_ERR_TIMEOUT if nothing has been sampled yet.
+esp_err_t loadcell_adc_peek_average(int samples, int32_t *avg_out, int64_t *newest_us_out);
+// Takes effect at the next readout; the following conversions are discarded until settled.
+esp_err_t loadcell_adc_set_gain(loadcell_adc_gain_t gain);
+loadcell_adc_gain_t loadcell_adc_get_gain(void);
+const char *loadcell_adc_gain_name(loadcell_adc_gain_t gain);
+bool loadcell_adc_gain_from_name(const char *name, loadcell_adc_gain_t *out);
+// Configured conversion rate (10 or 80, matching the board's RATE strap); ready timeouts
+// and staleness limits are derived from it.
+esp_err_t loadcell_adc_set_rate_sps(uint16_t sps);
+uint16_t loadcell_adc_get_rate_sps(void);
+// Age after which buffered samples count as stale (five conversion periods).
+int64_t loadcell_adc_get_stale_us(void);
+// Rate observed from sample timestamps, in milli-samples per second (0 if unknown).
+uint32_t loadcell_adc_get_measured_rate_milli(void);
+void loadcell_adc_get_stats(loadcell_adc_stats_t *out);
+void loadcell_adc_reset_stats(void);
+bool loadcell_adc_write_stats_json(json_writer_t *w);
+bool loadcell_adc_get_stats_json(char *buf, size_t len);
 void loadcell_adc_power_down(void);
 void loadcell_adc_power_up(void);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "json_helpers.h"
+
+// Piecewise-linear load cell calibration. Points map tare-relative raw counts to
+// milligrams; (0, 0) is always the first node. Each segment keeps a Q24 slope so a
+// conversion is one multiply and shift. Values outside the points extrapolate the
+// nearest segment.
+
+#define LOADCELL_CAL_MAX_POINTS 8
+
+typedef struct
+{
+    int32_t raw_delta; // raw - tare offset when the point was taken
+    int32_t mg;
+} loadcell_cal_point_t;
+
+typedef struct
+{
+    uint8_t count;
+    loadcell_cal_point_t points[LOADCELL_CAL_MAX_POINTS]; // sorted by raw_delta
+    // Derived by loadcell_cal_add_point(): nodes include the (0, 0) anchor.
+    uint8_t node_count;
+    int32_t node_raw[LOADCELL_CAL_MAX_POINTS + 1];
+    int32_t node_mg[LOADCELL_CAL_MAX_POINTS + 1];
+    int64_t slope_q24[LOADCELL_CAL_MAX_POINTS]; // mg per count between node i and i + 1
+} loadcell_cal_t;
+
+void loadcell_cal_clear(loadcell_cal_t *cal);
+// ESP_ERR_INVALID_ARG for raw_delta 0 or a duplicate raw_delta, ESP_ERR_INVALID_SIZE if the
+// resulting slope is implausibly steep, ESP_ERR_NO_MEM when the table is full.
+esp_err_t loadcell_cal_add_point(loadcell_cal_t *cal, int32_t raw_delta, int32_t mg);
+bool loadcell_cal_is_valid(const loadcell_cal_t *cal);
+esp_err_t loadcell_cal_to_mg(const loadcell_cal_t *cal, int32_t raw_delta, int32_t *mg);
+// Raw counts per gram of the segment nearest zero (legacy single scale factor).
+float loadcell_cal_counts_per_gram(const loadcell_cal_t *cal);
+
+// NVS persistence: versioned blob with a CRC32 over points and tare offset.
+esp_err_t loadcell_cal_save(const loadcell_cal_t *cal, int32_t tare_offset_raw);
+// ESP_ERR_NOT_FOUND if nothing is stored, ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_VERSION if
+// the stored table is unusable.
+esp_err_t loadcell_cal_load(loadcell_cal_t *cal, int32_t *tare_offset_raw);
+esp_err_t loadcell_cal_erase(void);
+bool loadcell_cal_write_json(const loadcell_cal_t *cal, json_writer_t *w);
+bool loadcell_cal_get_json(const loadcell_cal_t *cal, char *buf, size_t len);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "json_helpers.h"
+
+// Integer filter chain for raw HX711 codes, applied stage by stage to every sample.
+// Only notch coefficients are computed with floats, once, when a stage is configured.
+
+#define LOADCELL_FILTER_MAX_STAGES 4
+#define LOADCELL_FILTER_MEDIAN_MAX 9 // odd window, 3..9
+#define LOADCELL_FILTER_MA_MAX 16    // window, 2..16
+#define LOADCELL_FILTER_IIR_SHIFT_MAX 8
+
+typedef enum
+{
+    LOADCELL_FILTER_MEDIAN = 0, // param: window (odd)
+    LOADCELL_FILTER_MA,         // param: window
+    LOADCELL_FILTER_IIR,        // param: k, y += (x - y) / 2^k
+    LOADCELL_FILTER_NOTCH,      // param: centre frequency in Hz (< sample_hz / 2)
+    LOADCELL_FILTER_KIND_COUNT,
+} loadcell_filter_kind_t;
+
+typedef struct
+{
+    loadcell_filter_kind_t kind;
+    uint16_t param;
+    uint8_t fill;
+    uint8_t pos;
+    bool primed;
+    int32_t window[LOADCELL_FILTER_MA_MAX];
+    int64_t sum;    // moving average
+    int64_t acc_q8; // IIR output, Q8
+    int32_t b0, b1, b2, a1, a2; // notch, Q14
+    int32_t x1, x2;
+    int64_t y1_q8, y2_q8;
+} loadcell_filter_stage_t;
+
+typedef struct
+{
+    uint8_t count;
+    uint16_t sample_hz;
+    loadcell_filter_stage_t stages[LOADCELL_FILTER_MAX_STAGES];
+} loadcell_filter_chain_t;
+
+void loadcell_filter_chain_init(loadcell_filter_chain_t *chain, uint16_t sample_hz);
+// Appends a stage; ESP_ERR_INVALID_ARG for a bad parameter, ESP_ERR_NO_MEM when full.
+esp_err_t loadcell_filter_chain_add(loadcell_filter_chain_t *chain, loadcell_filter_kind_t kind, uint16_t param);
+void loadcell_filter_chain_clear(loadcell_filter_chain_t *chain);
+// Drops filter history but keeps the configured stages.
+void loadcell_filter_chain_reset(loadcell_filter_chain_t *chain);
+// Recomputes notch coefficients for a new ADC rate; removes notches that no longer fit.
+void loadcell_filter_chain_set_sample_rate(loadcell_filter_chain_t *chain, uint16_t sample_hz);
+int32_t loadcell_filter_chain_apply(loadcell_filter_chain_t *chain, int32_t x);
+const char *loadcell_filter_kind_name(loadcell_filter_kind_t kind);
+bool loadcell_filter_kind_from_name(const char *name, loadcell_filter_kind_t *out);
+// JSON array of {"type","param"} in processing order.
+bool loadcell_filter_chain_write_json(const loadcell_filter_chain_t *chain, json_writer_t *w);
+bool loadcell_filter_chain_get_json(const loadcell_filter_chain_t *chain, char *buf, size_t len);
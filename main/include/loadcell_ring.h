@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Sample ring between the HX711 sampling task (the single producer) and any number of
+// readers on either core. head counts samples ever written; slot = seq & mask. Each slot
+// carries its seq as a sequence lock: readers copy the slot and re-check seq, so a sample
+// overwritten or still being written is reported missing instead of returned torn.
+// loadcell_ring_invalidate() hides everything pushed so far (e.g. after a gain switch, so
+// readers never mix counts taken at two settings).
+
+#define LOADCELL_RING_LEN 64 // power of two
+
+typedef struct
+{
+    int32_t raw;
+    uint32_t seq;  // monotonically increasing sample number
+    int64_t ts_us; // esp_timer time of the DOUT-ready edge, taken in the ISR (readout time if the
+                   // conversion finished while the edge was masked)
+} loadcell_sample_t;
+
+typedef struct
+{
+    loadcell_sample_t slots[LOADCELL_RING_LEN];
+    uint32_t head;
+    uint32_t valid_from; // samples with seq < valid_from are hidden
+} loadcell_ring_t;
+
+// Producer side. Returns the seq given to the sample.
+uint32_t loadcell_ring_push(loadcell_ring_t *ring, int32_t raw, int64_t ts_us);
+// Producer side: samples pushed before this call are no longer returned.
+void loadcell_ring_invalidate(loadcell_ring_t *ring);
+// Number of samples ever pushed; the newest sample is head - 1.
+uint32_t loadcell_ring_head(const loadcell_ring_t *ring);
+// Seq of the oldest sample not hidden by loadcell_ring_invalidate() (0 if never called).
+uint32_t loadcell_ring_valid_from(const loadcell_ring_t *ring);
+// false if sample seq was overwritten, invalidated, not written yet, or being written.
+bool loadcell_ring_get(const loadcell_ring_t *ring, uint32_t seq, loadcell_sample_t *out);
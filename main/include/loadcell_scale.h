@@ -5,12 +5,56 @@
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "json_helpers.h"
+#include "loadcell_adc.h"
+#include "loadcell_filter.h"
+
+// Values behind `scale status`; raw/age_ms are only meaningful with has_raw, grams with has_grams.
+typedef struct
+{
+    bool has_raw;
+    int32_t raw;
+    uint32_t age_ms;
+    bool has_grams;
+    float grams;
+    int32_t tare_offset_raw;
+    float scale_factor;
+    bool calibrated;
+} loadcell_scale_status_t;
 
 esp_err_t loadcell_scale_init(void);
+// With a filter chain configured, returns the newest filtered value and ignores samples.
 esp_err_t loadcell_scale_read_raw(int samples, int32_t *raw);
 esp_err_t loadcell_scale_read_grams(int samples, float *grams);
+// Integer conversion through the calibration table; grams helpers wrap it.
+esp_err_t loadcell_scale_raw_to_mg(int32_t raw, int32_t *mg);
 esp_err_t loadcell_scale_raw_to_grams(int32_t raw, float *grams);
 esp_err_t loadcell_scale_tare(int samples);
+// Replaces the calibration with a single point. Calibration changes are saved to NVS.
 esp_err_t loadcell_scale_calibrate(int samples, float known_grams);
+// Adds a point for piecewise-linear calibration; ESP_ERR_NO_MEM when the table is full,
+// ESP_ERR_INVALID_STATE for a zero or duplicate reading.
+esp_err_t loadcell_scale_cal_add(int samples, float known_grams);
+void loadcell_scale_cal_clear(void);
+bool loadcell_scale_write_cal_json(json_writer_t *w);
+bool loadcell_scale_cal_get_json(char *buf, size_t len);
+// Newest cached value (filter output, or the mean of the last few buffered samples) and its
+// age. Never waits for the ADC; ESP_ERR_NOT_FOUND if nothing has been sampled yet.
+esp_err_t loadcell_scale_get_cached(int32_t *raw, uint32_t *age_ms);
+// Built from loadcell_scale_get_cached(), so it is safe to call from latency-sensitive paths.
+void loadcell_scale_get_status(loadcell_scale_status_t *out);
+bool loadcell_scale_write_status_json(json_writer_t *w);
 bool loadcell_scale_get_status_json(char *buf, size_t len);
 bool loadcell_scale_is_calibrated(void);
+// Switch channel/gain; tare and calibration are not rescaled, redo them at the new gain.
+esp_err_t loadcell_scale_set_gain(loadcell_adc_gain_t gain);
+// Configured HX711 rate (10 or 80 SPS); notch stages that no longer fit are removed.
+esp_err_t loadcell_scale_set_rate(uint16_t sps);
+// Receives every raw sample from the sampling task; keep it short and non-blocking.
+typedef void (*loadcell_scale_sample_listener_t)(const loadcell_sample_t *sample);
+void loadcell_scale_set_sample_listener(loadcell_scale_sample_listener_t listener);
+bool loadcell_scale_filter_active(void);
+esp_err_t loadcell_scale_filter_add(loadcell_filter_kind_t kind, uint16_t param);
+void loadcell_scale_filter_clear(void);
+bool loadcell_scale_filter_write_json(json_writer_t *w);
+bool loadcell_scale_filter_get_json(char *buf, size_t len);
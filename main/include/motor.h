@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "json_helpers.h"
 
 #define MOTOR_MIN_HZ 50
 #define MOTOR_MAX_HZ 5000
@@ -23,12 +24,57 @@ typedef enum
     MOTOR_DIR_REV,
 } motor_dir_t;
 
+#define MOTOR_FAULT_REASON_MAX 32
+
+// Values behind `motor status`; step_hz is 0 while disabled.
+typedef struct
+{
+    motor_state_t state;
+    bool enabled;
+    uint32_t step_hz;
+    motor_dir_t dir;
+    int fault_code;
+    char fault_reason[MOTOR_FAULT_REASON_MAX];
+} motor_status_t;
+
+typedef enum
+{
+    MOTOR_DRIVER_INIT_PENDING = 0,
+    MOTOR_DRIVER_INIT_READY,
+    MOTOR_DRIVER_INIT_NO_RESPONSE, // UART up, no TMC2209 answered
+    MOTOR_DRIVER_INIT_FAILED,      // UART or task setup failed
+    MOTOR_DRIVER_INIT_CONFIG_FAILED, // driver answered, but the boot config did not apply
+} motor_driver_init_state_t;
+
+// Configures step/dir/enable and the step timer, then starts TMC2209 bring-up in the
+// background; use motor_get_driver_init_state() to see when it has finished.
 esp_err_t motor_init(void);
+motor_driver_init_state_t motor_get_driver_init_state(void);
+// Returns false if bring-up is still pending after timeout_ms.
+bool motor_wait_driver_init(uint32_t timeout_ms);
+bool motor_write_driver_init_json(json_writer_t *w);
+bool motor_get_driver_init_json(char *buf, size_t len);
 esp_err_t motor_enable(void);
 esp_err_t motor_disable(void);
 esp_err_t motor_set_dir(motor_dir_t dir);
 esp_err_t motor_set_speed_hz(uint32_t step_hz);
+// Blocking: while running, moves the rate to step_hz in 10 ms ticks of at most
+// accel_hz_per_s / 100 each and emits one motor_speed event at the end. When stopped it
+// behaves like motor_set_speed_hz.
+esp_err_t motor_ramp_speed_hz(uint32_t step_hz, uint32_t accel_hz_per_s);
 esp_err_t motor_start(void);
 esp_err_t motor_stop(void);
+// Also re-arms the DIAG edge event (one driver_diag event per arm).
 esp_err_t motor_clear_faults(void);
+motor_state_t motor_get_state(void);
+// Signed count of STEP pulses issued since boot or the last reset (ISR-maintained).
+int32_t motor_get_step_pos(void);
+void motor_reset_step_pos(void);
+// Commanded step rate while running, 0 otherwise.
+uint32_t motor_get_speed_hz(void);
+void motor_get_status(motor_status_t *out);
+bool motor_write_status_json(json_writer_t *w);
 bool motor_get_status_json(char *buf, size_t len);
+const char *motor_state_to_str(motor_state_t state);
+// "CW" / "CCW", as printed in status output.
+const char *motor_dir_to_str(motor_dir_t dir);
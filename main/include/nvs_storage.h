@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+// Initializes the default NVS partition once; erases and retries if the layout is stale.
+esp_err_t nvs_storage_init(void);
+bool nvs_storage_is_ready(void);
@@ -4,13 +4,46 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-typedef bool (*snapshot_value_fn)(char *buf, size_t len, size_t *used);
+// Upper bound for one snapshot_build() on the device, checked by selftest. The snapshot must
+// not depend on sensor conversion time; a few ms covers formatting.
+#define SNAPSHOT_BUILD_BUDGET_US 20000
 
-bool snapshot_register_field(const char *key, snapshot_value_fn value_fn);
 bool snapshot_build(char *buf, size_t len);
+// Same schema as snapshot_build() encoded as one CBOR map (RFC 8949) with text keys; no
+// heap use. *out_len is the encoded size on success.
+bool snapshot_build_cbor(uint8_t *buf, size_t len, size_t *out_len);
 
-bool snapshot_append_u32(char *buf, size_t len, size_t *used, uint32_t value);
-bool snapshot_append_i64(char *buf, size_t len, size_t *used, int64_t value);
-bool snapshot_append_bool(char *buf, size_t len, size_t *used, bool value);
-bool snapshot_append_string(char *buf, size_t len, size_t *used, const char *value);
-bool snapshot_append_raw(char *buf, size_t len, size_t *used, const char *value);
+// Change tracking for delta snapshots: the first record carries every field, later ones
+// only fields whose encoded value changed since the previous record.
+#define SNAPSHOT_DELTA_MAX_FIELDS 16
+
+typedef struct
+{
+    bool primed;
+    uint32_t seq;
+    uint32_t field_hash[SNAPSHOT_DELTA_MAX_FIELDS];
+} snapshot_delta_t;
+
+void snapshot_delta_reset(snapshot_delta_t *delta);
+// Writes {"seq":n,"full":bool,<fields>} and advances seq. On failure (buffer too small) the
+// tracked values may be partly updated; reset before the next record.
+bool snapshot_build_delta(snapshot_delta_t *delta, char *buf, size_t len, size_t *changed);
+
+// Per-field cost of one snapshot_build_profiled() call, measured with the CPU cycle counter
+// around the field's value function (key encoding is not included).
+typedef struct
+{
+    const char *key;
+    uint32_t cycles;
+} snapshot_field_timing_t;
+
+// Fields come from the compile-time table in snapshot.c, in output order.
+size_t snapshot_field_count(void);
+const char *snapshot_field_key(size_t index);
+// What the field is written as when its value cannot be read: the same object with every
+// member null (or null). False if the field has no fallback (its failure fails the build).
+bool snapshot_field_fallback_json(size_t index, char *buf, size_t len);
+// Same output as snapshot_build(); fills up to max_timings entries and stores how many in
+// *timing_count. On failure the timings cover the fields built so far.
+bool snapshot_build_profiled(char *buf, size_t len, snapshot_field_timing_t *timings, size_t max_timings,
+                             size_t *timing_count);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "json_helpers.h"
+
+// Periodic snapshot streaming: an esp_timer wakes a printer task every period, which
+// prints one delta record per line (see snapshot_build_delta()). The first record after
+// a start is always full.
+
+#define SNAPSHOT_WATCH_MIN_PERIOD_MS 50
+#define SNAPSHOT_WATCH_MAX_PERIOD_MS 60000
+
+// Restarts with a full record if already running.
+esp_err_t snapshot_watch_start(uint32_t period_ms);
+void snapshot_watch_stop(void);
+bool snapshot_watch_active(void);
+// active, period_ms, records, missed (timer periods skipped because printing fell behind).
+bool snapshot_watch_write_json(json_writer_t *w);
+bool snapshot_watch_get_json(char *buf, size_t len);
@@ -5,19 +5,144 @@
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "json_helpers.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "tmc2209_regs.h"
+#include "motor_driver_defaults.h"
 
-#define STEPPER_TMC_REG_GCONF    0x00
-#define STEPPER_TMC_REG_IFCNT    0x02
-#define STEPPER_TMC_REG_CHOPCONF 0x6C
+#define STEPPER_TMC_REG_GCONF    TMC2209_REG_GCONF
+#define STEPPER_TMC_REG_IFCNT    TMC2209_REG_IFCNT
+#define STEPPER_TMC_REG_CHOPCONF TMC2209_REG_CHOPCONF
 
-#define STEPPER_TMC_GCONF_PDN_DISABLE       (1u << 6)
-#define STEPPER_TMC_GCONF_MSTEP_REG_SELECT  (1u << 7)
-#define STEPPER_TMC_GCONF_I_SCALE_ANALOG    (1u << 0)
+#define STEPPER_TMC_GCONF_PDN_DISABLE       (1u << TMC2209_GCONF_PDN_DISABLE_SHIFT)
+#define STEPPER_TMC_GCONF_MSTEP_REG_SELECT  (1u << TMC2209_GCONF_MSTEP_REG_SELECT_SHIFT)
+#define STEPPER_TMC_GCONF_I_SCALE_ANALOG    (1u << TMC2209_GCONF_I_SCALE_ANALOG_SHIFT)
+
+// Latency histogram: bucket i counts reads faster than (BASE << i) us; last bucket is open-ended.
+#define STEPPER_UART_LAT_BUCKETS 10
+#define STEPPER_UART_LAT_BASE_US 512
+
+typedef struct
+{
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t ok;
+    uint32_t timeout;
+    uint32_t echo_only;
+    uint32_t crc_fail;
+    uint32_t wrong_reg;
+    uint32_t retries;
+    uint32_t batches;
+    uint32_t write_lost;
+    uint32_t backoffs;
+    uint32_t probes; // scan reads; not included in reads/ok/timeout or the histogram
+    uint32_t lat_max_us;
+    uint32_t lat_hist[STEPPER_UART_LAT_BUCKETS];
+} stepper_uart_stats_t;
+
+typedef struct
+{
+    uint8_t reg;
+    uint32_t value;
+} stepper_uart_write_t;
+
+#define STEPPER_TMC_MAX_SLAVES 4
+
+// One read of the driver status registers. Each *_valid flag says whether the register read
+// behind those fields succeeded; *_cmd are the last commanded values, not read back.
+typedef struct
+{
+    bool ifcnt_valid;
+    uint8_t ifcnt;
+    bool gstat_valid;
+    uint8_t gstat;
+    bool drv_status_valid; // also covers stst and cs_actual
+    uint32_t drv_status;
+    bool stst;
+    uint8_t cs_actual;
+    uint16_t microsteps; // 0 unless CHOPCONF.MRES selects the resolution and both reads succeeded
+    bool stealthchop_valid;
+    bool stealthchop;
+    uint8_t run_current_cmd;
+    uint8_t hold_current_cmd;
+    uint8_t hold_delay_cmd;
+} stepper_driver_status_t;
+
+typedef struct
+{
+    bool present;
+    bool ifcnt_ok;
+    uint8_t version;
+    uint8_t ifcnt;
+} stepper_driver_slave_info_t;
+
+typedef struct
+{
+    bool valid;
+    uint8_t count;
+    uint8_t active; // lowest responding address; used for all driver calls after a scan
+    uint32_t elapsed_us;
+    stepper_driver_slave_info_t slaves[STEPPER_TMC_MAX_SLAVES];
+} stepper_driver_scan_t;
+
+typedef struct
+{
+    const tmc2209_reg_t *reg;
+    uint32_t value;
+    esp_err_t err;
+} stepper_driver_reg_value_t;
+
+typedef enum
+{
+    STEPPER_UART_OP_READ = 0,
+    STEPPER_UART_OP_WRITE,
+} stepper_uart_op_t;
+
+typedef enum
+{
+    STEPPER_UART_PRIO_TELEMETRY = 0, // served only when no motion transfer is queued
+    STEPPER_UART_PRIO_MOTION,
+} stepper_uart_prio_t;
+
+typedef struct stepper_uart_xfer stepper_uart_xfer_t;
+// Runs in the bus task; keep it short and non-blocking.
+typedef void (*stepper_uart_done_cb_t)(stepper_uart_xfer_t *xfer, void *ctx);
+
+// Async bus transfer. Caller owns the struct and must keep it valid until completion.
+struct stepper_uart_xfer
+{
+    stepper_uart_op_t op;
+    stepper_uart_prio_t prio;
+    uint8_t slave;
+    uint8_t reg;
+    uint32_t value;             // write: value sent; read: value received
+    esp_err_t result;           // ESP_ERR_NOT_FINISHED until completion
+    stepper_uart_done_cb_t done_cb; // optional
+    void *ctx;
+    TaskHandle_t notify_task;   // optional; receives xTaskNotifyGive() on completion
+};
 
 esp_err_t stepper_uart_read_reg(uint8_t slave, uint8_t reg, uint32_t *out);
 esp_err_t stepper_uart_write_reg(uint8_t slave, uint8_t reg, uint32_t val);
 esp_err_t stepper_uart_ensure_gconf_uart_mode(uint8_t slave);
+// Sends all writes, then checks IFCNT once; only lost writes are retried.
+esp_err_t stepper_uart_write_batch(uint8_t slave, const stepper_uart_write_t *writes, size_t count);
+esp_err_t stepper_uart_submit(stepper_uart_xfer_t *xfer);
+// Holds the bus across a multi-transaction sequence (recursive; pair every acquire with a release).
+bool stepper_uart_bus_acquire(uint32_t timeout_ms);
+void stepper_uart_bus_release(void);
+void stepper_uart_get_stats(stepper_uart_stats_t *out);
+// ESP_ERR_TIMEOUT if the bus could not be acquired.
+esp_err_t stepper_uart_reset_stats(void);
+bool stepper_uart_write_stats_json(json_writer_t *w);
+bool stepper_uart_get_stats_json(char *buf, size_t len);
+bool stepper_uart_write_stats_summary_json(json_writer_t *w);
+bool stepper_uart_get_stats_summary_json(char *buf, size_t len);
 
+// Creates the bus lock, transfer queues and bus task; safe to call more than once.
+esp_err_t stepper_uart_bus_init(void);
+// Brings up UART1 and installs it as the default transport (stepper_uart_hal_uart.c).
 esp_err_t stepper_driver_uart_init(void);
 esp_err_t stepper_driver_ping(void);
 esp_err_t stepper_driver_read_ifcnt(uint8_t *out);
@@ -25,4 +150,22 @@ esp_err_t stepper_driver_set_stealthchop(bool enable);
 esp_err_t stepper_driver_set_microsteps(uint16_t microsteps);
 esp_err_t stepper_driver_set_current(uint8_t run, uint8_t hold, uint8_t hold_delay);
 esp_err_t stepper_driver_clear_faults(void);
+// Reliable mode routes driver register writes through stepper_uart_write_batch().
+void stepper_driver_set_reliable_writes(bool enable);
+bool stepper_driver_get_reliable_writes(void);
+// ESP_ERR_TIMEOUT if the bus could not be acquired; individual register failures are
+// reported through the *_valid flags.
+esp_err_t stepper_driver_get_status(stepper_driver_status_t *out);
+bool stepper_driver_write_status_json(const stepper_driver_status_t *st, json_writer_t *w);
 bool stepper_driver_get_status_json(char *buf, size_t len);
+// Writes mode, microsteps and currents as one IFCNT-checked batch and updates the cached values.
+esp_err_t stepper_driver_apply_config(const motor_driver_defaults_t *cfg);
+// Last commanded values (not read back from the chip).
+void stepper_driver_get_config(motor_driver_defaults_t *out);
+// The only call that changes the slave address (to the lowest responder).
+esp_err_t stepper_driver_scan(stepper_driver_scan_t *out);
+// Last scan result (valid == false before the first scan).
+void stepper_driver_get_last_scan(stepper_driver_scan_t *out);
+uint8_t stepper_driver_get_slave_addr(void);
+// Returns the number of entries filled (one per readable register, in map order).
+size_t stepper_driver_dump_regs(stepper_driver_reg_value_t *out, size_t max);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Byte-level transport under the TMC2209 driver. The driver itself has no UART dependency:
+// stepper_uart_hal_uart.c installs UART1 on GPIO17/18 as the default transport, and
+// tmc2209_sim provides a software model with the same semantics (one-wire echo of every
+// transmitted byte, reply after a read request). Until a transport is installed every
+// transfer fails with ESP_ERR_INVALID_STATE.
+typedef struct
+{
+    const char *name;
+    esp_err_t (*flush_input)(void);
+    // Returns bytes queued for transmit, or -1 on error.
+    int (*write)(const uint8_t *data, size_t len);
+    // Returns bytes read (0 on timeout), or -1 on error.
+    int (*read)(uint8_t *buf, size_t len, TickType_t timeout_ticks);
+    esp_err_t (*wait_tx_done)(TickType_t timeout_ticks);
+} stepper_uart_hal_t;
+
+// NULL restores the default transport. Switching waits for the bus lock.
+esp_err_t stepper_uart_set_hal(const stepper_uart_hal_t *hal);
+// Installs the transport that stepper_uart_set_hal(NULL) restores; it becomes active unless
+// an override is already in use.
+esp_err_t stepper_uart_set_default_hal(const stepper_uart_hal_t *hal);
+const stepper_uart_hal_t *stepper_uart_get_hal(void);
@@ -0,0 +1,226 @@
+#pragma once
+
+// TMC2209 register map (datasheet rev 1.09, section 5). The lists below are the single
+// source: register addresses, field shift/mask constants and the runtime decode tables
+// in tmc2209_regs.c are all expanded from them. Hardware-independent.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TMC2209_ACCESS_READ 0x01
+#define TMC2209_ACCESS_WRITE 0x02
+#define TMC2209_ACCESS_CLEAR 0x04 // write 1 to clear
+#define TMC2209_R TMC2209_ACCESS_READ
+#define TMC2209_W TMC2209_ACCESS_WRITE
+#define TMC2209_RW (TMC2209_ACCESS_READ | TMC2209_ACCESS_WRITE)
+#define TMC2209_RWC (TMC2209_ACCESS_READ | TMC2209_ACCESS_WRITE | TMC2209_ACCESS_CLEAR)
+
+// R(REG, addr, access)
+#define TMC2209_REG_LIST(R)           \
+    R(GCONF, 0x00, TMC2209_RW)        \
+    R(GSTAT, 0x01, TMC2209_RWC)       \
+    R(IFCNT, 0x02, TMC2209_R)         \
+    R(SLAVECONF, 0x03, TMC2209_W)     \
+    R(OTP_PROG, 0x04, TMC2209_W)      \
+    R(OTP_READ, 0x05, TMC2209_R)      \
+    R(IOIN, 0x06, TMC2209_R)          \
+    R(FACTORY_CONF, 0x07, TMC2209_RW) \
+    R(IHOLD_IRUN, 0x10, TMC2209_W)    \
+    R(TPOWERDOWN, 0x11, TMC2209_W)    \
+    R(TSTEP, 0x12, TMC2209_R)         \
+    R(TPWMTHRS, 0x13, TMC2209_W)      \
+    R(TCOOLTHRS, 0x14, TMC2209_W)     \
+    R(VACTUAL, 0x22, TMC2209_W)       \
+    R(SGTHRS, 0x40, TMC2209_W)        \
+    R(SG_RESULT, 0x41, TMC2209_R)     \
+    R(COOLCONF, 0x42, TMC2209_W)      \
+    R(MSCNT, 0x6A, TMC2209_R)         \
+    R(MSCURACT, 0x6B, TMC2209_R)      \
+    R(CHOPCONF, 0x6C, TMC2209_RW)     \
+    R(DRV_STATUS, 0x6F, TMC2209_R)    \
+    R(PWMCONF, 0x70, TMC2209_RW)      \
+    R(PWM_SCALE, 0x71, TMC2209_R)     \
+    R(PWM_AUTO, 0x72, TMC2209_R)
+
+// F(REG, FIELD, name, offset, width) per register.
+#define TMC2209_GCONF_FIELDS(F)                                  \
+    F(GCONF, I_SCALE_ANALOG, i_scale_analog, 0, 1)               \
+    F(GCONF, INTERNAL_RSENSE, internal_rsense, 1, 1)             \
+    F(GCONF, EN_SPREADCYCLE, en_spreadcycle, 2, 1)               \
+    F(GCONF, SHAFT, shaft, 3, 1)                                 \
+    F(GCONF, INDEX_OTPW, index_otpw, 4, 1)                       \
+    F(GCONF, INDEX_STEP, index_step, 5, 1)                       \
+    F(GCONF, PDN_DISABLE, pdn_disable, 6, 1)                     \
+    F(GCONF, MSTEP_REG_SELECT, mstep_reg_select, 7, 1)           \
+    F(GCONF, MULTISTEP_FILT, multistep_filt, 8, 1)               \
+    F(GCONF, TEST_MODE, test_mode, 9, 1)
+#define TMC2209_GSTAT_FIELDS(F)          \
+    F(GSTAT, RESET, reset, 0, 1)         \
+    F(GSTAT, DRV_ERR, drv_err, 1, 1)     \
+    F(GSTAT, UV_CP, uv_cp, 2, 1)
+#define TMC2209_IFCNT_FIELDS(F) \
+    F(IFCNT, IFCNT, ifcnt, 0, 8)
+#define TMC2209_SLAVECONF_FIELDS(F) \
+    F(SLAVECONF, SENDDELAY, senddelay, 8, 4)
+#define TMC2209_OTP_PROG_FIELDS(F)           \
+    F(OTP_PROG, OTPBIT, otpbit, 0, 3)        \
+    F(OTP_PROG, OTPBYTE, otpbyte, 4, 2)      \
+    F(OTP_PROG, OTPMAGIC, otpmagic, 8, 8)
+#define TMC2209_OTP_READ_FIELDS(F)       \
+    F(OTP_READ, OTP0, otp0, 0, 8)        \
+    F(OTP_READ, OTP1, otp1, 8, 8)        \
+    F(OTP_READ, OTP2, otp2, 16, 8)
+#define TMC2209_IOIN_FIELDS(F)                 \
+    F(IOIN, ENN, enn, 0, 1)                    \
+    F(IOIN, MS1, ms1, 2, 1)                    \
+    F(IOIN, MS2, ms2, 3, 1)                    \
+    F(IOIN, DIAG, diag, 4, 1)                  \
+    F(IOIN, PDN_UART, pdn_uart, 6, 1)          \
+    F(IOIN, STEP, step, 7, 1)                  \
+    F(IOIN, SPREAD_EN, spread_en, 8, 1)        \
+    F(IOIN, DIR, dir, 9, 1)                    \
+    F(IOIN, VERSION, version, 24, 8)
+#define TMC2209_FACTORY_CONF_FIELDS(F)           \
+    F(FACTORY_CONF, FCLKTRIM, fclktrim, 0, 5)    \
+    F(FACTORY_CONF, OTTRIM, ottrim, 8, 2)
+#define TMC2209_IHOLD_IRUN_FIELDS(F)                 \
+    F(IHOLD_IRUN, IHOLD, ihold, 0, 5)                \
+    F(IHOLD_IRUN, IRUN, irun, 8, 5)                  \
+    F(IHOLD_IRUN, IHOLDDELAY, iholddelay, 16, 4)
+#define TMC2209_TPOWERDOWN_FIELDS(F) \
+    F(TPOWERDOWN, TPOWERDOWN, tpowerdown, 0, 8)
+#define TMC2209_TSTEP_FIELDS(F) \
+    F(TSTEP, TSTEP, tstep, 0, 20)
+#define TMC2209_TPWMTHRS_FIELDS(F) \
+    F(TPWMTHRS, TPWMTHRS, tpwmthrs, 0, 20)
+#define TMC2209_TCOOLTHRS_FIELDS(F) \
+    F(TCOOLTHRS, TCOOLTHRS, tcoolthrs, 0, 20)
+#define TMC2209_VACTUAL_FIELDS(F) \
+    F(VACTUAL, VACTUAL, vactual, 0, 24)
+#define TMC2209_SGTHRS_FIELDS(F) \
+    F(SGTHRS, SGTHRS, sgthrs, 0, 8)
+#define TMC2209_SG_RESULT_FIELDS(F) \
+    F(SG_RESULT, SG_RESULT, sg_result, 0, 10)
+#define TMC2209_COOLCONF_FIELDS(F)           \
+    F(COOLCONF, SEMIN, semin, 0, 4)          \
+    F(COOLCONF, SEUP, seup, 5, 2)            \
+    F(COOLCONF, SEMAX, semax, 8, 4)          \
+    F(COOLCONF, SEDN, sedn, 13, 2)           \
+    F(COOLCONF, SEIMIN, seimin, 15, 1)
+#define TMC2209_MSCNT_FIELDS(F) \
+    F(MSCNT, MSCNT, mscnt, 0, 10)
+#define TMC2209_MSCURACT_FIELDS(F)           \
+    F(MSCURACT, CUR_A, cur_a, 0, 9)          \
+    F(MSCURACT, CUR_B, cur_b, 16, 9)
+#define TMC2209_CHOPCONF_FIELDS(F)           \
+    F(CHOPCONF, TOFF, toff, 0, 4)            \
+    F(CHOPCONF, HSTRT, hstrt, 4, 3)          \
+    F(CHOPCONF, HEND, hend, 7, 4)            \
+    F(CHOPCONF, TBL, tbl, 15, 2)             \
+    F(CHOPCONF, VSENSE, vsense, 17, 1)       \
+    F(CHOPCONF, MRES, mres, 24, 4)           \
+    F(CHOPCONF, INTPOL, intpol, 28, 1)       \
+    F(CHOPCONF, DEDGE, dedge, 29, 1)         \
+    F(CHOPCONF, DISS2G, diss2g, 30, 1)       \
+    F(CHOPCONF, DISS2VS, diss2vs, 31, 1)
+#define TMC2209_DRV_STATUS_FIELDS(F)             \
+    F(DRV_STATUS, OTPW, otpw, 0, 1)              \
+    F(DRV_STATUS, OT, ot, 1, 1)                  \
+    F(DRV_STATUS, S2GA, s2ga, 2, 1)              \
+    F(DRV_STATUS, S2GB, s2gb, 3, 1)              \
+    F(DRV_STATUS, S2VSA, s2vsa, 4, 1)            \
+    F(DRV_STATUS, S2VSB, s2vsb, 5, 1)            \
+    F(DRV_STATUS, OLA, ola, 6, 1)                \
+    F(DRV_STATUS, OLB, olb, 7, 1)                \
+    F(DRV_STATUS, T120, t120, 8, 1)              \
+    F(DRV_STATUS, T143, t143, 9, 1)              \
+    F(DRV_STATUS, T150, t150, 10, 1)             \
+    F(DRV_STATUS, T157, t157, 11, 1)             \
+    F(DRV_STATUS, CS_ACTUAL, cs_actual, 16, 5)   \
+    F(DRV_STATUS, STEALTH, stealth, 30, 1)       \
+    F(DRV_STATUS, STST, stst, 31, 1)
+#define TMC2209_PWMCONF_FIELDS(F)                    \
+    F(PWMCONF, PWM_OFS, pwm_ofs, 0, 8)               \
+    F(PWMCONF, PWM_GRAD, pwm_grad, 8, 8)             \
+    F(PWMCONF, PWM_FREQ, pwm_freq, 16, 2)            \
+    F(PWMCONF, PWM_AUTOSCALE, pwm_autoscale, 18, 1)  \
+    F(PWMCONF, PWM_AUTOGRAD, pwm_autograd, 19, 1)    \
+    F(PWMCONF, FREEWHEEL, freewheel, 20, 2)          \
+    F(PWMCONF, PWM_REG, pwm_reg, 24, 4)              \
+    F(PWMCONF, PWM_LIM, pwm_lim, 28, 4)
+#define TMC2209_PWM_SCALE_FIELDS(F)                      \
+    F(PWM_SCALE, PWM_SCALE_SUM, pwm_scale_sum, 0, 8)     \
+    F(PWM_SCALE, PWM_SCALE_AUTO, pwm_scale_auto, 16, 9)
+#define TMC2209_PWM_AUTO_FIELDS(F)                       \
+    F(PWM_AUTO, PWM_OFS_AUTO, pwm_ofs_auto, 0, 8)        \
+    F(PWM_AUTO, PWM_GRAD_AUTO, pwm_grad_auto, 16, 8)
+
+// Register addresses: TMC2209_REG_<REG>.
+#define TMC2209_REG_ENUM_ENTRY(reg, addr, access) TMC2209_REG_##reg = (addr),
+enum
+{
+    TMC2209_REG_LIST(TMC2209_REG_ENUM_ENTRY)
+};
+
+#define TMC2209_REG_COUNT_ENTRY(reg, addr, access) +1
+#define TMC2209_REG_COUNT (0 TMC2209_REG_LIST(TMC2209_REG_COUNT_ENTRY))
+
+// Field constants: TMC2209_<REG>_<FIELD>_SHIFT / _MASK (mask is right-aligned).
+#define TMC2209_FIELD_ENUM_ENTRY(reg, field, name, offset, width) \
+    TMC2209_##reg##_##field##_SHIFT = (offset),                   \
+    TMC2209_##reg##_##field##_MASK = (int)((1UL << (width)) - 1UL),
+#define TMC2209_REG_FIELD_ENUMS(reg, addr, access) TMC2209_##reg##_FIELDS(TMC2209_FIELD_ENUM_ENTRY)
+enum
+{
+    TMC2209_REG_LIST(TMC2209_REG_FIELD_ENUMS)
+};
+
+#define TMC2209_FIELD_GET(value, reg, field) \
+    (((uint32_t)(value) >> TMC2209_##reg##_##field##_SHIFT) & (uint32_t)TMC2209_##reg##_##field##_MASK)
+#define TMC2209_FIELD_SET(value, reg, field, field_value)                                               \
+    (((uint32_t)(value) & ~((uint32_t)TMC2209_##reg##_##field##_MASK << TMC2209_##reg##_##field##_SHIFT)) | \
+     (((uint32_t)(field_value) & (uint32_t)TMC2209_##reg##_##field##_MASK) << TMC2209_##reg##_##field##_SHIFT))
+
+typedef struct
+{
+    const char *name;
+    uint8_t offset;
+    uint8_t width;
+} tmc2209_field_t;
+
+typedef struct
+{
+    const char *name;
+    uint8_t addr;
+    uint8_t access;
+    const tmc2209_field_t *fields;
+    uint8_t field_count;
+} tmc2209_reg_t;
+
+typedef struct
+{
+    bool otpw;
+    bool ot;
+    bool s2ga;
+    bool s2gb;
+    bool s2vsa;
+    bool s2vsb;
+    bool ola;
+    bool olb;
+    bool t120;
+    bool t143;
+    bool t150;
+    bool t157;
+    uint8_t cs_actual;
+    bool stealth;
+    bool stst;
+} tmc2209_drv_status_t;
+
+const tmc2209_reg_t *tmc2209_regs(size_t *count);
+const tmc2209_reg_t *tmc2209_reg_find(uint8_t addr);
+static inline uint32_t tmc2209_field_value(const tmc2209_field_t *field, uint32_t reg_value)
+{
+    return (reg_value >> field->offset) & (uint32_t)((1ULL << field->width) - 1ULL);
+}
+void tmc2209_decode_drv_status(uint32_t raw, tmc2209_drv_status_t *out);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stepper_uart_hal.h"
+
+// Software TMC2209 behind the stepper UART HAL: register file, IFCNT on valid
+// writes, CRC checking, one-wire echo and seeded (reproducible) fault injection.
+
+typedef struct
+{
+    uint8_t drop_pct;    // read requests answered with echo only
+    uint8_t corrupt_pct; // replies with one flipped data bit (CRC fails)
+    uint8_t lose_pct;    // writes echoed but not applied (IFCNT unchanged)
+    uint16_t delay_ms;   // extra latency before a reply becomes readable
+    bool no_echo;        // suppress the one-wire echo of transmitted bytes
+} tmc2209_sim_faults_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t bad_crc;
+    uint32_t other_slave;
+    uint32_t dropped;
+    uint32_t corrupted;
+    uint32_t lost;
+    uint32_t delayed;
+} tmc2209_sim_stats_t;
+
+const stepper_uart_hal_t *tmc2209_sim_hal(void);
+// Restores power-on register values and clears IFCNT, RX state and stats.
+void tmc2209_sim_reset(void);
+void tmc2209_sim_set_slave(uint8_t slave);
+void tmc2209_sim_seed(uint32_t seed);
+void tmc2209_sim_set_faults(const tmc2209_sim_faults_t *faults);
+void tmc2209_sim_get_faults(tmc2209_sim_faults_t *out);
+void tmc2209_sim_get_stats(tmc2209_sim_stats_t *out);
+uint32_t tmc2209_sim_peek_reg(uint8_t reg);
+bool tmc2209_sim_get_status_json(char *buf, size_t len);
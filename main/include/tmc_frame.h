@@ -0,0 +1,31 @@
+#pragma once
+
+// TMC2209 UART frame codec. Hardware-independent (no ESP-IDF includes) so it
+// builds unchanged for the target and for the ESP-IDF linux host target.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TMC_FRAME_SYNC 0x05
+#define TMC_FRAME_MASTER_ADDR 0xFF
+#define TMC_FRAME_WRITE_BIT 0x80
+#define TMC_FRAME_READ_REQ_LEN 4
+#define TMC_FRAME_WRITE_REQ_LEN 8
+#define TMC_FRAME_REPLY_LEN 8
+
+typedef enum
+{
+    TMC_FRAME_OK = 0,
+    TMC_FRAME_SHORT,     // fewer than TMC_FRAME_REPLY_LEN bytes
+    TMC_FRAME_CRC_FAIL,  // no candidate with a valid CRC
+    TMC_FRAME_WRONG_REG, // valid reply, but for another register
+} tmc_frame_status_t;
+
+uint8_t tmc_frame_crc(const uint8_t *data, size_t len);
+size_t tmc_frame_encode_read(uint8_t out[TMC_FRAME_READ_REQ_LEN], uint8_t slave, uint8_t reg);
+size_t tmc_frame_encode_write(uint8_t out[TMC_FRAME_WRITE_REQ_LEN], uint8_t slave, uint8_t reg, uint32_t value);
+// Locates the last valid reply for reg inside rx (echo and noise are skipped).
+// On TMC_FRAME_OK, *reply_out points into rx; nothing is copied.
+tmc_frame_status_t tmc_frame_decode_reply(const uint8_t *rx, size_t len, uint8_t reg, const uint8_t **reply_out);
+uint32_t tmc_frame_reply_value(const uint8_t *reply);
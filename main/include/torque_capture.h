@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Pull-out torque sweep: steps the motor through a speed ramp, bins load cell samples
+// tagged with step position and commanded rate per speed level, and stops at the first
+// level whose force collapses (or the driver reports a fault).
+
+#define TORQUE_CAPTURE_MAX_LEVELS 32
+#define TORQUE_CAPTURE_TRACE_LEN 1024
+
+typedef struct
+{
+    uint32_t start_hz;
+    uint32_t end_hz;
+    uint32_t step_hz;
+    uint32_t dwell_ms;      // per level; the first half settles, the second half is measured
+    uint32_t arm_mm;        // lever arm for torque; 0 reports force only
+    uint8_t stall_drop_pct; // stall when |force| falls this far below the peak so far
+} torque_capture_config_t;
+
+typedef enum
+{
+    TORQUE_CAPTURE_IDLE = 0,
+    TORQUE_CAPTURE_RUNNING,
+    TORQUE_CAPTURE_STALLED,  // stall found; pullout_hz is the last good level
+    TORQUE_CAPTURE_COMPLETE, // reached end_hz without a stall
+    TORQUE_CAPTURE_ABORTED,
+    TORQUE_CAPTURE_FAILED,
+} torque_capture_state_t;
+
+// One load cell sample with the motor state at the moment it was read.
+typedef struct
+{
+    int32_t raw;
+    int32_t step_pos;
+    uint32_t t_ms; // since capture start
+    uint16_t step_hz;
+    uint16_t level; // UINT16_MAX during the baseline
+} torque_sample_t;
+
+typedef struct
+{
+    uint32_t step_hz;
+    uint32_t samples;
+    int32_t raw_mean;
+    int32_t raw_min;
+    int32_t raw_max;
+    int32_t steps; // STEP pulses counted while the level was measured
+    uint32_t drv_status;
+    bool drv_ok;
+} torque_level_t;
+
+typedef struct
+{
+    torque_capture_state_t state;
+    const char *reason;
+    torque_capture_config_t cfg;
+    int32_t baseline_raw;
+    uint32_t stall_hz;   // 0 if none
+    uint32_t pullout_hz; // highest level before the stall
+    size_t level_count;
+    size_t trace_count;
+    uint32_t trace_dropped;
+} torque_capture_summary_t;
+
+void torque_capture_default_config(torque_capture_config_t *out);
+// The motor must be enabled and stopped; ESP_ERR_INVALID_STATE otherwise or while a
+// capture is running.
+esp_err_t torque_capture_start(const torque_capture_config_t *cfg);
+void torque_capture_stop(void);
+torque_capture_state_t torque_capture_get_state(void);
+const char *torque_capture_state_name(torque_capture_state_t state);
+void torque_capture_get_summary(torque_capture_summary_t *out);
+bool torque_capture_get_level(size_t index, torque_level_t *out);
+// Oldest-first copy of tagged samples from the last capture.
+size_t torque_capture_read_trace(size_t start, torque_sample_t *out, size_t max);
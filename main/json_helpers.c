@@ -1,6 +1,8 @@
 #include "json_helpers.h"
 
+#include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 static void json_print_escaped_char(unsigned char c)
 {
@@ -133,3 +135,369 @@ bool json_escape_to_buf(const char *in, char *out, size_t out_len)
     out[pos] = '\0';
     return true;
 }
+
+void json_writer_init(json_writer_t *w, char *buf, size_t len)
+{
+    if (w == NULL)
+    {
+        return;
+    }
+    w->buf = buf;
+    w->len = len;
+    w->used = 0;
+    w->overflow = (buf == NULL || len == 0);
+    w->need_comma = false;
+    if (!w->overflow)
+    {
+        buf[0] = '\0';
+    }
+}
+
+void json_writer_init_stdout(json_writer_t *w)
+{
+    if (w == NULL)
+    {
+        return;
+    }
+    w->buf = NULL;
+    w->len = 0;
+    w->used = 0;
+    w->overflow = false;
+    w->need_comma = false;
+}
+
+bool json_writer_ok(const json_writer_t *w)
+{
+    return (w != NULL && !w->overflow);
+}
+
+void json_writer_rewind(json_writer_t *w, size_t mark, bool need_comma)
+{
+    if (w == NULL || w->buf == NULL || w->len == 0 || mark > w->used)
+    {
+        return;
+    }
+    w->used = mark;
+    w->buf[mark] = '\0';
+    w->overflow = false;
+    w->need_comma = need_comma;
+}
+
+static bool json_put(json_writer_t *w, const char *s, size_t n)
+{
+    if (w == NULL || w->overflow)
+    {
+        return false;
+    }
+    if (w->buf == NULL)
+    {
+        fwrite(s, 1, n, stdout);
+        w->used += n;
+        return true;
+    }
+    if (n >= w->len - w->used)
+    {
+        w->overflow = true;
+        return false;
+    }
+    memcpy(&w->buf[w->used], s, n);
+    w->used += n;
+    w->buf[w->used] = '\0';
+    return true;
+}
+
+static bool json_vput(json_writer_t *w, const char *fmt, va_list ap)
+{
+    if (w == NULL || w->overflow)
+    {
+        return false;
+    }
+    if (w->buf == NULL)
+    {
+        int written = vprintf(fmt, ap);
+        if (written < 0)
+        {
+            w->overflow = true;
+            return false;
+        }
+        w->used += (size_t)written;
+        return true;
+    }
+    size_t room = w->len - w->used;
+    int written = vsnprintf(&w->buf[w->used], room, fmt, ap);
+    if (written < 0 || (size_t)written >= room)
+    {
+        w->buf[w->used] = '\0';
+        w->overflow = true;
+        return false;
+    }
+    w->used += (size_t)written;
+    return true;
+}
+
+static bool json_sep(json_writer_t *w)
+{
+    if (w != NULL && w->need_comma)
+    {
+        if (!json_put(w, ",", 1))
+        {
+            return false;
+        }
+        w->need_comma = false;
+    }
+    return json_writer_ok(w);
+}
+
+static bool json_value_done(json_writer_t *w, bool ok)
+{
+    if (ok)
+    {
+        w->need_comma = true;
+    }
+    return ok;
+}
+
+bool json_obj_begin(json_writer_t *w)
+{
+    return json_sep(w) && json_put(w, "{", 1);
+}
+
+bool json_obj_end(json_writer_t *w)
+{
+    return json_value_done(w, json_put(w, "}", 1));
+}
+
+bool json_arr_begin(json_writer_t *w)
+{
+    return json_sep(w) && json_put(w, "[", 1);
+}
+
+bool json_arr_end(json_writer_t *w)
+{
+    return json_value_done(w, json_put(w, "]", 1));
+}
+
+static bool json_put_escaped(json_writer_t *w, const char *s)
+{
+    if (!json_put(w, "\"", 1))
+    {
+        return false;
+    }
+    const char *run = s;
+    for (const unsigned char *p = (const unsigned char *)s; *p != '\0'; ++p)
+    {
+        unsigned char c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        // Copy the unescaped run in one go, then the escape.
+        if (!json_put(w, run, (size_t)((const char *)p - run)))
+        {
+            return false;
+        }
+        char esc[7];
+        size_t n = 2;
+        esc[0] = '\\';
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            esc[1] = (char)c;
+            break;
+        case '\n':
+            esc[1] = 'n';
+            break;
+        case '\r':
+            esc[1] = 'r';
+            break;
+        case '\t':
+            esc[1] = 't';
+            break;
+        default:
+        {
+            static const char hex[] = "0123456789ABCDEF";
+            memcpy(&esc[1], "u00", 3);
+            esc[4] = hex[(c >> 4) & 0x0F];
+            esc[5] = hex[c & 0x0F];
+            n = 6;
+            break;
+        }
+        }
+        if (!json_put(w, esc, n))
+        {
+            return false;
+        }
+        run = (const char *)p + 1;
+    }
+    return json_put(w, run, strlen(run)) && json_put(w, "\"", 1);
+}
+
+bool json_write_key(json_writer_t *w, const char *key)
+{
+    if (key == NULL || !json_sep(w))
+    {
+        return false;
+    }
+    // Keys are nearly always plain literals: copy them in one go.
+    size_t n = 0;
+    while ((unsigned char)key[n] >= 0x20 && key[n] != '"' && key[n] != '\\')
+    {
+        n++;
+    }
+    if (key[n] == '\0')
+    {
+        return json_put(w, "\"", 1) && json_put(w, key, n) && json_put(w, "\":", 2);
+    }
+    return json_put_escaped(w, key) && json_put(w, ":", 1);
+}
+
+bool json_write_key_raw(json_writer_t *w, const char *encoded, size_t len)
+{
+    if (encoded == NULL || !json_sep(w))
+    {
+        return false;
+    }
+    return json_put(w, encoded, len);
+}
+
+bool json_write_null(json_writer_t *w)
+{
+    return json_sep(w) && json_value_done(w, json_put(w, "null", 4));
+}
+
+bool json_write_bool(json_writer_t *w, bool value)
+{
+    return json_sep(w) && json_value_done(w, value ? json_put(w, "true", 4) : json_put(w, "false", 5));
+}
+
+bool json_write_fmt(json_writer_t *w, const char *fmt, ...)
+{
+    if (fmt == NULL || !json_sep(w))
+    {
+        return false;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    bool ok = json_vput(w, fmt, ap);
+    va_end(ap);
+    return json_value_done(w, ok);
+}
+
+// Integers are formatted by hand: the printf family costs several times the digits it
+// writes. 32-bit values stay on 32-bit division, which is cheap on the Xtensa core.
+static bool json_put_u32(json_writer_t *w, uint32_t value, bool negative)
+{
+    char digits[11];
+    size_t pos = sizeof(digits);
+    do
+    {
+        digits[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative)
+    {
+        digits[--pos] = '-';
+    }
+    return json_put(w, &digits[pos], sizeof(digits) - pos);
+}
+
+static bool json_put_u64(json_writer_t *w, uint64_t value, bool negative)
+{
+    if (value <= UINT32_MAX)
+    {
+        return json_put_u32(w, (uint32_t)value, negative);
+    }
+    char digits[21];
+    size_t pos = sizeof(digits);
+    do
+    {
+        digits[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative)
+    {
+        digits[--pos] = '-';
+    }
+    return json_put(w, &digits[pos], sizeof(digits) - pos);
+}
+
+bool json_write_u32(json_writer_t *w, uint32_t value)
+{
+    return json_sep(w) && json_value_done(w, json_put_u32(w, value, false));
+}
+
+bool json_write_i32(json_writer_t *w, int32_t value)
+{
+    uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    return json_sep(w) && json_value_done(w, json_put_u32(w, magnitude, value < 0));
+}
+
+bool json_write_i64(json_writer_t *w, int64_t value)
+{
+    uint64_t magnitude = (value < 0) ? 0u - (uint64_t)value : (uint64_t)value;
+    return json_sep(w) && json_value_done(w, json_put_u64(w, magnitude, value < 0));
+}
+
+bool json_write_float(json_writer_t *w, float value, int decimals)
+{
+    return json_write_fmt(w, "%.*f", decimals, (double)value);
+}
+
+bool json_write_str(json_writer_t *w, const char *s)
+{
+    if (s == NULL)
+    {
+        return json_write_null(w);
+    }
+    return json_sep(w) && json_value_done(w, json_put_escaped(w, s));
+}
+
+bool json_write_raw(json_writer_t *w, const char *json)
+{
+    if (json == NULL || !json_sep(w))
+    {
+        return false;
+    }
+    return json_value_done(w, json_put(w, json, strlen(json)));
+}
+
+bool json_kv_null(json_writer_t *w, const char *key)
+{
+    return json_write_key(w, key) && json_write_null(w);
+}
+
+bool json_kv_bool(json_writer_t *w, const char *key, bool value)
+{
+    return json_write_key(w, key) && json_write_bool(w, value);
+}
+
+bool json_kv_u32(json_writer_t *w, const char *key, uint32_t value)
+{
+    return json_write_key(w, key) && json_write_u32(w, value);
+}
+
+bool json_kv_i32(json_writer_t *w, const char *key, int32_t value)
+{
+    return json_write_key(w, key) && json_write_i32(w, value);
+}
+
+bool json_kv_i64(json_writer_t *w, const char *key, int64_t value)
+{
+    return json_write_key(w, key) && json_write_i64(w, value);
+}
+
+bool json_kv_float(json_writer_t *w, const char *key, float value, int decimals)
+{
+    return json_write_key(w, key) && json_write_float(w, value, decimals);
+}
+
+bool json_kv_str(json_writer_t *w, const char *key, const char *s)
+{
+    return json_write_key(w, key) && json_write_str(w, s);
+}
+
+bool json_kv_raw(json_writer_t *w, const char *key, const char *json)
+{
+    return json_write_key(w, key) && json_write_raw(w, json);
+}
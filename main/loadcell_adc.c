@@ -2,19 +2,94 @@
 
 #include "board.h"
 #include "driver/gpio.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
 #include "esp_rom_sys.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
 
-#define LOADCELL_ADC_GAIN_PULSES 1
-#define LOADCELL_ADC_READY_TIMEOUT_US 100000
-#define LOADCELL_ADC_SCK_HIGH_US 1
-#define LOADCELL_ADC_SCK_LOW_US 1
+#include <stdio.h>
+#include <string.h>
+
+// RATE is strapped on the board, not driven by firmware; this is the assumed rate at boot.
+#ifndef LOADCELL_ADC_DEFAULT_SPS
+#define LOADCELL_ADC_DEFAULT_SPS 10
+#endif
+// Conversions discarded after a channel/gain switch: the one clocked out with the switching
+// pulses (still at the old setting) and the first one at the new setting.
+#define LOADCELL_ADC_SETTLE_DISCARD 2
+// HX711 needs >= 200 ns per SCK phase and powers down if SCK stays high for 60 us.
+#define LOADCELL_ADC_SCK_HALF_NS 250
+// 25 pulses at 2 x 250 ns plus register access is ~15 us; anything past this was stretched.
+#define LOADCELL_ADC_READOUT_LIMIT_NS 50000
+#define LOADCELL_ADC_TASK_STACK 2560
+#define LOADCELL_ADC_TASK_PRIO 6
+// Timeouts scale with the configured rate: a ready wait of two conversion periods means DOUT
+// never fell, and a sample older than five periods is stale.
+#define LOADCELL_ADC_WAIT_PERIODS 2
+#define LOADCELL_ADC_STALE_PERIODS 5
+
+static const char *TAG = "loadcell_adc";
+
+// Written only by the sampling task.
+static loadcell_ring_t s_ring;
+static TaskHandle_t s_task = NULL;
+static loadcell_adc_sample_cb_t s_sample_cb = NULL;
+static volatile uint32_t s_ready_timeouts = 0;
+// DOUT falling-edge time, written by the ISR before it notifies the task. The ISR masks its
+// own interrupt, so the task reads it without racing the next write.
+static volatile int64_t s_edge_us = 0;
+static volatile uint32_t s_settle_discards = 0;
+static volatile loadcell_adc_gain_t s_gain_req = LOADCELL_ADC_GAIN_A128;
+static loadcell_adc_gain_t s_gain_cur = LOADCELL_ADC_GAIN_A128;
+static uint8_t s_discard = 0;
+static volatile uint16_t s_rate_sps = LOADCELL_ADC_DEFAULT_SPS;
+
+// Pulses after the 24 data bits select channel and gain for the next conversion.
+static const uint8_t k_gain_pulses[LOADCELL_ADC_GAIN_COUNT] = {
+    [LOADCELL_ADC_GAIN_A128] = 1,
+    [LOADCELL_ADC_GAIN_B32] = 2,
+    [LOADCELL_ADC_GAIN_A64] = 3,
+};
+static const char *const k_gain_names[LOADCELL_ADC_GAIN_COUNT] = {
+    [LOADCELL_ADC_GAIN_A128] = "a128",
+    [LOADCELL_ADC_GAIN_B32] = "b32",
+    [LOADCELL_ADC_GAIN_A64] = "a64",
+};
+static portMUX_TYPE s_clock_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_half_cycles = 0;
+static uint32_t s_cpu_mhz = 0;
+
+static volatile uint32_t s_samples = 0;
+static volatile uint32_t s_corrupt = 0;
+static volatile uint32_t s_out_of_range = 0;
+static volatile uint32_t s_overlong = 0;
+static volatile uint32_t s_readout_last_ns = 0;
+static volatile uint32_t s_readout_max_ns = 0;
+
+// The readout writes the W1TS/W1TC and IN registers of the low GPIO bank directly.
+_Static_assert(PIN_LOADCELL_ADC_SCK < 32 && PIN_LOADCELL_ADC_DOUT < 32, "HX711 pins must be GPIO0-31");
+#define LOADCELL_ADC_SCK_MASK (1UL << PIN_LOADCELL_ADC_SCK)
+#define LOADCELL_ADC_DOUT_MASK (1UL << PIN_LOADCELL_ADC_DOUT)
 
 static inline void loadcell_adc_delay_us(uint32_t us)
 {
     esp_rom_delay_us(us);
 }
 
+static inline int64_t loadcell_adc_period_us(void)
+{
+    return 1000000LL / s_rate_sps;
+}
+
+int64_t loadcell_adc_get_stale_us(void)
+{
+    return loadcell_adc_period_us() * LOADCELL_ADC_STALE_PERIODS;
+}
+
 esp_err_t loadcell_adc_init(void)
 {
     gpio_config_t sck_cfg = {
@@ -42,6 +117,8 @@ esp_err_t loadcell_adc_init(void)
         return err;
     }
     gpio_set_level(PIN_LOADCELL_ADC_SCK, 0);
+    s_cpu_mhz = esp_rom_get_cpu_ticks_per_us();
+    s_half_cycles = (s_cpu_mhz * LOADCELL_ADC_SCK_HALF_NS + 999) / 1000;
     return ESP_OK;
 }
 
@@ -55,7 +132,7 @@ static esp_err_t loadcell_adc_wait_ready(void)
     int64_t start_us = esp_timer_get_time();
     while (!loadcell_adc_is_ready())
     {
-        if ((esp_timer_get_time() - start_us) > LOADCELL_ADC_READY_TIMEOUT_US)
+        if ((esp_timer_get_time() - start_us) > loadcell_adc_period_us() * LOADCELL_ADC_WAIT_PERIODS)
         {
             return ESP_ERR_TIMEOUT;
         }
@@ -64,25 +141,111 @@ static esp_err_t loadcell_adc_wait_ready(void)
     return ESP_OK;
 }
 
-static uint32_t loadcell_adc_shift_read(void)
+static inline void loadcell_adc_spin(uint32_t from, uint32_t cycles)
+{
+    while ((uint32_t)(esp_cpu_get_cycle_count() - from) < cycles)
+    {
+    }
+}
+
+static inline void loadcell_adc_pulse(void)
+{
+    uint32_t t = esp_cpu_get_cycle_count();
+    REG_WRITE(GPIO_OUT_W1TS_REG, LOADCELL_ADC_SCK_MASK);
+    loadcell_adc_spin(t, s_half_cycles);
+    t = esp_cpu_get_cycle_count();
+    REG_WRITE(GPIO_OUT_W1TC_REG, LOADCELL_ADC_SCK_MASK);
+    loadcell_adc_spin(t, s_half_cycles);
+}
+
+// Clocks out one conversion plus the gain-select pulses. Runs in a critical section so an
+// interrupt or task switch cannot hold SCK high long enough to power the HX711 down, and
+// drives the pins through the GPIO set/clear registers instead of gpio_set_level().
+static esp_err_t loadcell_adc_shift_read(uint8_t gain_pulses, int32_t *out)
 {
     uint32_t value = 0;
+    portENTER_CRITICAL(&s_clock_mux);
+    uint32_t start = esp_cpu_get_cycle_count();
     for (int i = 0; i < 24; ++i)
     {
-        gpio_set_level(PIN_LOADCELL_ADC_SCK, 1);
-        loadcell_adc_delay_us(LOADCELL_ADC_SCK_HIGH_US);
-        value = (value << 1) | (uint32_t)gpio_get_level(PIN_LOADCELL_ADC_DOUT);
-        gpio_set_level(PIN_LOADCELL_ADC_SCK, 0);
-        loadcell_adc_delay_us(LOADCELL_ADC_SCK_LOW_US);
+        uint32_t t = esp_cpu_get_cycle_count();
+        REG_WRITE(GPIO_OUT_W1TS_REG, LOADCELL_ADC_SCK_MASK);
+        loadcell_adc_spin(t, s_half_cycles);
+        value = (value << 1) | ((REG_READ(GPIO_IN_REG) & LOADCELL_ADC_DOUT_MASK) ? 1U : 0U);
+        t = esp_cpu_get_cycle_count();
+        REG_WRITE(GPIO_OUT_W1TC_REG, LOADCELL_ADC_SCK_MASK);
+        loadcell_adc_spin(t, s_half_cycles);
+    }
+    for (uint8_t i = 0; i < gain_pulses; ++i)
+    {
+        loadcell_adc_pulse();
+    }
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    // After the 25th pulse DOUT is driven high until the next conversion completes.
+    bool dout_high = (REG_READ(GPIO_IN_REG) & LOADCELL_ADC_DOUT_MASK) != 0;
+    portEXIT_CRITICAL(&s_clock_mux);
+
+    uint32_t ns = (s_cpu_mhz > 0) ? (uint32_t)(((uint64_t)cycles * 1000U) / s_cpu_mhz) : 0;
+    s_readout_last_ns = ns;
+    if (ns > s_readout_max_ns)
+    {
+        s_readout_max_ns = ns;
+    }
+    if (ns > LOADCELL_ADC_READOUT_LIMIT_NS)
+    {
+        s_overlong++;
     }
-    for (int i = 0; i < LOADCELL_ADC_GAIN_PULSES; ++i)
+    if (!dout_high)
     {
-        gpio_set_level(PIN_LOADCELL_ADC_SCK, 1);
-        loadcell_adc_delay_us(LOADCELL_ADC_SCK_HIGH_US);
-        gpio_set_level(PIN_LOADCELL_ADC_SCK, 0);
-        loadcell_adc_delay_us(LOADCELL_ADC_SCK_LOW_US);
+        s_corrupt++;
+        return ESP_ERR_INVALID_RESPONSE;
     }
-    return value;
+    // The HX711 clamps to these codes when the input is outside its differential range.
+    if (value == 0x7FFFFF || value == 0x800000)
+    {
+        s_out_of_range++;
+    }
+    s_samples++;
+    if (value & 0x800000)
+    {
+        value |= 0xFF000000;
+    }
+    *out = (int32_t)value;
+    return ESP_OK;
+}
+
+// Reads one conversion, applying a pending channel/gain switch. Returns ESP_ERR_NOT_FINISHED
+// for conversions discarded while the new setting settles.
+static esp_err_t loadcell_adc_read_one(int32_t *out)
+{
+    loadcell_adc_gain_t gain = s_gain_req;
+    if (gain != s_gain_cur)
+    {
+        s_gain_cur = gain;
+        s_discard = LOADCELL_ADC_SETTLE_DISCARD;
+        // Buffered samples are in the old channel's counts; averages and cached reads must
+        // not mix them with the new ones.
+        loadcell_ring_invalidate(&s_ring);
+    }
+    esp_err_t err = loadcell_adc_shift_read(k_gain_pulses[gain], out);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (s_discard > 0)
+    {
+        s_discard--;
+        s_settle_discards++;
+        return ESP_ERR_NOT_FINISHED;
+    }
+    // A switch requested during this readout: the data is still at the old setting, so it is
+    // dropped rather than buffered after the caller asked for the new one.
+    if (s_gain_req != gain)
+    {
+        s_settle_discards++;
+        return ESP_ERR_NOT_FINISHED;
+    }
+    return ESP_OK;
 }
 
 esp_err_t loadcell_adc_read_raw(int32_t *out)
@@ -91,17 +254,337 @@ esp_err_t loadcell_adc_read_raw(int32_t *out)
     {
         return ESP_ERR_INVALID_ARG;
     }
-    esp_err_t err = loadcell_adc_wait_ready();
+    if (s_task != NULL)
+    {
+        // The sampling task owns SCK; hand back its newest sample instead of clocking here.
+        loadcell_sample_t sample;
+        if (!loadcell_adc_get_latest(&sample) || (esp_timer_get_time() - sample.ts_us) > loadcell_adc_get_stale_us())
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+        *out = sample.raw;
+        return ESP_OK;
+    }
+    esp_err_t err = ESP_ERR_NOT_FINISHED;
+    for (int i = 0; i <= LOADCELL_ADC_SETTLE_DISCARD && err == ESP_ERR_NOT_FINISHED; ++i)
+    {
+        err = loadcell_adc_wait_ready();
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        err = loadcell_adc_read_one(out);
+    }
+    return err;
+}
+
+static void loadcell_adc_dout_isr(void *arg)
+{
+    (void)arg;
+    s_edge_us = esp_timer_get_time();
+    // DOUT also toggles while data bits are shifted out; mask the edge until readout is done.
+    gpio_intr_disable(PIN_LOADCELL_ADC_DOUT);
+    if (s_task == NULL)
+    {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void loadcell_adc_task(void *arg)
+{
+    (void)arg;
+    while (true)
+    {
+        // A conversion that finished while the edge was masked has no edge time; it is
+        // stamped at readout instead.
+        int64_t ts_us = -1;
+        if (loadcell_adc_is_ready())
+        {
+            // Already done: if its edge was caught, the notification is still pending.
+            if (ulTaskNotifyTake(pdTRUE, 0) > 0)
+            {
+                ts_us = s_edge_us;
+            }
+        }
+        else
+        {
+            TickType_t wait = pdMS_TO_TICKS((loadcell_adc_period_us() * LOADCELL_ADC_WAIT_PERIODS) / 1000);
+            if (ulTaskNotifyTake(pdTRUE, (wait > 0) ? wait : 1) == 0)
+            {
+                s_ready_timeouts++;
+                gpio_intr_enable(PIN_LOADCELL_ADC_DOUT);
+                continue;
+            }
+            if (!loadcell_adc_is_ready())
+            {
+                gpio_intr_enable(PIN_LOADCELL_ADC_DOUT);
+                continue;
+            }
+            ts_us = s_edge_us;
+        }
+        if (ts_us < 0)
+        {
+            ts_us = esp_timer_get_time();
+        }
+        gpio_intr_disable(PIN_LOADCELL_ADC_DOUT);
+        int32_t raw = 0;
+        esp_err_t read_err = loadcell_adc_read_one(&raw);
+        // Drop anything the data bits triggered, so a pending notification always means a
+        // ready edge seen after the interrupt is re-enabled below.
+        (void)ulTaskNotifyTake(pdTRUE, 0);
+        if (read_err == ESP_OK)
+        {
+            loadcell_sample_t sample = {.raw = raw, .ts_us = ts_us};
+            sample.seq = loadcell_ring_push(&s_ring, raw, ts_us);
+            loadcell_adc_sample_cb_t cb = s_sample_cb;
+            if (cb != NULL)
+            {
+                cb(&sample);
+            }
+        }
+        // If the next conversion already finished, the loop reads it without waiting for an edge.
+        gpio_intr_enable(PIN_LOADCELL_ADC_DOUT);
+    }
+}
+
+esp_err_t loadcell_adc_start(void)
+{
+    if (s_task != NULL)
+    {
+        return ESP_OK;
+    }
+    esp_err_t err = gpio_set_intr_type(PIN_LOADCELL_ADC_DOUT, GPIO_INTR_NEGEDGE);
     if (err != ESP_OK)
     {
         return err;
     }
-    uint32_t raw = loadcell_adc_shift_read();
-    if (raw & 0x800000)
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        return err;
+    }
+    // Handler first, task second: a failure at either step leaves nothing half-started, and
+    // the edge stays masked until both exist.
+    gpio_intr_disable(PIN_LOADCELL_ADC_DOUT);
+    err = gpio_isr_handler_add(PIN_LOADCELL_ADC_DOUT, loadcell_adc_dout_isr, NULL);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "isr add failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (xTaskCreate(loadcell_adc_task, "hx711", LOADCELL_ADC_TASK_STACK, NULL, LOADCELL_ADC_TASK_PRIO,
+                    &s_task) != pdPASS)
+    {
+        s_task = NULL;
+        gpio_isr_handler_remove(PIN_LOADCELL_ADC_DOUT);
+        return ESP_ERR_NO_MEM;
+    }
+    return gpio_intr_enable(PIN_LOADCELL_ADC_DOUT);
+}
+
+esp_err_t loadcell_adc_set_gain(loadcell_adc_gain_t gain)
+{
+    if ((unsigned)gain >= LOADCELL_ADC_GAIN_COUNT)
     {
-        raw |= 0xFF000000;
+        return ESP_ERR_INVALID_ARG;
     }
-    *out = (int32_t)raw;
+    // Applied by the next readout, which owns SCK.
+    s_gain_req = gain;
+    return ESP_OK;
+}
+
+loadcell_adc_gain_t loadcell_adc_get_gain(void)
+{
+    return s_gain_req;
+}
+
+const char *loadcell_adc_gain_name(loadcell_adc_gain_t gain)
+{
+    if ((unsigned)gain >= LOADCELL_ADC_GAIN_COUNT)
+    {
+        return "unknown";
+    }
+    return k_gain_names[gain];
+}
+
+bool loadcell_adc_gain_from_name(const char *name, loadcell_adc_gain_t *out)
+{
+    if (name == NULL || out == NULL)
+    {
+        return false;
+    }
+    for (int i = 0; i < LOADCELL_ADC_GAIN_COUNT; ++i)
+    {
+        if (strcmp(name, k_gain_names[i]) == 0)
+        {
+            *out = (loadcell_adc_gain_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t loadcell_adc_set_rate_sps(uint16_t sps)
+{
+    if (sps != 10 && sps != 80)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_rate_sps = sps;
+    return ESP_OK;
+}
+
+uint16_t loadcell_adc_get_rate_sps(void)
+{
+    return s_rate_sps;
+}
+
+// Average spacing of the newest buffered samples; 0 when there are too few to tell.
+uint32_t loadcell_adc_get_measured_rate_milli(void)
+{
+    uint32_t head = loadcell_ring_head(&s_ring);
+    uint32_t avail = head - loadcell_ring_valid_from(&s_ring);
+    uint32_t span = (avail > 16) ? 16 : avail;
+    loadcell_sample_t newest;
+    loadcell_sample_t oldest;
+    if (span < 2 || !loadcell_ring_get(&s_ring, head - 1, &newest) ||
+        !loadcell_ring_get(&s_ring, head - span, &oldest) || newest.ts_us <= oldest.ts_us)
+    {
+        return 0;
+    }
+    return (uint32_t)(((int64_t)(span - 1) * 1000000000LL) / (newest.ts_us - oldest.ts_us));
+}
+
+void loadcell_adc_set_sample_cb(loadcell_adc_sample_cb_t cb)
+{
+    s_sample_cb = cb;
+}
+
+bool loadcell_adc_is_running(void)
+{
+    return (s_task != NULL);
+}
+
+bool loadcell_adc_get_latest(loadcell_sample_t *out)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+    uint32_t head = loadcell_ring_head(&s_ring);
+    return (head != loadcell_ring_valid_from(&s_ring)) && loadcell_ring_get(&s_ring, head - 1, out);
+}
+
+size_t loadcell_adc_read_since(uint32_t *cursor, loadcell_sample_t *out, size_t max, uint32_t *dropped)
+{
+    if (cursor == NULL || out == NULL)
+    {
+        return 0;
+    }
+    uint32_t head = loadcell_ring_head(&s_ring);
+    uint32_t next = *cursor;
+    uint32_t lost = 0;
+    // Samples hidden by a gain switch are skipped, not reported as dropped.
+    uint32_t valid_from = loadcell_ring_valid_from(&s_ring);
+    if ((int32_t)(next - valid_from) < 0)
+    {
+        next = valid_from;
+    }
+    if (head - next > LOADCELL_ADC_RING_LEN)
+    {
+        lost = head - next - LOADCELL_ADC_RING_LEN;
+        next = head - LOADCELL_ADC_RING_LEN;
+    }
+    size_t count = 0;
+    while (next != head && count < max)
+    {
+        if (loadcell_ring_get(&s_ring, next, &out[count]))
+        {
+            count++;
+        }
+        else
+        {
+            lost++;
+        }
+        next++;
+    }
+    *cursor = next;
+    if (dropped != NULL)
+    {
+        *dropped = lost;
+    }
+    return count;
+}
+
+uint32_t loadcell_adc_cursor_now(void)
+{
+    return loadcell_ring_head(&s_ring);
+}
+
+esp_err_t loadcell_adc_peek_average(int samples, int32_t *avg_out, int64_t *newest_us_out)
+{
+    if (samples <= 0 || avg_out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t head = loadcell_ring_head(&s_ring);
+    uint32_t avail = head - loadcell_ring_valid_from(&s_ring);
+    if (avail == 0)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    uint32_t want = (samples > LOADCELL_ADC_RING_LEN) ? LOADCELL_ADC_RING_LEN : (uint32_t)samples;
+    if (want > avail)
+    {
+        want = avail;
+    }
+    int64_t sum = 0;
+    uint32_t used = 0;
+    int64_t newest_us = 0;
+    for (uint32_t i = 0; i < want; ++i)
+    {
+        loadcell_sample_t sample;
+        if (!loadcell_ring_get(&s_ring, head - 1 - i, &sample))
+        {
+            continue;
+        }
+        if (used == 0)
+        {
+            newest_us = sample.ts_us;
+        }
+        sum += sample.raw;
+        used++;
+    }
+    if (used == 0)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    *avg_out = (int32_t)(sum / (int64_t)used);
+    if (newest_us_out != NULL)
+    {
+        *newest_us_out = newest_us;
+    }
+    return ESP_OK;
+}
+
+// Averages the newest buffered samples; never waits for a conversion.
+static esp_err_t loadcell_adc_average_recent(int samples, int32_t *avg_out)
+{
+    int32_t avg = 0;
+    int64_t newest_us = 0;
+    esp_err_t err = loadcell_adc_peek_average(samples, &avg, &newest_us);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if ((esp_timer_get_time() - newest_us) > loadcell_adc_get_stale_us())
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    *avg_out = avg;
     return ESP_OK;
 }
 
@@ -111,6 +594,10 @@ esp_err_t loadcell_adc_read_average(int samples, int32_t *avg_out)
     {
         return ESP_ERR_INVALID_ARG;
     }
+    if (s_task != NULL)
+    {
+        return loadcell_adc_average_recent(samples, avg_out);
+    }
     int64_t sum = 0;
     for (int i = 0; i < samples; ++i)
     {
@@ -126,3 +613,65 @@ esp_err_t loadcell_adc_read_average(int samples, int32_t *avg_out)
     return ESP_OK;
 }
 
+
+void loadcell_adc_get_stats(loadcell_adc_stats_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    out->samples = s_samples;
+    out->corrupt = s_corrupt;
+    out->out_of_range = s_out_of_range;
+    out->overlong = s_overlong;
+    out->ready_timeouts = s_ready_timeouts;
+    out->settle_discards = s_settle_discards;
+    out->readout_last_ns = s_readout_last_ns;
+    out->readout_max_ns = s_readout_max_ns;
+}
+
+void loadcell_adc_reset_stats(void)
+{
+    s_samples = 0;
+    s_corrupt = 0;
+    s_out_of_range = 0;
+    s_overlong = 0;
+    s_ready_timeouts = 0;
+    s_settle_discards = 0;
+    s_readout_last_ns = 0;
+    s_readout_max_ns = 0;
+}
+
+bool loadcell_adc_write_stats_json(json_writer_t *w)
+{
+    loadcell_adc_stats_t stats;
+    loadcell_adc_get_stats(&stats);
+    uint32_t measured_milli = loadcell_adc_get_measured_rate_milli();
+    return json_obj_begin(w) &&
+           json_kv_u32(w, "samples", stats.samples) &&
+           json_kv_u32(w, "corrupt", stats.corrupt) &&
+           json_kv_u32(w, "out_of_range", stats.out_of_range) &&
+           json_kv_u32(w, "overlong", stats.overlong) &&
+           json_kv_u32(w, "ready_timeouts", stats.ready_timeouts) &&
+           json_kv_u32(w, "readout_last_ns", stats.readout_last_ns) &&
+           json_kv_u32(w, "readout_max_ns", stats.readout_max_ns) &&
+           json_kv_u32(w, "settle_discards", stats.settle_discards) &&
+           json_kv_i32(w, "sck_half_ns", LOADCELL_ADC_SCK_HALF_NS) &&
+           json_kv_str(w, "gain", loadcell_adc_gain_name(s_gain_req)) &&
+           json_kv_u32(w, "rate_sps", s_rate_sps) &&
+           json_write_key(w, "measured_sps") &&
+           json_write_fmt(w, "%lu.%03lu", (unsigned long)(measured_milli / 1000),
+                          (unsigned long)(measured_milli % 1000)) &&
+           json_obj_end(w);
+}
+
+bool loadcell_adc_get_stats_json(char *buf, size_t len)
+{
+    if (buf == NULL || len == 0)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return loadcell_adc_write_stats_json(&w);
+}
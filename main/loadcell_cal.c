@@ -0,0 +1,310 @@
+#include "loadcell_cal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include "nvs_storage.h"
+
+#define LOADCELL_CAL_NAMESPACE "scale_cal"
+#define LOADCELL_CAL_KEY "table"
+#define LOADCELL_CAL_BLOB_VERSION 1
+#define LOADCELL_CAL_SLOPE_Q 24
+// 16 g per count is far beyond any real cell; steeper slopes could overflow the Q24 product.
+#define LOADCELL_CAL_SLOPE_MAX_Q24 ((int64_t)16000 << LOADCELL_CAL_SLOPE_Q)
+
+// Stored layout; bump LOADCELL_CAL_BLOB_VERSION when it changes.
+typedef struct
+{
+    uint8_t version;
+    uint8_t count;
+    uint16_t reserved;
+    int32_t tare_offset_raw;
+    loadcell_cal_point_t points[LOADCELL_CAL_MAX_POINTS];
+    uint32_t crc;
+} loadcell_cal_blob_t;
+
+static bool loadcell_cal_build(const loadcell_cal_point_t *points, uint8_t count, loadcell_cal_t *out)
+{
+    int32_t node_raw[LOADCELL_CAL_MAX_POINTS + 1];
+    int32_t node_mg[LOADCELL_CAL_MAX_POINTS + 1];
+    uint8_t nodes = 0;
+    bool anchored = false;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        if (!anchored && points[i].raw_delta > 0)
+        {
+            node_raw[nodes] = 0;
+            node_mg[nodes] = 0;
+            nodes++;
+            anchored = true;
+        }
+        node_raw[nodes] = points[i].raw_delta;
+        node_mg[nodes] = points[i].mg;
+        nodes++;
+    }
+    if (!anchored)
+    {
+        node_raw[nodes] = 0;
+        node_mg[nodes] = 0;
+        nodes++;
+    }
+    int64_t slopes[LOADCELL_CAL_MAX_POINTS];
+    for (uint8_t i = 0; i + 1 < nodes; ++i)
+    {
+        int64_t d_raw = (int64_t)node_raw[i + 1] - node_raw[i];
+        int64_t d_mg = (int64_t)node_mg[i + 1] - node_mg[i];
+        slopes[i] = (d_mg * ((int64_t)1 << LOADCELL_CAL_SLOPE_Q)) / d_raw;
+        if (slopes[i] > LOADCELL_CAL_SLOPE_MAX_Q24 || slopes[i] < -LOADCELL_CAL_SLOPE_MAX_Q24)
+        {
+            return false;
+        }
+    }
+    out->count = count;
+    memmove(out->points, points, count * sizeof(points[0]));
+    out->node_count = nodes;
+    memcpy(out->node_raw, node_raw, nodes * sizeof(node_raw[0]));
+    memcpy(out->node_mg, node_mg, nodes * sizeof(node_mg[0]));
+    memcpy(out->slope_q24, slopes, (nodes - 1) * sizeof(slopes[0]));
+    return true;
+}
+
+void loadcell_cal_clear(loadcell_cal_t *cal)
+{
+    if (cal != NULL)
+    {
+        memset(cal, 0, sizeof(*cal));
+    }
+}
+
+esp_err_t loadcell_cal_add_point(loadcell_cal_t *cal, int32_t raw_delta, int32_t mg)
+{
+    if (cal == NULL || raw_delta == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cal->count >= LOADCELL_CAL_MAX_POINTS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    loadcell_cal_point_t points[LOADCELL_CAL_MAX_POINTS];
+    uint8_t n = 0;
+    bool inserted = false;
+    for (uint8_t i = 0; i < cal->count; ++i)
+    {
+        if (cal->points[i].raw_delta == raw_delta)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (!inserted && raw_delta < cal->points[i].raw_delta)
+        {
+            points[n++] = (loadcell_cal_point_t){.raw_delta = raw_delta, .mg = mg};
+            inserted = true;
+        }
+        points[n++] = cal->points[i];
+    }
+    if (!inserted)
+    {
+        points[n++] = (loadcell_cal_point_t){.raw_delta = raw_delta, .mg = mg};
+    }
+    return loadcell_cal_build(points, n, cal) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+bool loadcell_cal_is_valid(const loadcell_cal_t *cal)
+{
+    return (cal != NULL && cal->count > 0 && cal->node_count >= 2);
+}
+
+esp_err_t loadcell_cal_to_mg(const loadcell_cal_t *cal, int32_t raw_delta, int32_t *mg)
+{
+    if (mg == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!loadcell_cal_is_valid(cal))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Segment i spans node i..i+1; the first and last segments also extrapolate.
+    uint8_t seg = 0;
+    while (seg + 2 < cal->node_count && raw_delta >= cal->node_raw[seg + 1])
+    {
+        seg++;
+    }
+    int64_t d = (int64_t)raw_delta - cal->node_raw[seg];
+    int64_t offset = (d * cal->slope_q24[seg] + ((int64_t)1 << (LOADCELL_CAL_SLOPE_Q - 1))) >> LOADCELL_CAL_SLOPE_Q;
+    int64_t result = (int64_t)cal->node_mg[seg] + offset;
+    if (result > INT32_MAX || result < INT32_MIN)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *mg = (int32_t)result;
+    return ESP_OK;
+}
+
+float loadcell_cal_counts_per_gram(const loadcell_cal_t *cal)
+{
+    if (!loadcell_cal_is_valid(cal))
+    {
+        return 0.0f;
+    }
+    // Pick the point closest to zero; it bounds the segment that covers small loads.
+    const loadcell_cal_point_t *best = &cal->points[0];
+    for (uint8_t i = 1; i < cal->count; ++i)
+    {
+        int32_t a = cal->points[i].raw_delta;
+        int32_t b = best->raw_delta;
+        if ((a < 0 ? -(int64_t)a : a) < (b < 0 ? -(int64_t)b : b))
+        {
+            best = &cal->points[i];
+        }
+    }
+    if (best->mg == 0)
+    {
+        return 0.0f;
+    }
+    return (float)best->raw_delta * 1000.0f / (float)best->mg;
+}
+
+static uint32_t loadcell_cal_blob_crc(const loadcell_cal_blob_t *blob)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)blob, offsetof(loadcell_cal_blob_t, crc));
+}
+
+esp_err_t loadcell_cal_save(const loadcell_cal_t *cal, int32_t tare_offset_raw)
+{
+    if (cal == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!nvs_storage_is_ready())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    loadcell_cal_blob_t blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = LOADCELL_CAL_BLOB_VERSION;
+    blob.count = cal->count;
+    blob.tare_offset_raw = tare_offset_raw;
+    memcpy(blob.points, cal->points, cal->count * sizeof(cal->points[0]));
+    blob.crc = loadcell_cal_blob_crc(&blob);
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(LOADCELL_CAL_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = nvs_set_blob(handle, LOADCELL_CAL_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+esp_err_t loadcell_cal_load(loadcell_cal_t *cal, int32_t *tare_offset_raw)
+{
+    if (cal == NULL || tare_offset_raw == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!nvs_storage_is_ready())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(LOADCELL_CAL_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    loadcell_cal_blob_t blob;
+    size_t size = sizeof(blob);
+    err = nvs_get_blob(handle, LOADCELL_CAL_KEY, &blob, &size);
+    nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (size != sizeof(blob) || blob.version != LOADCELL_CAL_BLOB_VERSION)
+    {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (blob.crc != loadcell_cal_blob_crc(&blob) || blob.count == 0 || blob.count > LOADCELL_CAL_MAX_POINTS)
+    {
+        return ESP_ERR_INVALID_CRC;
+    }
+    // Rebuild through add_point so a stored table gets the same checks as a new one.
+    loadcell_cal_t loaded;
+    loadcell_cal_clear(&loaded);
+    for (uint8_t i = 0; i < blob.count; ++i)
+    {
+        if (loadcell_cal_add_point(&loaded, blob.points[i].raw_delta, blob.points[i].mg) != ESP_OK)
+        {
+            return ESP_ERR_INVALID_CRC;
+        }
+    }
+    *cal = loaded;
+    *tare_offset_raw = blob.tare_offset_raw;
+    return ESP_OK;
+}
+
+esp_err_t loadcell_cal_erase(void)
+{
+    if (!nvs_storage_is_ready())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(LOADCELL_CAL_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = nvs_erase_key(handle, LOADCELL_CAL_KEY);
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+bool loadcell_cal_write_json(const loadcell_cal_t *cal, json_writer_t *w)
+{
+    if (cal == NULL)
+    {
+        return false;
+    }
+    bool ok = json_arr_begin(w);
+    for (uint8_t i = 0; ok && i < cal->count; ++i)
+    {
+        ok = json_obj_begin(w) &&
+             json_kv_i32(w, "raw_delta", cal->points[i].raw_delta) &&
+             json_kv_i32(w, "mg", cal->points[i].mg) &&
+             json_obj_end(w);
+    }
+    return ok && json_arr_end(w);
+}
+
+bool loadcell_cal_get_json(const loadcell_cal_t *cal, char *buf, size_t len)
+{
+    if (cal == NULL || buf == NULL || len == 0)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return loadcell_cal_write_json(cal, &w);
+}
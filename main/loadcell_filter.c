@@ -0,0 +1,294 @@
+#include "loadcell_filter.h"
+
+#include <math.h>
+#include <string.h>
+
+#define LOADCELL_FILTER_Q 14
+// Pole radius of the notch; -3 dB width is about (1 - r) * fs / pi (2.5 Hz at 80 SPS).
+#define LOADCELL_FILTER_NOTCH_R 0.9f
+
+static const char *const k_kind_names[LOADCELL_FILTER_KIND_COUNT] = {
+    [LOADCELL_FILTER_MEDIAN] = "median",
+    [LOADCELL_FILTER_MA] = "ma",
+    [LOADCELL_FILTER_IIR] = "iir",
+    [LOADCELL_FILTER_NOTCH] = "notch",
+};
+
+static bool filter_param_valid(loadcell_filter_kind_t kind, uint16_t param, uint16_t sample_hz)
+{
+    switch (kind)
+    {
+    case LOADCELL_FILTER_MEDIAN:
+        return param >= 3 && param <= LOADCELL_FILTER_MEDIAN_MAX && (param & 1U) != 0;
+    case LOADCELL_FILTER_MA:
+        return param >= 2 && param <= LOADCELL_FILTER_MA_MAX;
+    case LOADCELL_FILTER_IIR:
+        return param >= 1 && param <= LOADCELL_FILTER_IIR_SHIFT_MAX;
+    case LOADCELL_FILTER_NOTCH:
+        return param >= 1 && (uint32_t)param * 2U < sample_hz;
+    default:
+        return false;
+    }
+}
+
+static int32_t to_q14(float v)
+{
+    return (int32_t)lroundf(v * (float)(1 << LOADCELL_FILTER_Q));
+}
+
+// H(z) = g (1 - 2c z^-1 + z^-2) / (1 - 2rc z^-1 + r^2 z^-2), g chosen for unity gain at DC.
+// Rounding each coefficient on its own leaves the DC gain a few LSB off 1.0, which shows up as
+// a weight offset on every reading; b1 is instead solved from the rounded others so that
+// b0 + b1 + b2 == 1 + a1 + a2 exactly in Q14.
+static void notch_design(loadcell_filter_stage_t *st, uint16_t sample_hz)
+{
+    float w = 2.0f * (float)M_PI * (float)st->param / (float)sample_hz;
+    float c = cosf(w);
+    float r = LOADCELL_FILTER_NOTCH_R;
+    float g = (1.0f - 2.0f * r * c + r * r) / (2.0f - 2.0f * c);
+    st->b0 = to_q14(g);
+    st->b2 = st->b0;
+    st->a1 = to_q14(-2.0f * r * c);
+    st->a2 = to_q14(r * r);
+    st->b1 = (1 << LOADCELL_FILTER_Q) + st->a1 + st->a2 - st->b0 - st->b2;
+}
+
+static void stage_reset(loadcell_filter_stage_t *st)
+{
+    st->fill = 0;
+    st->pos = 0;
+    st->primed = false;
+    st->sum = 0;
+}
+
+void loadcell_filter_chain_init(loadcell_filter_chain_t *chain, uint16_t sample_hz)
+{
+    if (chain == NULL)
+    {
+        return;
+    }
+    memset(chain, 0, sizeof(*chain));
+    chain->sample_hz = sample_hz;
+}
+
+esp_err_t loadcell_filter_chain_add(loadcell_filter_chain_t *chain, loadcell_filter_kind_t kind, uint16_t param)
+{
+    if (chain == NULL || !filter_param_valid(kind, param, chain->sample_hz))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (chain->count >= LOADCELL_FILTER_MAX_STAGES)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    loadcell_filter_stage_t *st = &chain->stages[chain->count];
+    memset(st, 0, sizeof(*st));
+    st->kind = kind;
+    st->param = param;
+    if (kind == LOADCELL_FILTER_NOTCH)
+    {
+        notch_design(st, chain->sample_hz);
+    }
+    chain->count++;
+    return ESP_OK;
+}
+
+void loadcell_filter_chain_clear(loadcell_filter_chain_t *chain)
+{
+    if (chain != NULL)
+    {
+        chain->count = 0;
+    }
+}
+
+void loadcell_filter_chain_reset(loadcell_filter_chain_t *chain)
+{
+    if (chain == NULL)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < chain->count; ++i)
+    {
+        stage_reset(&chain->stages[i]);
+    }
+}
+
+void loadcell_filter_chain_set_sample_rate(loadcell_filter_chain_t *chain, uint16_t sample_hz)
+{
+    if (chain == NULL || sample_hz == 0)
+    {
+        return;
+    }
+    chain->sample_hz = sample_hz;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < chain->count; ++i)
+    {
+        loadcell_filter_stage_t st = chain->stages[i];
+        if (st.kind == LOADCELL_FILTER_NOTCH)
+        {
+            if (!filter_param_valid(st.kind, st.param, sample_hz))
+            {
+                continue;
+            }
+            notch_design(&st, sample_hz);
+        }
+        stage_reset(&st);
+        chain->stages[kept++] = st;
+    }
+    chain->count = kept;
+}
+
+static int32_t stage_median(loadcell_filter_stage_t *st, int32_t x)
+{
+    st->window[st->pos] = x;
+    st->pos = (uint8_t)((st->pos + 1U) % st->param);
+    if (st->fill < st->param)
+    {
+        st->fill++;
+    }
+    // Insertion sort of at most nine values is cheaper than maintaining a sorted window.
+    int32_t sorted[LOADCELL_FILTER_MEDIAN_MAX];
+    for (uint8_t i = 0; i < st->fill; ++i)
+    {
+        int32_t v = st->window[i];
+        int j = (int)i - 1;
+        while (j >= 0 && sorted[j] > v)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return sorted[st->fill / 2];
+}
+
+static int32_t stage_ma(loadcell_filter_stage_t *st, int32_t x)
+{
+    if (st->fill == st->param)
+    {
+        st->sum -= st->window[st->pos];
+    }
+    else
+    {
+        st->fill++;
+    }
+    st->window[st->pos] = x;
+    st->sum += x;
+    st->pos = (uint8_t)((st->pos + 1U) % st->param);
+    return (int32_t)(st->sum / st->fill);
+}
+
+static int32_t stage_iir(loadcell_filter_stage_t *st, int32_t x)
+{
+    int64_t x_q8 = (int64_t)x * 256;
+    if (!st->primed)
+    {
+        st->acc_q8 = x_q8;
+        st->primed = true;
+    }
+    st->acc_q8 += (x_q8 - st->acc_q8 + ((int64_t)1 << (st->param - 1))) >> st->param;
+    return (int32_t)((st->acc_q8 + 128) >> 8);
+}
+
+static int32_t stage_notch(loadcell_filter_stage_t *st, int32_t x)
+{
+    if (!st->primed)
+    {
+        // Start from DC steady state so the first output is not a step response.
+        st->x1 = x;
+        st->x2 = x;
+        st->y1_q8 = (int64_t)x * 256;
+        st->y2_q8 = st->y1_q8;
+        st->primed = true;
+    }
+    int64_t acc = ((int64_t)st->b0 * x + (int64_t)st->b1 * st->x1 + (int64_t)st->b2 * st->x2) * 256;
+    acc -= (int64_t)st->a1 * st->y1_q8 + (int64_t)st->a2 * st->y2_q8;
+    int64_t y_q8 = acc >> LOADCELL_FILTER_Q;
+    st->x2 = st->x1;
+    st->x1 = x;
+    st->y2_q8 = st->y1_q8;
+    st->y1_q8 = y_q8;
+    return (int32_t)((y_q8 + 128) >> 8);
+}
+
+int32_t loadcell_filter_chain_apply(loadcell_filter_chain_t *chain, int32_t x)
+{
+    if (chain == NULL)
+    {
+        return x;
+    }
+    for (uint8_t i = 0; i < chain->count; ++i)
+    {
+        loadcell_filter_stage_t *st = &chain->stages[i];
+        switch (st->kind)
+        {
+        case LOADCELL_FILTER_MEDIAN:
+            x = stage_median(st, x);
+            break;
+        case LOADCELL_FILTER_MA:
+            x = stage_ma(st, x);
+            break;
+        case LOADCELL_FILTER_IIR:
+            x = stage_iir(st, x);
+            break;
+        case LOADCELL_FILTER_NOTCH:
+            x = stage_notch(st, x);
+            break;
+        default:
+            break;
+        }
+    }
+    return x;
+}
+
+const char *loadcell_filter_kind_name(loadcell_filter_kind_t kind)
+{
+    if ((unsigned)kind >= LOADCELL_FILTER_KIND_COUNT)
+    {
+        return "unknown";
+    }
+    return k_kind_names[kind];
+}
+
+bool loadcell_filter_kind_from_name(const char *name, loadcell_filter_kind_t *out)
+{
+    if (name == NULL || out == NULL)
+    {
+        return false;
+    }
+    for (int i = 0; i < LOADCELL_FILTER_KIND_COUNT; ++i)
+    {
+        if (strcmp(name, k_kind_names[i]) == 0)
+        {
+            *out = (loadcell_filter_kind_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadcell_filter_chain_write_json(const loadcell_filter_chain_t *chain, json_writer_t *w)
+{
+    if (chain == NULL || !json_arr_begin(w))
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < chain->count; ++i)
+    {
+        if (!json_obj_begin(w) ||
+            !json_kv_str(w, "type", loadcell_filter_kind_name(chain->stages[i].kind)) ||
+            !json_kv_u32(w, "param", chain->stages[i].param) ||
+            !json_obj_end(w))
+        {
+            return false;
+        }
+    }
+    return json_arr_end(w);
+}
+
+bool loadcell_filter_chain_get_json(const loadcell_filter_chain_t *chain, char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return loadcell_filter_chain_write_json(chain, &w);
+}
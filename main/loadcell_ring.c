@@ -0,0 +1,63 @@
+#include "loadcell_ring.h"
+
+#define LOADCELL_RING_SEQ_BUSY UINT32_MAX
+
+_Static_assert((LOADCELL_RING_LEN & (LOADCELL_RING_LEN - 1)) == 0, "LOADCELL_RING_LEN must be a power of two");
+
+static inline loadcell_sample_t *loadcell_ring_slot(const loadcell_ring_t *ring, uint32_t seq)
+{
+    return (loadcell_sample_t *)&ring->slots[seq & (LOADCELL_RING_LEN - 1)];
+}
+
+uint32_t loadcell_ring_push(loadcell_ring_t *ring, int32_t raw, int64_t ts_us)
+{
+    uint32_t seq = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    loadcell_sample_t *slot = loadcell_ring_slot(ring, seq);
+    // Invalidate the slot first. The release store alone does not keep the data stores below
+    // from becoming visible ahead of it; the fence does.
+    __atomic_store_n(&slot->seq, LOADCELL_RING_SEQ_BUSY, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->raw = raw;
+    slot->ts_us = ts_us;
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, seq + 1, __ATOMIC_RELEASE);
+    return seq;
+}
+
+void loadcell_ring_invalidate(loadcell_ring_t *ring)
+{
+    __atomic_store_n(&ring->valid_from, __atomic_load_n(&ring->head, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+}
+
+uint32_t loadcell_ring_head(const loadcell_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+uint32_t loadcell_ring_valid_from(const loadcell_ring_t *ring)
+{
+    return __atomic_load_n(&ring->valid_from, __ATOMIC_ACQUIRE);
+}
+
+bool loadcell_ring_get(const loadcell_ring_t *ring, uint32_t seq, loadcell_sample_t *out)
+{
+    if ((int32_t)(seq - loadcell_ring_valid_from(ring)) < 0)
+    {
+        return false;
+    }
+    const loadcell_sample_t *slot = loadcell_ring_slot(ring, seq);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq)
+    {
+        return false;
+    }
+    loadcell_sample_t copy = *slot;
+    // Orders the data loads above before the re-check, which an acquire load cannot do.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)
+    {
+        return false;
+    }
+    copy.seq = seq;
+    *out = copy;
+    return true;
+}
@@ -1,22 +1,84 @@
 #include "loadcell_scale.h"
 
 #include <stdio.h>
+#include <string.h>
 
+#include <math.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
 #include "events.h"
+#include "freertos/FreeRTOS.h"
 #include "loadcell_adc.h"
+#include "loadcell_cal.h"
 
 #define SCALE_DEFAULT_SAMPLES 5
+#define SCALE_MAX_KNOWN_GRAMS 2000000.0f
+
+static const char *TAG = "loadcell_scale";
 
 static int32_t s_tare_offset_raw = 0;
 static float s_scale_factor_raw_per_gram = 0.0f;
 static bool s_calibrated = false;
+static loadcell_cal_t s_cal;
+static bool s_cal_saved = false;
+
+// Chain state is touched by the sampling task on every sample and by console config changes.
+static portMUX_TYPE s_filter_mux = portMUX_INITIALIZER_UNLOCKED;
+static loadcell_filter_chain_t s_filter;
+static bool s_filter_has_output = false;
+static int32_t s_filter_output = 0;
+static int64_t s_filter_output_us = 0;
+static uint32_t s_filter_samples = 0;
+static loadcell_scale_sample_listener_t s_listener = NULL;
+
+static void loadcell_scale_on_sample(const loadcell_sample_t *sample)
+{
+    portENTER_CRITICAL(&s_filter_mux);
+    if (s_filter.count > 0)
+    {
+        s_filter_output = loadcell_filter_chain_apply(&s_filter, sample->raw);
+        s_filter_output_us = sample->ts_us;
+        s_filter_has_output = true;
+        s_filter_samples++;
+    }
+    portEXIT_CRITICAL(&s_filter_mux);
+    loadcell_scale_sample_listener_t listener = s_listener;
+    if (listener != NULL)
+    {
+        listener(sample);
+    }
+}
 
 esp_err_t loadcell_scale_init(void)
 {
     s_tare_offset_raw = 0;
     s_scale_factor_raw_per_gram = 0.0f;
     s_calibrated = false;
-    return loadcell_adc_init();
+    loadcell_cal_clear(&s_cal);
+    int32_t tare = 0;
+    esp_err_t load_err = loadcell_cal_load(&s_cal, &tare);
+    if (load_err == ESP_OK)
+    {
+        // The stored tare is the empty-platform zero the points were measured against.
+        s_tare_offset_raw = tare;
+        s_scale_factor_raw_per_gram = loadcell_cal_counts_per_gram(&s_cal);
+        s_calibrated = true;
+        s_cal_saved = true;
+    }
+    else if (load_err != ESP_ERR_NOT_FOUND)
+    {
+        ESP_LOGW(TAG, "stored calibration ignored: %s", esp_err_to_name(load_err));
+        loadcell_cal_clear(&s_cal);
+    }
+    loadcell_filter_chain_init(&s_filter, loadcell_adc_get_rate_sps());
+    esp_err_t err = loadcell_adc_init();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    loadcell_adc_set_sample_cb(loadcell_scale_on_sample);
+    return loadcell_adc_start();
 }
 
 bool loadcell_scale_is_calibrated(void)
@@ -30,20 +92,144 @@ esp_err_t loadcell_scale_read_raw(int samples, int32_t *raw)
     {
         return ESP_ERR_INVALID_ARG;
     }
+    if (loadcell_scale_filter_active())
+    {
+        // The filter already integrates over its window; hand back its newest output.
+        int64_t stale_us = loadcell_adc_get_stale_us();
+        portENTER_CRITICAL(&s_filter_mux);
+        bool fresh = s_filter_has_output && (esp_timer_get_time() - s_filter_output_us) <= stale_us;
+        int32_t value = s_filter_output;
+        portEXIT_CRITICAL(&s_filter_mux);
+        if (!fresh)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+        *raw = value;
+        return ESP_OK;
+    }
     return loadcell_adc_read_average(samples, raw);
 }
 
+esp_err_t loadcell_scale_set_gain(loadcell_adc_gain_t gain)
+{
+    esp_err_t err = loadcell_adc_set_gain(gain);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    // Samples at the old gain must not leak into the filter history.
+    portENTER_CRITICAL(&s_filter_mux);
+    loadcell_filter_chain_reset(&s_filter);
+    s_filter_has_output = false;
+    portEXIT_CRITICAL(&s_filter_mux);
+    events_emit("scale_gain", "scale", 0, loadcell_adc_gain_name(gain));
+    return ESP_OK;
+}
+
+esp_err_t loadcell_scale_set_rate(uint16_t sps)
+{
+    esp_err_t err = loadcell_adc_set_rate_sps(sps);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    portENTER_CRITICAL(&s_filter_mux);
+    loadcell_filter_chain_set_sample_rate(&s_filter, sps);
+    s_filter_has_output = false;
+    portEXIT_CRITICAL(&s_filter_mux);
+    events_emit("scale_rate", "scale", 0, (sps == 80) ? "80sps" : "10sps");
+    return ESP_OK;
+}
+
+void loadcell_scale_set_sample_listener(loadcell_scale_sample_listener_t listener)
+{
+    s_listener = listener;
+}
+
+bool loadcell_scale_filter_active(void)
+{
+    return (__atomic_load_n(&s_filter.count, __ATOMIC_RELAXED) > 0);
+}
+
+esp_err_t loadcell_scale_filter_add(loadcell_filter_kind_t kind, uint16_t param)
+{
+    portENTER_CRITICAL(&s_filter_mux);
+    esp_err_t err = loadcell_filter_chain_add(&s_filter, kind, param);
+    if (err == ESP_OK)
+    {
+        // Restart every stage so the new chain never mixes old and new history.
+        loadcell_filter_chain_reset(&s_filter);
+        s_filter_has_output = false;
+    }
+    portEXIT_CRITICAL(&s_filter_mux);
+    if (err == ESP_OK)
+    {
+        events_emit("scale_filter", "scale", 0, loadcell_filter_kind_name(kind));
+    }
+    return err;
+}
+
+void loadcell_scale_filter_clear(void)
+{
+    portENTER_CRITICAL(&s_filter_mux);
+    loadcell_filter_chain_clear(&s_filter);
+    s_filter_has_output = false;
+    s_filter_samples = 0;
+    portEXIT_CRITICAL(&s_filter_mux);
+    events_emit("scale_filter", "scale", 0, "clear");
+}
+
+bool loadcell_scale_filter_write_json(json_writer_t *w)
+{
+    loadcell_filter_chain_t chain;
+    portENTER_CRITICAL(&s_filter_mux);
+    chain = s_filter;
+    bool has_output = s_filter_has_output;
+    int32_t output = s_filter_output;
+    uint32_t samples = s_filter_samples;
+    portEXIT_CRITICAL(&s_filter_mux);
+
+    return json_obj_begin(w) &&
+           json_write_key(w, "stages") && loadcell_filter_chain_write_json(&chain, w) &&
+           json_kv_u32(w, "sample_hz", chain.sample_hz) &&
+           (has_output ? json_kv_i32(w, "output", output) : json_kv_null(w, "output")) &&
+           json_kv_u32(w, "samples", samples) &&
+           json_obj_end(w);
+}
+
+bool loadcell_scale_filter_get_json(char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return loadcell_scale_filter_write_json(&w);
+}
+
+esp_err_t loadcell_scale_raw_to_mg(int32_t raw, int32_t *mg)
+{
+    if (mg == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_calibrated)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return loadcell_cal_to_mg(&s_cal, raw - s_tare_offset_raw, mg);
+}
+
 esp_err_t loadcell_scale_raw_to_grams(int32_t raw, float *grams)
 {
     if (grams == NULL)
     {
         return ESP_ERR_INVALID_ARG;
     }
-    if (!s_calibrated || s_scale_factor_raw_per_gram == 0.0f)
+    int32_t mg = 0;
+    esp_err_t err = loadcell_scale_raw_to_mg(raw, &mg);
+    if (err != ESP_OK)
     {
-        return ESP_ERR_INVALID_STATE;
+        return err;
     }
-    *grams = (raw - s_tare_offset_raw) / s_scale_factor_raw_per_gram;
+    *grams = (float)mg * 0.001f;
     return ESP_OK;
 }
 
@@ -75,9 +261,29 @@ esp_err_t loadcell_scale_tare(int samples)
     return ESP_OK;
 }
 
-esp_err_t loadcell_scale_calibrate(int samples, float known_grams)
+static void loadcell_scale_cal_apply(const char *what, float known_grams)
 {
-    if (!(known_grams > 0.0f))
+    s_calibrated = loadcell_cal_is_valid(&s_cal);
+    s_scale_factor_raw_per_gram = loadcell_cal_counts_per_gram(&s_cal);
+    esp_err_t err = s_calibrated ? loadcell_cal_save(&s_cal, s_tare_offset_raw) : loadcell_cal_erase();
+    s_cal_saved = (err == ESP_OK);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "calibration not persisted: %s", esp_err_to_name(err));
+    }
+    char reason[EVENTS_REASON_MAX];
+    int written = (known_grams > 0.0f) ? snprintf(reason, sizeof(reason), "%s %.3fg", what, (double)known_grams)
+                                       : snprintf(reason, sizeof(reason), "%s", what);
+    if (written < 0)
+    {
+        reason[0] = '\0';
+    }
+    events_emit("scale_cal", "scale", 0, reason);
+}
+
+static esp_err_t loadcell_scale_cal_point(int samples, float known_grams, bool replace)
+{
+    if (!(known_grams > 0.0f) || known_grams > SCALE_MAX_KNOWN_GRAMS)
     {
         return ESP_ERR_INVALID_ARG;
     }
@@ -92,57 +298,125 @@ esp_err_t loadcell_scale_calibrate(int samples, float known_grams)
     {
         return ESP_ERR_INVALID_STATE;
     }
-    s_scale_factor_raw_per_gram = (float)delta / known_grams;
-    s_calibrated = true;
-    char reason[EVENTS_REASON_MAX];
-    int written = snprintf(reason, sizeof(reason), "set %.3fg", (double)known_grams);
-    if (written < 0)
+    loadcell_cal_t next = s_cal;
+    if (replace)
     {
-        reason[0] = '\0';
+        loadcell_cal_clear(&next);
     }
-    events_emit("scale_cal", "scale", 0, reason);
+    err = loadcell_cal_add_point(&next, delta, (int32_t)lroundf(known_grams * 1000.0f));
+    if (err != ESP_OK)
+    {
+        return (err == ESP_ERR_NO_MEM) ? err : ESP_ERR_INVALID_STATE;
+    }
+    s_cal = next;
+    loadcell_scale_cal_apply(replace ? "set" : "add", known_grams);
     return ESP_OK;
 }
 
-bool loadcell_scale_get_status_json(char *buf, size_t len)
+esp_err_t loadcell_scale_calibrate(int samples, float known_grams)
+{
+    return loadcell_scale_cal_point(samples, known_grams, true);
+}
+
+esp_err_t loadcell_scale_cal_add(int samples, float known_grams)
+{
+    return loadcell_scale_cal_point(samples, known_grams, false);
+}
+
+void loadcell_scale_cal_clear(void)
+{
+    loadcell_cal_clear(&s_cal);
+    loadcell_scale_cal_apply("clear", 0.0f);
+}
+
+bool loadcell_scale_write_cal_json(json_writer_t *w)
+{
+    return json_obj_begin(w) &&
+           json_write_key(w, "points") &&
+           loadcell_cal_write_json(&s_cal, w) &&
+           json_kv_u32(w, "count", s_cal.count) &&
+           json_kv_i32(w, "max", LOADCELL_CAL_MAX_POINTS) &&
+           json_kv_i32(w, "tare_offset_raw", s_tare_offset_raw) &&
+           json_kv_bool(w, "saved", s_cal_saved) &&
+           json_obj_end(w);
+}
+
+bool loadcell_scale_cal_get_json(char *buf, size_t len)
 {
     if (buf == NULL || len == 0)
     {
         return false;
     }
-    int32_t raw = 0;
-    bool has_raw = (loadcell_scale_read_raw(SCALE_DEFAULT_SAMPLES, &raw) == ESP_OK);
-    float grams = 0.0f;
-    bool has_grams = false;
-    if (has_raw && s_calibrated)
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return loadcell_scale_write_cal_json(&w);
+}
+
+esp_err_t loadcell_scale_get_cached(int32_t *raw, uint32_t *age_ms)
+{
+    if (raw == NULL || age_ms == NULL)
     {
-        has_grams = (loadcell_scale_raw_to_grams(raw, &grams) == ESP_OK);
+        return ESP_ERR_INVALID_ARG;
+    }
+    int32_t value = 0;
+    int64_t ts_us = 0;
+    if (loadcell_scale_filter_active())
+    {
+        portENTER_CRITICAL(&s_filter_mux);
+        bool has_output = s_filter_has_output;
+        value = s_filter_output;
+        ts_us = s_filter_output_us;
+        portEXIT_CRITICAL(&s_filter_mux);
+        if (!has_output)
+        {
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+    else if (loadcell_adc_peek_average(SCALE_DEFAULT_SAMPLES, &value, &ts_us) != ESP_OK)
+    {
+        return ESP_ERR_NOT_FOUND;
     }
+    int64_t age_us = esp_timer_get_time() - ts_us;
+    *raw = value;
+    *age_ms = (age_us > 0) ? (uint32_t)(age_us / 1000) : 0;
+    return ESP_OK;
+}
 
-    char raw_buf[24];
-    char grams_buf[32];
-    const char *raw_str = "null";
-    const char *grams_str = "null";
-    if (has_raw)
+void loadcell_scale_get_status(loadcell_scale_status_t *out)
+{
+    if (out == NULL)
     {
-        snprintf(raw_buf, sizeof(raw_buf), "%ld", (long)raw);
-        raw_str = raw_buf;
+        return;
     }
-    if (has_grams)
+    memset(out, 0, sizeof(*out));
+    out->has_raw = (loadcell_scale_get_cached(&out->raw, &out->age_ms) == ESP_OK);
+    if (out->has_raw && s_calibrated)
     {
-        snprintf(grams_buf, sizeof(grams_buf), "%.3f", (double)grams);
-        grams_str = grams_buf;
+        out->has_grams = (loadcell_scale_raw_to_grams(out->raw, &out->grams) == ESP_OK);
     }
+    out->tare_offset_raw = s_tare_offset_raw;
+    out->scale_factor = s_scale_factor_raw_per_gram;
+    out->calibrated = s_calibrated;
+}
 
-    int written = snprintf(buf, len,
-                           "{\"raw\":%s,\"grams\":%s,"
-                           "\"tare_offset_raw\":%ld,"
-                           "\"scale_factor\":%.6f,"
-                           "\"calibrated\":%s}",
-                           raw_str,
-                           grams_str,
-                           (long)s_tare_offset_raw,
-                           (double)s_scale_factor_raw_per_gram,
-                           s_calibrated ? "true" : "false");
-    return (written >= 0 && (size_t)written < len);
+bool loadcell_scale_write_status_json(json_writer_t *w)
+{
+    loadcell_scale_status_t st;
+    loadcell_scale_get_status(&st);
+    return json_obj_begin(w) &&
+           (st.has_raw ? json_kv_i32(w, "raw", st.raw) : json_kv_null(w, "raw")) &&
+           (st.has_grams ? json_kv_float(w, "grams", st.grams, 3) : json_kv_null(w, "grams")) &&
+           (st.has_raw ? json_kv_u32(w, "age_ms", st.age_ms) : json_kv_null(w, "age_ms")) &&
+           json_kv_i32(w, "tare_offset_raw", st.tare_offset_raw) &&
+           json_kv_float(w, "scale_factor", st.scale_factor, 6) &&
+           json_kv_bool(w, "calibrated", st.calibrated) &&
+           json_obj_end(w);
 }
+
+bool loadcell_scale_get_status_json(char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return loadcell_scale_write_status_json(&w);
+}
+
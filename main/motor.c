@@ -7,14 +7,21 @@
 #include "events.h"
 #include "stepper_driver_uart.h"
 #include "motor_driver_defaults.h"
+#include "driver_profile.h"
 #include "esp_log.h"
 #include "esp_attr.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #define MOTOR_EN_ACTIVE_LEVEL 0
 #define MOTOR_DIR_FWD_LEVEL 0
 #define MOTOR_TIMER_RES_HZ 1000000
+#define MOTOR_DRIVER_INIT_TASK_STACK 3072
+#define MOTOR_DRIVER_INIT_TASK_PRIO 3
+#define MOTOR_RAMP_TICK_MS 10
 
 static const char *TAG = "motor";
 
@@ -23,13 +30,49 @@ static bool s_timer_running = false;
 static bool s_step_level = false;
 
 static uint32_t s_step_hz = 0;
+// Rising STEP edges, signed by direction; updated in the timer ISR.
+static volatile int32_t s_step_pos = 0;
+static volatile int32_t s_step_sign = 1;
 static motor_dir_t s_dir = MOTOR_DIR_FWD;
 static bool s_enabled = false;
 static motor_state_t s_state = MOTOR_STATE_DISABLED;
 static int s_fault_code = 0;
-static char s_fault_reason[32] = "none";
+static char s_fault_reason[MOTOR_FAULT_REASON_MAX] = "none";
+// One driver_diag event per DIAG rising edge until motor_clear_faults() re-arms it. The
+// strings are in DRAM so the ISR can emit while the flash cache is disabled.
+static volatile bool s_diag_armed = false;
+static const char DRAM_ATTR k_diag_event_type[] = "driver_diag";
+static const char DRAM_ATTR k_diag_event_subsystem[] = "motor";
+static const char DRAM_ATTR k_diag_event_reason[] = "rising";
 
-static const char *motor_state_to_str(motor_state_t state)
+typedef enum
+{
+    MOTOR_DRIVER_STEP_UART_INIT = 0,
+    MOTOR_DRIVER_STEP_GCONF,
+    MOTOR_DRIVER_STEP_PING,
+    MOTOR_DRIVER_STEP_CONFIG,
+    MOTOR_DRIVER_STEP_COUNT,
+} motor_driver_init_step_id_t;
+
+typedef struct
+{
+    const char *name;
+    int64_t start_us;
+    int64_t end_us;
+    esp_err_t err;
+    bool done;
+} motor_driver_init_step_t;
+
+static volatile motor_driver_init_state_t s_driver_init_state = MOTOR_DRIVER_INIT_PENDING;
+static motor_driver_init_step_t s_driver_steps[MOTOR_DRIVER_STEP_COUNT] = {
+    [MOTOR_DRIVER_STEP_UART_INIT] = {.name = "uart_init"},
+    [MOTOR_DRIVER_STEP_GCONF] = {.name = "gconf"},
+    [MOTOR_DRIVER_STEP_PING] = {.name = "ping"},
+    [MOTOR_DRIVER_STEP_CONFIG] = {.name = "config"},
+};
+static char s_driver_profile[DRIVER_PROFILE_NAME_MAX + 1];
+
+const char *motor_state_to_str(motor_state_t state)
 {
     switch (state)
     {
@@ -46,7 +89,7 @@ static const char *motor_state_to_str(motor_state_t state)
     }
 }
 
-static const char *motor_dir_to_str(motor_dir_t dir)
+const char *motor_dir_to_str(motor_dir_t dir)
 {
     return (dir == MOTOR_DIR_REV) ? "CCW" : "CW";
 }
@@ -66,9 +109,56 @@ static bool IRAM_ATTR motor_on_alarm(gptimer_handle_t timer,
     (void)user_data;
     s_step_level = !s_step_level;
     gpio_set_level(PIN_STEPPER_DRIVER_STEP, s_step_level ? 1 : 0);
+    if (s_step_level)
+    {
+        s_step_pos += s_step_sign;
+    }
     return false;
 }
 
+// TMC2209 DIAG goes high on a driver error (overtemperature, short) or a StallGuard stall.
+static void IRAM_ATTR motor_diag_isr(void *arg)
+{
+    (void)arg;
+    if (s_diag_armed)
+    {
+        s_diag_armed = false;
+        events_emit(k_diag_event_type, k_diag_event_subsystem, 0, k_diag_event_reason);
+    }
+}
+
+// DIAG is push-pull on the driver; the pull-down keeps an unconnected or unpowered driver
+// from floating the pin and storming the ISR.
+static esp_err_t motor_diag_init(void)
+{
+    gpio_config_t in_cfg = {
+        .pin_bit_mask = 1ULL << PIN_STEPPER_DRIVER_DIAG,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    esp_err_t err = gpio_config(&in_cfg);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    // ESP_ERR_INVALID_STATE: already installed by another module (loadcell_adc).
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        return err;
+    }
+    s_diag_armed = true;
+    err = gpio_isr_handler_add(PIN_STEPPER_DRIVER_DIAG, motor_diag_isr, NULL);
+    if (err != ESP_OK)
+    {
+        s_diag_armed = false;
+        gpio_set_intr_type(PIN_STEPPER_DRIVER_DIAG, GPIO_INTR_DISABLE);
+    }
+    return err;
+}
+
 static esp_err_t motor_config_timer(uint32_t step_hz)
 {
     if (step_hz == 0)
@@ -95,6 +185,81 @@ static esp_err_t motor_config_timer(uint32_t step_hz)
     return gptimer_set_raw_count(s_timer, 0);
 }
 
+static void motor_driver_step_begin(motor_driver_init_step_id_t id)
+{
+    s_driver_steps[id].start_us = esp_timer_get_time();
+}
+
+static esp_err_t motor_driver_step_end(motor_driver_init_step_id_t id, esp_err_t err)
+{
+    s_driver_steps[id].end_us = esp_timer_get_time();
+    s_driver_steps[id].err = err;
+    s_driver_steps[id].done = true;
+    return err;
+}
+
+// Driver bring-up runs here so app_main reaches the console without waiting out UART
+// reply timeouts when no driver is attached.
+static void motor_driver_init_task(void *arg)
+{
+    (void)arg;
+    motor_driver_step_begin(MOTOR_DRIVER_STEP_UART_INIT);
+    esp_err_t uart_err = motor_driver_step_end(MOTOR_DRIVER_STEP_UART_INIT, stepper_driver_uart_init());
+    if (uart_err != ESP_OK)
+    {
+        s_driver_init_state = MOTOR_DRIVER_INIT_FAILED;
+        events_emit("driver_init", "motor", 1, "uart_failed");
+        vTaskDelete(NULL);
+        return;
+    }
+    motor_driver_step_begin(MOTOR_DRIVER_STEP_GCONF);
+    esp_err_t gconf_err = motor_driver_step_end(MOTOR_DRIVER_STEP_GCONF,
+                                                stepper_uart_ensure_gconf_uart_mode(stepper_driver_get_slave_addr()));
+    if (gconf_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "gconf init failed: %s", esp_err_to_name(gconf_err));
+    }
+    motor_driver_step_begin(MOTOR_DRIVER_STEP_PING);
+    esp_err_t ping_err = motor_driver_step_end(MOTOR_DRIVER_STEP_PING, stepper_driver_ping());
+    if (ping_err == ESP_OK)
+    {
+        motor_driver_defaults_t cfg;
+        bool from_profile = driver_profile_boot_config(&cfg, s_driver_profile, sizeof(s_driver_profile));
+        if (!from_profile)
+        {
+            s_driver_profile[0] = '\0';
+        }
+        motor_driver_step_begin(MOTOR_DRIVER_STEP_CONFIG);
+        esp_err_t cfg_err = motor_driver_step_end(MOTOR_DRIVER_STEP_CONFIG, stepper_driver_apply_config(&cfg));
+        if (cfg_err == ESP_OK)
+        {
+            ESP_LOGI("stepper_uart",
+                     "config (%s): current run=%u hold=%u hold_delay=%u microsteps=%u stealthchop=%d",
+                     from_profile ? s_driver_profile : "defaults",
+                     (unsigned)cfg.run_current,
+                     (unsigned)cfg.hold_current,
+                     (unsigned)cfg.hold_delay,
+                     (unsigned)cfg.microsteps,
+                     cfg.stealthchop ? 1 : 0);
+            s_driver_init_state = MOTOR_DRIVER_INIT_READY;
+            events_emit("driver_init", "motor", 0, "ready");
+        }
+        else
+        {
+            ESP_LOGW("stepper_uart", "config apply failed: %s", esp_err_to_name(cfg_err));
+            s_driver_init_state = MOTOR_DRIVER_INIT_CONFIG_FAILED;
+            events_emit("driver_init", "motor", 3, "config_failed");
+        }
+    }
+    else
+    {
+        ESP_LOGW("stepper_uart", "config skipped: ping failed (%s)", esp_err_to_name(ping_err));
+        s_driver_init_state = MOTOR_DRIVER_INIT_NO_RESPONSE;
+        events_emit("driver_init", "motor", 2, "no_response");
+    }
+    vTaskDelete(NULL);
+}
+
 esp_err_t motor_init(void)
 {
     gpio_config_t out_cfg = {
@@ -111,19 +276,6 @@ esp_err_t motor_init(void)
     {
         return err;
     }
-    gpio_config_t in_cfg = {
-        .pin_bit_mask = 1ULL << PIN_STEPPER_DRIVER_DIAG,
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
-    };
-    err = gpio_config(&in_cfg);
-    if (err != ESP_OK)
-    {
-        return err;
-    }
-
     gpio_set_level(PIN_STEPPER_DRIVER_EN, !MOTOR_EN_ACTIVE_LEVEL);
     gpio_set_level(PIN_STEPPER_DRIVER_DIR, MOTOR_DIR_FWD_LEVEL);
     motor_set_step_level(false);
@@ -159,35 +311,28 @@ esp_err_t motor_init(void)
     s_state = MOTOR_STATE_DISABLED;
     s_fault_code = 0;
     snprintf(s_fault_reason, sizeof(s_fault_reason), "none");
-    stepper_driver_uart_init();
-    esp_err_t gconf_err = stepper_uart_ensure_gconf_uart_mode(0);
-    if (gconf_err != ESP_OK)
+    // Only diagnostics: without the DIAG edge event the motor still runs, so this cannot fail
+    // motor_init.
+    err = motor_diag_init();
+    if (err != ESP_OK)
     {
-        ESP_LOGE(TAG, "gconf init failed: %s", esp_err_to_name(gconf_err));
+        ESP_LOGW(TAG, "DIAG edge event unavailable: %s", esp_err_to_name(err));
     }
-    esp_err_t ping_err = stepper_driver_ping();
-    if (ping_err == ESP_OK)
+    // The bus lock must exist before anything can reach the driver API; the init task and the
+    // console both start using it right away.
+    err = stepper_uart_bus_init();
+    if (err != ESP_OK)
     {
-        const motor_driver_defaults_t defaults = motor_driver_defaults();
-        esp_err_t cur_err = stepper_driver_set_current(defaults.run_current,
-                                                       defaults.hold_current,
-                                                       defaults.hold_delay);
-        if (cur_err == ESP_OK)
-        {
-            ESP_LOGI("stepper_uart",
-                     "defaults: current run=%u hold=%u hold_delay=%u",
-                     (unsigned)defaults.run_current,
-                     (unsigned)defaults.hold_current,
-                     (unsigned)defaults.hold_delay);
-        }
-        else
-        {
-            ESP_LOGW("stepper_uart", "defaults current set failed: %s", esp_err_to_name(cur_err));
-        }
+        ESP_LOGE(TAG, "driver bus init failed: %s", esp_err_to_name(err));
+        s_driver_init_state = MOTOR_DRIVER_INIT_FAILED;
+        return err;
     }
-    else
+    if (xTaskCreate(motor_driver_init_task, "motor_drv_init", MOTOR_DRIVER_INIT_TASK_STACK, NULL,
+                    MOTOR_DRIVER_INIT_TASK_PRIO, NULL) != pdPASS)
     {
-        ESP_LOGW("stepper_uart", "defaults skipped: ping failed (%s)", esp_err_to_name(ping_err));
+        ESP_LOGE(TAG, "driver init task create failed");
+        s_driver_init_state = MOTOR_DRIVER_INIT_FAILED;
+        return ESP_ERR_NO_MEM;
     }
     return ESP_OK;
 }
@@ -228,18 +373,16 @@ esp_err_t motor_disable(void)
 esp_err_t motor_set_dir(motor_dir_t dir)
 {
     s_dir = (dir == MOTOR_DIR_REV) ? MOTOR_DIR_REV : MOTOR_DIR_FWD;
+    s_step_sign = (s_dir == MOTOR_DIR_REV) ? -1 : 1;
     gpio_set_level(PIN_STEPPER_DRIVER_DIR,
                    (s_dir == MOTOR_DIR_FWD) ? MOTOR_DIR_FWD_LEVEL : !MOTOR_DIR_FWD_LEVEL);
     events_emit("motor_dir", "motor", 0, motor_dir_to_str(s_dir));
     return ESP_OK;
 }
 
-esp_err_t motor_set_speed_hz(uint32_t step_hz)
+// Retimes the STEP timer without emitting an event; callers validate the range.
+static esp_err_t motor_apply_speed_hz(uint32_t step_hz)
 {
-    if (step_hz < MOTOR_MIN_HZ || step_hz > MOTOR_MAX_HZ)
-    {
-        return ESP_ERR_INVALID_ARG;
-    }
     s_step_hz = step_hz;
     if (s_state == MOTOR_STATE_RUNNING)
     {
@@ -258,6 +401,11 @@ esp_err_t motor_set_speed_hz(uint32_t step_hz)
         }
         s_timer_running = true;
     }
+    return ESP_OK;
+}
+
+static void motor_emit_speed_event(void)
+{
     char reason[EVENTS_REASON_MAX];
     int written = snprintf(reason, sizeof(reason), "%uHz", (unsigned)s_step_hz);
     if (written < 0)
@@ -265,6 +413,58 @@ esp_err_t motor_set_speed_hz(uint32_t step_hz)
         reason[0] = '\0';
     }
     events_emit("motor_speed", "motor", 0, reason);
+}
+
+esp_err_t motor_set_speed_hz(uint32_t step_hz)
+{
+    if (step_hz < MOTOR_MIN_HZ || step_hz > MOTOR_MAX_HZ)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = motor_apply_speed_hz(step_hz);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    motor_emit_speed_event();
+    return ESP_OK;
+}
+
+esp_err_t motor_ramp_speed_hz(uint32_t step_hz, uint32_t accel_hz_per_s)
+{
+    if (step_hz < MOTOR_MIN_HZ || step_hz > MOTOR_MAX_HZ || accel_hz_per_s == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t max_delta = accel_hz_per_s * MOTOR_RAMP_TICK_MS / 1000;
+    if (max_delta == 0)
+    {
+        max_delta = 1;
+    }
+    uint32_t hz = s_step_hz;
+    while (hz != step_hz && s_state == MOTOR_STATE_RUNNING)
+    {
+        if (hz < step_hz)
+        {
+            hz = (step_hz - hz > max_delta) ? hz + max_delta : step_hz;
+        }
+        else
+        {
+            hz = (hz - step_hz > max_delta) ? hz - max_delta : step_hz;
+        }
+        esp_err_t err = motor_apply_speed_hz(hz);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        if (hz != step_hz)
+        {
+            vTaskDelay(pdMS_TO_TICKS(MOTOR_RAMP_TICK_MS));
+        }
+    }
+    // Stopped (or never running): just take the target for the next start.
+    s_step_hz = step_hz;
+    motor_emit_speed_event();
     return ESP_OK;
 }
 
@@ -326,30 +526,147 @@ esp_err_t motor_stop(void)
     return ESP_OK;
 }
 
+motor_state_t motor_get_state(void)
+{
+    return s_state;
+}
+
+int32_t motor_get_step_pos(void)
+{
+    return s_step_pos;
+}
+
+void motor_reset_step_pos(void)
+{
+    s_step_pos = 0;
+}
+
+uint32_t motor_get_speed_hz(void)
+{
+    return (s_state == MOTOR_STATE_RUNNING) ? s_step_hz : 0;
+}
+
 esp_err_t motor_clear_faults(void)
 {
     s_fault_code = 0;
     snprintf(s_fault_reason, sizeof(s_fault_reason), "none");
     s_state = s_enabled ? MOTOR_STATE_ENABLED_IDLE : MOTOR_STATE_DISABLED;
+    s_diag_armed = true;
     return ESP_OK;
 }
 
+void motor_get_status(motor_status_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    out->state = s_state;
+    out->enabled = s_enabled;
+    out->step_hz = s_enabled ? s_step_hz : 0;
+    out->dir = s_dir;
+    out->fault_code = s_fault_code;
+    snprintf(out->fault_reason, sizeof(out->fault_reason), "%s", s_fault_reason);
+}
+
+bool motor_write_status_json(json_writer_t *w)
+{
+    motor_status_t st;
+    motor_get_status(&st);
+    return json_obj_begin(w) &&
+           json_kv_str(w, "state", motor_state_to_str(st.state)) &&
+           json_kv_bool(w, "enabled", st.enabled) &&
+           json_kv_u32(w, "step_hz", st.step_hz) &&
+           json_kv_str(w, "dir", motor_dir_to_str(st.dir)) &&
+           json_kv_i32(w, "fault_code", st.fault_code) &&
+           json_kv_str(w, "fault_reason", st.fault_reason) &&
+           json_obj_end(w);
+}
+
 bool motor_get_status_json(char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return motor_write_status_json(&w);
+}
+
+motor_driver_init_state_t motor_get_driver_init_state(void)
+{
+    return s_driver_init_state;
+}
+
+bool motor_wait_driver_init(uint32_t timeout_ms)
+{
+    const TickType_t start = xTaskGetTickCount();
+    while (s_driver_init_state == MOTOR_DRIVER_INIT_PENDING)
+    {
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(timeout_ms))
+        {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
+}
+
+static const char *motor_driver_init_state_to_str(motor_driver_init_state_t state)
+{
+    switch (state)
+    {
+    case MOTOR_DRIVER_INIT_PENDING:
+        return "pending";
+    case MOTOR_DRIVER_INIT_READY:
+        return "ready";
+    case MOTOR_DRIVER_INIT_NO_RESPONSE:
+        return "no_response";
+    case MOTOR_DRIVER_INIT_FAILED:
+        return "failed";
+    case MOTOR_DRIVER_INIT_CONFIG_FAILED:
+        return "config_failed";
+    default:
+        return "unknown";
+    }
+}
+
+bool motor_write_driver_init_json(json_writer_t *w)
+{
+    bool ok = json_obj_begin(w) &&
+              json_kv_str(w, "state", motor_driver_init_state_to_str(s_driver_init_state)) &&
+              json_kv_str(w, "profile", (s_driver_profile[0] != '\0') ? s_driver_profile : NULL) &&
+              json_write_key(w, "steps") &&
+              json_arr_begin(w);
+    for (size_t i = 0; ok && i < MOTOR_DRIVER_STEP_COUNT; ++i)
+    {
+        const motor_driver_init_step_t *step = &s_driver_steps[i];
+        if (step->start_us == 0)
+        {
+            continue;
+        }
+        ok = json_obj_begin(w) &&
+             json_kv_str(w, "name", step->name) &&
+             json_kv_i64(w, "start_us", step->start_us);
+        if (step->done)
+        {
+            ok = ok &&
+                 json_kv_i64(w, "dur_us", step->end_us - step->start_us) &&
+                 json_kv_str(w, "err", esp_err_to_name(step->err));
+        }
+        else
+        {
+            ok = ok && json_kv_null(w, "dur_us") && json_kv_null(w, "err");
+        }
+        ok = ok && json_obj_end(w);
+    }
+    return ok && json_arr_end(w) && json_obj_end(w);
+}
+
+bool motor_get_driver_init_json(char *buf, size_t len)
 {
     if (buf == NULL || len == 0)
     {
         return false;
     }
-    uint32_t report_hz = s_enabled ? s_step_hz : 0;
-    int written = snprintf(buf, len,
-                           "{\"state\":\"%s\",\"enabled\":%s,"
-                           "\"step_hz\":%u,\"dir\":\"%s\","
-                           "\"fault_code\":%d,\"fault_reason\":\"%s\"}",
-                           motor_state_to_str(s_state),
-                           s_enabled ? "true" : "false",
-                           (unsigned)report_hz,
-                           motor_dir_to_str(s_dir),
-                           s_fault_code,
-                           s_fault_reason);
-    return (written >= 0 && (size_t)written < len);
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return motor_write_driver_init_json(&w);
 }
@@ -0,0 +1,38 @@
+#include "nvs_storage.h"
+
+#include "esp_log.h"
+#include "nvs_flash.h"
+
+static const char *TAG = "nvs_storage";
+
+static bool s_ready = false;
+
+esp_err_t nvs_storage_init(void)
+{
+    if (s_ready)
+    {
+        return ESP_OK;
+    }
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_LOGW(TAG, "erasing NVS: %s", esp_err_to_name(err));
+        err = nvs_flash_erase();
+        if (err == ESP_OK)
+        {
+            err = nvs_flash_init();
+        }
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "nvs_flash_init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_ready = true;
+    return ESP_OK;
+}
+
+bool nvs_storage_is_ready(void)
+{
+    return s_ready;
+}
@@ -3,294 +3,518 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "esp_cpu.h"
 #include "esp_system.h"
 #include "esp_timer.h"
 #include "esp_mac.h"
 #include "fw_version.h"
 #include "board.h"
+#include "boot_profile.h"
+#include "cbor_writer.h"
+#include "json_helpers.h"
 #include "loadcell_scale.h"
 #include "motor.h"
 #include "reset_reason.h"
+#include "stepper_driver_uart.h"
 
-#define SNAPSHOT_MAX_FIELDS 16
+typedef bool (*snapshot_value_fn)(json_writer_t *w);
 
-typedef struct
+static bool snapshot_field_uptime(json_writer_t *w)
 {
-    const char *key;
-    snapshot_value_fn value_fn;
-} snapshot_field_t;
+    return json_write_i64(w, esp_timer_get_time() / 1000);
+}
 
-static snapshot_field_t s_fields[SNAPSHOT_MAX_FIELDS];
-static size_t s_field_count = 0;
-static bool s_defaults_registered = false;
+static bool snapshot_field_heap_free(json_writer_t *w)
+{
+    return json_write_u32(w, esp_get_free_heap_size());
+}
 
-static bool snapshot_append_char(char *buf, size_t len, size_t *used, char c)
+static bool snapshot_field_heap_min_free(json_writer_t *w)
 {
-    if (*used + 1 >= len)
-    {
-        return false;
-    }
-    buf[*used] = c;
-    *used += 1;
-    buf[*used] = '\0';
-    return true;
+    return json_write_u32(w, esp_get_minimum_free_heap_size());
+}
+
+static bool snapshot_field_reset_reason(json_writer_t *w)
+{
+    return json_write_str(w, reset_reason_to_str(esp_reset_reason()));
+}
+
+static bool snapshot_field_fw_version(json_writer_t *w)
+{
+    return json_write_str(w, FW_VERSION);
+}
+
+static bool snapshot_field_fw_build(json_writer_t *w)
+{
+    return json_write_str(w, FW_BUILD);
+}
+
+static bool snapshot_field_schema_version(json_writer_t *w)
+{
+    return json_write_u32(w, (uint32_t)SNAPSHOT_SCHEMA_VERSION);
 }
 
-static bool snapshot_append_bytes(char *buf, size_t len, size_t *used, const char *src, size_t src_len)
+static bool snapshot_device_id(char id[13])
 {
-    if (*used + src_len >= len)
+    uint8_t mac[6] = {0};
+    if (esp_read_mac(mac, ESP_MAC_WIFI_STA) != ESP_OK)
     {
         return false;
     }
-    memcpy(&buf[*used], src, src_len);
-    *used += src_len;
-    buf[*used] = '\0';
+    snprintf(id, 13, "%02X%02X%02X%02X%02X%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     return true;
 }
 
-bool snapshot_append_raw(char *buf, size_t len, size_t *used, const char *value)
+static bool snapshot_field_device_id(json_writer_t *w)
 {
-    if (value == NULL)
+    char id[13];
+    if (!snapshot_device_id(id))
     {
         return false;
     }
-    return snapshot_append_bytes(buf, len, used, value, strlen(value));
+    return json_write_str(w, id);
 }
 
-bool snapshot_append_u32(char *buf, size_t len, size_t *used, uint32_t value)
+static bool snapshot_field_hw_rev(json_writer_t *w)
 {
-    char tmp[16];
-    int written = snprintf(tmp, sizeof(tmp), "%u", (unsigned)value);
-    if (written < 0 || (size_t)written >= sizeof(tmp))
-    {
-        return false;
-    }
-    return snapshot_append_bytes(buf, len, used, tmp, (size_t)written);
+    return json_write_u32(w, (uint32_t)HW_REV);
 }
 
-bool snapshot_append_i64(char *buf, size_t len, size_t *used, int64_t value)
+static bool snapshot_field_board_safe(json_writer_t *w)
 {
-    char tmp[24];
-    int written = snprintf(tmp, sizeof(tmp), "%lld", (long long)value);
-    if (written < 0 || (size_t)written >= sizeof(tmp))
-    {
-        return false;
-    }
-    return snapshot_append_bytes(buf, len, used, tmp, (size_t)written);
+    return json_write_bool(w, board_is_safe());
 }
 
-bool snapshot_append_bool(char *buf, size_t len, size_t *used, bool value)
+static bool snapshot_field_scale(json_writer_t *w)
 {
-    return snapshot_append_raw(buf, len, used, value ? "true" : "false");
+    return loadcell_scale_write_status_json(w);
 }
 
-bool snapshot_append_string(char *buf, size_t len, size_t *used, const char *value)
+static bool snapshot_field_motor(json_writer_t *w)
 {
-    if (value == NULL)
-    {
-        return false;
-    }
-    if (!snapshot_append_char(buf, len, used, '"'))
+    return motor_write_status_json(w);
+}
+
+static bool snapshot_field_driver_uart(json_writer_t *w)
+{
+    return stepper_uart_write_stats_summary_json(w);
+}
+
+// CBOR encoders mirror the JSON fields above: same keys, null where JSON prints null,
+// integers as CBOR integers and grams/scale_factor as float32.
+static bool snapshot_cbor_uptime(cbor_writer_t *w)
+{
+    return cbor_write_int(w, esp_timer_get_time() / 1000);
+}
+
+static bool snapshot_cbor_heap_free(cbor_writer_t *w)
+{
+    return cbor_write_uint(w, esp_get_free_heap_size());
+}
+
+static bool snapshot_cbor_heap_min_free(cbor_writer_t *w)
+{
+    return cbor_write_uint(w, esp_get_minimum_free_heap_size());
+}
+
+static bool snapshot_cbor_reset_reason(cbor_writer_t *w)
+{
+    return cbor_write_text(w, reset_reason_to_str(esp_reset_reason()));
+}
+
+static bool snapshot_cbor_fw_version(cbor_writer_t *w)
+{
+    return cbor_write_text(w, FW_VERSION);
+}
+
+static bool snapshot_cbor_fw_build(cbor_writer_t *w)
+{
+    return cbor_write_text(w, FW_BUILD);
+}
+
+static bool snapshot_cbor_schema_version(cbor_writer_t *w)
+{
+    return cbor_write_uint(w, (uint32_t)SNAPSHOT_SCHEMA_VERSION);
+}
+
+static bool snapshot_cbor_device_id(cbor_writer_t *w)
+{
+    char id[13];
+    if (!snapshot_device_id(id))
     {
         return false;
     }
-    for (const unsigned char *p = (const unsigned char *)value; *p != '\0'; ++p)
-    {
-        unsigned char c = *p;
-        if (c == '"' || c == '\\')
-        {
-            if (!snapshot_append_char(buf, len, used, '\\') ||
-                !snapshot_append_char(buf, len, used, (char)c))
-            {
-                return false;
-            }
-        }
-        else if (c < 0x20)
-        {
-            char esc[7];
-            int written = snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)c);
-            if (written != 6 || !snapshot_append_bytes(buf, len, used, esc, 6))
-            {
-                return false;
-            }
-        }
-        else
-        {
-            if (!snapshot_append_char(buf, len, used, (char)c))
-            {
-                return false;
-            }
-        }
-    }
-    return snapshot_append_char(buf, len, used, '"');
+    return cbor_write_text(w, id);
 }
 
-static bool snapshot_field_uptime(char *buf, size_t len, size_t *used)
+static bool snapshot_cbor_hw_rev(cbor_writer_t *w)
 {
-    return snapshot_append_i64(buf, len, used, esp_timer_get_time() / 1000);
+    return cbor_write_uint(w, (uint32_t)HW_REV);
 }
 
-static bool snapshot_field_heap_free(char *buf, size_t len, size_t *used)
+static bool snapshot_cbor_board_safe(cbor_writer_t *w)
 {
-    return snapshot_append_u32(buf, len, used, esp_get_free_heap_size());
+    return cbor_write_bool(w, board_is_safe());
 }
 
-static bool snapshot_field_heap_min_free(char *buf, size_t len, size_t *used)
+// Members of the nested status objects, in output order: X(key, cbor_value), where
+// cbor_value encodes the member from the status struct st into w. The JSON side is written by
+// the owning module; these lists give the CBOR map sizes and the fallback key sets, and the
+// host contract test checks them against the JSON output. Keep in sync with
+// docs/firmware_contract.md.
+#define SNAPSHOT_SCALE_MEMBERS(X)                                                       \
+    X("raw", st.has_raw ? cbor_write_int(w, st.raw) : cbor_write_null(w))               \
+    X("grams", st.has_grams ? cbor_write_float(w, st.grams) : cbor_write_null(w))       \
+    X("age_ms", st.has_raw ? cbor_write_uint(w, st.age_ms) : cbor_write_null(w))        \
+    X("tare_offset_raw", cbor_write_int(w, st.tare_offset_raw))                         \
+    X("scale_factor", cbor_write_float(w, st.scale_factor))                             \
+    X("calibrated", cbor_write_bool(w, st.calibrated))
+
+#define SNAPSHOT_MOTOR_MEMBERS(X)                                                       \
+    X("state", cbor_write_text(w, motor_state_to_str(st.state)))                        \
+    X("enabled", cbor_write_bool(w, st.enabled))                                        \
+    X("step_hz", cbor_write_uint(w, st.step_hz))                                        \
+    X("dir", cbor_write_text(w, motor_dir_to_str(st.dir)))                              \
+    X("fault_code", cbor_write_int(w, st.fault_code))                                   \
+    X("fault_reason", cbor_write_text(w, st.fault_reason))
+
+#define SNAPSHOT_DRIVER_UART_MEMBERS(X)                                                 \
+    X("ok", cbor_write_uint(w, st.ok))                                                  \
+    X("timeout", cbor_write_uint(w, st.timeout))                                        \
+    X("echo_only", cbor_write_uint(w, st.echo_only))                                    \
+    X("crc_fail", cbor_write_uint(w, st.crc_fail))                                      \
+    X("wrong_reg", cbor_write_uint(w, st.wrong_reg))                                    \
+    X("retries", cbor_write_uint(w, st.retries))
+
+#define SNAPSHOT_MEMBER_ONE(key, value) +1
+#define SNAPSHOT_MEMBER_COUNT(members) (0 members(SNAPSHOT_MEMBER_ONE))
+#define SNAPSHOT_MEMBER_KEY(key, value) key,
+#define SNAPSHOT_MEMBER_CBOR(key, value) && cbor_write_text(w, key) && (value)
+
+static bool snapshot_cbor_scale(cbor_writer_t *w)
 {
-    return snapshot_append_u32(buf, len, used, esp_get_minimum_free_heap_size());
+    loadcell_scale_status_t st;
+    loadcell_scale_get_status(&st);
+    return cbor_write_map(w, SNAPSHOT_MEMBER_COUNT(SNAPSHOT_SCALE_MEMBERS))
+        SNAPSHOT_SCALE_MEMBERS(SNAPSHOT_MEMBER_CBOR);
 }
 
-static bool snapshot_field_reset_reason(char *buf, size_t len, size_t *used)
+static bool snapshot_cbor_motor(cbor_writer_t *w)
 {
-    return snapshot_append_string(buf, len, used, reset_reason_to_str(esp_reset_reason()));
+    motor_status_t st;
+    motor_get_status(&st);
+    return cbor_write_map(w, SNAPSHOT_MEMBER_COUNT(SNAPSHOT_MOTOR_MEMBERS))
+        SNAPSHOT_MOTOR_MEMBERS(SNAPSHOT_MEMBER_CBOR);
 }
 
-static bool snapshot_field_fw_version(char *buf, size_t len, size_t *used)
+static bool snapshot_cbor_driver_uart(cbor_writer_t *w)
 {
-    return snapshot_append_string(buf, len, used, FW_VERSION);
+    stepper_uart_stats_t st;
+    stepper_uart_get_stats(&st);
+    return cbor_write_map(w, SNAPSHOT_MEMBER_COUNT(SNAPSHOT_DRIVER_UART_MEMBERS))
+        SNAPSHOT_DRIVER_UART_MEMBERS(SNAPSHOT_MEMBER_CBOR);
 }
 
-static bool snapshot_field_fw_build(char *buf, size_t len, size_t *used)
+// Written in place of a value whose json_fn failed: an object with every member null, or
+// (keys NULL) a bare null.
+typedef struct
 {
-    return snapshot_append_string(buf, len, used, FW_BUILD);
-}
+    const char *const *keys;
+    uint8_t count;
+} snapshot_fallback_t;
 
-static bool snapshot_field_schema_version(char *buf, size_t len, size_t *used)
+static const char *const k_scale_keys[] = {SNAPSHOT_SCALE_MEMBERS(SNAPSHOT_MEMBER_KEY)};
+static const char *const k_motor_keys[] = {SNAPSHOT_MOTOR_MEMBERS(SNAPSHOT_MEMBER_KEY)};
+static const char *const k_driver_uart_keys[] = {SNAPSHOT_DRIVER_UART_MEMBERS(SNAPSHOT_MEMBER_KEY)};
+
+static const snapshot_fallback_t k_fallback_null = {NULL, 0};
+static const snapshot_fallback_t k_fallback_scale = {k_scale_keys, SNAPSHOT_MEMBER_COUNT(SNAPSHOT_SCALE_MEMBERS)};
+static const snapshot_fallback_t k_fallback_motor = {k_motor_keys, SNAPSHOT_MEMBER_COUNT(SNAPSHOT_MOTOR_MEMBERS)};
+static const snapshot_fallback_t k_fallback_driver_uart = {k_driver_uart_keys,
+                                                           SNAPSHOT_MEMBER_COUNT(SNAPSHOT_DRIVER_UART_MEMBERS)};
+
+#if defined(CONFIG_FW_SNAPSHOT_BOOT_PROFILE) && CONFIG_FW_SNAPSHOT_BOOT_PROFILE
+static bool snapshot_field_boot(json_writer_t *w)
 {
-    return snapshot_append_u32(buf, len, used, (uint32_t)SNAPSHOT_SCHEMA_VERSION);
+    return boot_profile_write_summary_json(w);
 }
 
-static bool snapshot_field_device_id(char *buf, size_t len, size_t *used)
+static bool snapshot_cbor_boot(cbor_writer_t *w)
 {
-    uint8_t mac[6] = {0};
-    if (esp_read_mac(mac, ESP_MAC_WIFI_STA) != ESP_OK)
+    if (!cbor_write_map(w, BOOT_PHASE_COUNT + 1))
     {
         return false;
     }
-    char id[13];
-    snprintf(id, sizeof(id), "%02X%02X%02X%02X%02X%02X",
-             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-    return snapshot_append_string(buf, len, used, id);
+    for (int i = 0; i < BOOT_PHASE_COUNT; ++i)
+    {
+        if (!cbor_write_text(w, boot_profile_phase_name((boot_phase_t)i)) ||
+            !cbor_write_int(w, boot_profile_phase_duration_us((boot_phase_t)i)))
+        {
+            return false;
+        }
+    }
+    return cbor_write_text(w, "total_us") && cbor_write_int(w, boot_profile_total_us());
 }
 
-static bool snapshot_field_hw_rev(char *buf, size_t len, size_t *used)
+#define SNAPSHOT_FIELDS_BOOT(X) X("boot", snapshot_field_boot, snapshot_cbor_boot, &k_fallback_null)
+#else
+#define SNAPSHOT_FIELDS_BOOT(X)
+#endif
+
+// Snapshot schema, in output order: X(key, json_fn, cbor_fn, fallback). When json_fn fails
+// with room left in the buffer its partial output is discarded and the fallback (a
+// snapshot_fallback_t) is written instead; a NULL fallback, or a full buffer, fails the whole
+// build. cbor_fn reads typed state and only fails when the buffer is full (or, like json_fn,
+// when the value is unavailable). Keep in sync with docs/firmware_contract.md.
+#define SNAPSHOT_FIELDS(X)                                                                      \
+    X("uptime_ms", snapshot_field_uptime, snapshot_cbor_uptime, NULL)                           \
+    X("heap_free_bytes", snapshot_field_heap_free, snapshot_cbor_heap_free, NULL)               \
+    X("heap_min_free_bytes", snapshot_field_heap_min_free, snapshot_cbor_heap_min_free, NULL)   \
+    X("reset_reason", snapshot_field_reset_reason, snapshot_cbor_reset_reason, NULL)            \
+    X("fw_version", snapshot_field_fw_version, snapshot_cbor_fw_version, NULL)                  \
+    X("fw_build", snapshot_field_fw_build, snapshot_cbor_fw_build, NULL)                        \
+    X("schema_version", snapshot_field_schema_version, snapshot_cbor_schema_version, NULL)      \
+    X("device_id", snapshot_field_device_id, snapshot_cbor_device_id, NULL)                     \
+    X("hw_rev", snapshot_field_hw_rev, snapshot_cbor_hw_rev, NULL)                              \
+    X("board_safe", snapshot_field_board_safe, snapshot_cbor_board_safe, NULL)                  \
+    X("scale", snapshot_field_scale, snapshot_cbor_scale, &k_fallback_scale)                    \
+    X("motor", snapshot_field_motor, snapshot_cbor_motor, &k_fallback_motor)                    \
+    X("driver_uart", snapshot_field_driver_uart, snapshot_cbor_driver_uart,                     \
+      &k_fallback_driver_uart)                                                                  \
+    SNAPSHOT_FIELDS_BOOT(X)
+
+typedef struct
+{
+    const char *key;
+    uint8_t key_len;
+    const char *json_key; // pre-encoded "key": so builds skip escaping and separate writes
+    uint8_t json_key_len;
+    snapshot_value_fn value_fn;
+    bool (*cbor_fn)(cbor_writer_t *w);
+    const snapshot_fallback_t *fallback;
+} snapshot_field_t;
+
+#define SNAPSHOT_FIELD_ENTRY(key, fn, cbor_fn, fallback)                               \
+    {key, (uint8_t)(sizeof(key) - 1), "\"" key "\":", (uint8_t)(sizeof(key) + 2), fn, \
+     cbor_fn, fallback},
+static const snapshot_field_t k_fields[] = {SNAPSHOT_FIELDS(SNAPSHOT_FIELD_ENTRY)};
+#undef SNAPSHOT_FIELD_ENTRY
+
+#define SNAPSHOT_FIELD_COUNT (sizeof(k_fields) / sizeof(k_fields[0]))
+
+const char *snapshot_field_key(size_t index)
 {
-    return snapshot_append_u32(buf, len, used, (uint32_t)HW_REV);
+    return (index < SNAPSHOT_FIELD_COUNT) ? k_fields[index].key : NULL;
 }
 
-static bool snapshot_field_board_safe(char *buf, size_t len, size_t *used)
+size_t snapshot_field_count(void)
 {
-    return snapshot_append_bool(buf, len, used, board_is_safe());
+    return SNAPSHOT_FIELD_COUNT;
 }
 
-static bool snapshot_field_scale(char *buf, size_t len, size_t *used)
+static bool snapshot_write_fallback(json_writer_t *w, const snapshot_fallback_t *fallback)
 {
-    char scale_json[192];
-    if (!loadcell_scale_get_status_json(scale_json, sizeof(scale_json)))
+    if (fallback->keys == NULL)
     {
-        return snapshot_append_raw(buf, len, used,
-                                   "{\"raw\":null,\"grams\":null,"
-                                   "\"tare_offset_raw\":0,\"scale_factor\":0.0,"
-                                   "\"calibrated\":false}");
+        return json_write_null(w);
     }
-    return snapshot_append_raw(buf, len, used, scale_json);
+    if (!json_obj_begin(w))
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < fallback->count; ++i)
+    {
+        if (!json_kv_null(w, fallback->keys[i]))
+        {
+            return false;
+        }
+    }
+    return json_obj_end(w);
 }
 
-static bool snapshot_field_motor(char *buf, size_t len, size_t *used)
+bool snapshot_field_fallback_json(size_t index, char *buf, size_t len)
 {
-    char motor_json[192];
-    if (!motor_get_status_json(motor_json, sizeof(motor_json)))
+    if (index >= SNAPSHOT_FIELD_COUNT || k_fields[index].fallback == NULL)
     {
-        return snapshot_append_raw(buf, len, used,
-                                   "{\"state\":\"disabled\",\"enabled\":false,"
-                                   "\"step_hz\":0,\"dir\":\"CW\","
-                                   "\"fault_code\":0,\"fault_reason\":\"none\"}");
+        return false;
     }
-    return snapshot_append_raw(buf, len, used, motor_json);
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return snapshot_write_fallback(&w, k_fields[index].fallback);
 }
 
-static bool snapshot_register_defaults(void)
+// Value of one field, falling back to the table entry when the value function fails for a
+// reason other than running out of buffer.
+static bool snapshot_write_value(json_writer_t *w, const snapshot_field_t *field)
 {
-    if (s_defaults_registered)
+    size_t value_start = w->used;
+    if (field->value_fn(w))
     {
         return true;
     }
-    if (!snapshot_register_field("uptime_ms", snapshot_field_uptime) ||
-        !snapshot_register_field("heap_free_bytes", snapshot_field_heap_free) ||
-        !snapshot_register_field("heap_min_free_bytes", snapshot_field_heap_min_free) ||
-        !snapshot_register_field("reset_reason", snapshot_field_reset_reason) ||
-        !snapshot_register_field("fw_version", snapshot_field_fw_version) ||
-        !snapshot_register_field("fw_build", snapshot_field_fw_build) ||
-        !snapshot_register_field("schema_version", snapshot_field_schema_version) ||
-        !snapshot_register_field("device_id", snapshot_field_device_id) ||
-        !snapshot_register_field("hw_rev", snapshot_field_hw_rev) ||
-        !snapshot_register_field("board_safe", snapshot_field_board_safe) ||
-        !snapshot_register_field("scale", snapshot_field_scale) ||
-        !snapshot_register_field("motor", snapshot_field_motor))
+    if (field->fallback == NULL || !json_writer_ok(w))
     {
         return false;
     }
-    s_defaults_registered = true;
-    return true;
+    json_writer_rewind(w, value_start, false);
+    return snapshot_write_fallback(w, field->fallback);
 }
 
-bool snapshot_register_field(const char *key, snapshot_value_fn value_fn)
+static bool snapshot_build_internal(char *buf, size_t len, snapshot_field_timing_t *timings, size_t max_timings,
+                                    size_t *timing_count)
 {
-    if (key == NULL || value_fn == NULL)
+    if (timing_count != NULL)
+    {
+        *timing_count = 0;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    if (!json_obj_begin(&w))
     {
         return false;
     }
-    for (size_t i = 0; i < s_field_count; ++i)
+    for (size_t i = 0; i < SNAPSHOT_FIELD_COUNT; ++i)
     {
-        if (strcmp(s_fields[i].key, key) == 0)
+        const snapshot_field_t *field = &k_fields[i];
+        if (!json_write_key_raw(&w, field->json_key, field->json_key_len))
+        {
+            return false;
+        }
+        bool timed = (timings != NULL && i < max_timings);
+        uint32_t start = timed ? esp_cpu_get_cycle_count() : 0;
+        bool ok = snapshot_write_value(&w, field);
+        if (timed)
+        {
+            timings[i].key = field->key;
+            timings[i].cycles = esp_cpu_get_cycle_count() - start;
+            if (timing_count != NULL)
+            {
+                *timing_count = i + 1;
+            }
+        }
+        if (!ok)
         {
             return false;
         }
     }
-    if (s_field_count >= SNAPSHOT_MAX_FIELDS)
+    return json_obj_end(&w);
+}
+
+bool snapshot_build(char *buf, size_t len)
+{
+    return snapshot_build_internal(buf, len, NULL, 0, NULL);
+}
+
+bool snapshot_build_profiled(char *buf, size_t len, snapshot_field_timing_t *timings, size_t max_timings,
+                             size_t *timing_count)
+{
+    return snapshot_build_internal(buf, len, timings, max_timings, timing_count);
+}
+
+_Static_assert(SNAPSHOT_FIELD_COUNT <= SNAPSHOT_DELTA_MAX_FIELDS, "raise SNAPSHOT_DELTA_MAX_FIELDS");
+
+static uint32_t snapshot_hash(const char *data, size_t len)
+{
+    // FNV-1a; only used to spot changed values, not for integrity.
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < len; ++i)
     {
-        return false;
+        h ^= (uint8_t)data[i];
+        h *= 16777619U;
     }
-    s_fields[s_field_count].key = key;
-    s_fields[s_field_count].value_fn = value_fn;
-    s_field_count++;
-    return true;
+    return h;
 }
 
-bool snapshot_build(char *buf, size_t len)
+void snapshot_delta_reset(snapshot_delta_t *delta)
 {
-    if (!snapshot_register_defaults())
+    if (delta != NULL)
     {
-        return false;
+        memset(delta, 0, sizeof(*delta));
+    }
+}
+
+bool snapshot_build_delta(snapshot_delta_t *delta, char *buf, size_t len, size_t *changed)
+{
+    if (changed != NULL)
+    {
+        *changed = 0;
     }
-    if (buf == NULL || len < 3)
+    if (delta == NULL)
     {
         return false;
     }
-    size_t used = 0;
-    buf[0] = '\0';
-    if (!snapshot_append_char(buf, len, &used, '{'))
+    bool full = !delta->primed;
+    delta->seq++;
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    if (!json_obj_begin(&w) || !json_kv_u32(&w, "seq", delta->seq) || !json_kv_bool(&w, "full", full))
     {
         return false;
     }
-    for (size_t i = 0; i < s_field_count; ++i)
+    size_t count = 0;
+    for (size_t i = 0; i < SNAPSHOT_FIELD_COUNT; ++i)
     {
-        if (i > 0 && !snapshot_append_char(buf, len, &used, ','))
+        const snapshot_field_t *field = &k_fields[i];
+        size_t field_start = w.used;
+        if (!json_write_key_raw(&w, field->json_key, field->json_key_len))
         {
             return false;
         }
-        if (!snapshot_append_string(buf, len, &used, s_fields[i].key))
+        size_t value_start = w.used;
+        if (!snapshot_write_value(&w, field))
         {
             return false;
         }
-        if (!snapshot_append_char(buf, len, &used, ':'))
+        uint32_t h = snapshot_hash(&buf[value_start], w.used - value_start);
+        if (!full && h == delta->field_hash[i])
         {
-            return false;
+            // The header always precedes, so the dropped field's comma goes with it.
+            json_writer_rewind(&w, field_start, true);
+            continue;
         }
-        if (!s_fields[i].value_fn(buf, len, &used))
+        delta->field_hash[i] = h;
+        count++;
+    }
+    if (!json_obj_end(&w))
+    {
+        return false;
+    }
+    delta->primed = true;
+    if (changed != NULL)
+    {
+        *changed = count;
+    }
+    return true;
+}
+
+bool snapshot_build_cbor(uint8_t *buf, size_t len, size_t *out_len)
+{
+    if (out_len != NULL)
+    {
+        *out_len = 0;
+    }
+    if (buf == NULL)
+    {
+        return false;
+    }
+    cbor_writer_t w;
+    cbor_writer_init(&w, buf, len);
+    if (!cbor_write_map(&w, SNAPSHOT_FIELD_COUNT))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < SNAPSHOT_FIELD_COUNT; ++i)
+    {
+        const snapshot_field_t *field = &k_fields[i];
+        if (!cbor_write_text_n(&w, field->key, field->key_len) || !field->cbor_fn(&w))
         {
             return false;
         }
     }
-    return snapshot_append_char(buf, len, &used, '}');
+    if (out_len != NULL)
+    {
+        *out_len = w.used;
+    }
+    return true;
 }
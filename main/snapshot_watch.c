@@ -0,0 +1,168 @@
+#include "snapshot_watch.h"
+
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "diag_console.h"
+#include "snapshot.h"
+
+#define SNAPSHOT_WATCH_TASK_STACK 4096
+#define SNAPSHOT_WATCH_TASK_PRIO 2
+#define SNAPSHOT_WATCH_RECORD_MAX 1152
+
+static const char *TAG = "snapshot_watch";
+
+static TaskHandle_t s_task = NULL;
+static esp_timer_handle_t s_timer = NULL;
+static volatile bool s_active = false;
+static volatile bool s_reset_req = false;
+static uint32_t s_period_ms = 0;
+static uint32_t s_records = 0;
+static uint32_t s_missed = 0;
+static snapshot_delta_t s_delta;
+static char s_record[SNAPSHOT_WATCH_RECORD_MAX];
+
+static void snapshot_watch_on_timer(void *arg)
+{
+    (void)arg;
+    TaskHandle_t task = s_task;
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+}
+
+static void snapshot_watch_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!s_active)
+        {
+            continue;
+        }
+        // Waits out a running command, so records taken while it ran are counted as missed
+        // and the one printed afterwards reflects the state the command left behind.
+        diag_console_output_lock();
+        pending += ulTaskNotifyTake(pdTRUE, 0);
+        if (!s_active)
+        {
+            diag_console_output_unlock();
+            continue;
+        }
+        if (s_reset_req)
+        {
+            s_reset_req = false;
+            snapshot_delta_reset(&s_delta);
+        }
+        else if (pending > 1)
+        {
+            s_missed += pending - 1;
+        }
+        if (!snapshot_build_delta(&s_delta, s_record, sizeof(s_record), NULL))
+        {
+            // Tracked values may be half-updated; make the next record full again.
+            snapshot_delta_reset(&s_delta);
+            printf("{\"error\":\"snapshot_format\"}\n");
+        }
+        else
+        {
+            printf("%s\n", s_record);
+            s_records++;
+        }
+        fflush(stdout);
+        diag_console_output_unlock();
+    }
+}
+
+esp_err_t snapshot_watch_start(uint32_t period_ms)
+{
+    if (period_ms < SNAPSHOT_WATCH_MIN_PERIOD_MS || period_ms > SNAPSHOT_WATCH_MAX_PERIOD_MS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL)
+    {
+        if (xTaskCreate(snapshot_watch_task, "snap_watch", SNAPSHOT_WATCH_TASK_STACK, NULL, SNAPSHOT_WATCH_TASK_PRIO,
+                        &s_task) != pdPASS)
+        {
+            s_task = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_timer == NULL)
+    {
+        const esp_timer_create_args_t args = {
+            .callback = snapshot_watch_on_timer,
+            .name = "snap_watch",
+        };
+        esp_err_t err = esp_timer_create(&args, &s_timer);
+        if (err != ESP_OK)
+        {
+            s_timer = NULL;
+            return err;
+        }
+    }
+    if (s_active)
+    {
+        esp_timer_stop(s_timer);
+    }
+    s_period_ms = period_ms;
+    s_records = 0;
+    s_missed = 0;
+    s_reset_req = true;
+    s_active = true;
+    esp_err_t err = esp_timer_start_periodic(s_timer, (uint64_t)period_ms * 1000U);
+    if (err != ESP_OK)
+    {
+        s_active = false;
+        return err;
+    }
+    // First record right away instead of one period later.
+    xTaskNotifyGive(s_task);
+    ESP_LOGI(TAG, "watch every %u ms", (unsigned)period_ms);
+    return ESP_OK;
+}
+
+void snapshot_watch_stop(void)
+{
+    if (!s_active)
+    {
+        return;
+    }
+    s_active = false;
+    if (s_timer != NULL)
+    {
+        esp_timer_stop(s_timer);
+    }
+}
+
+bool snapshot_watch_active(void)
+{
+    return s_active;
+}
+
+bool snapshot_watch_write_json(json_writer_t *w)
+{
+    return json_obj_begin(w) &&
+           json_kv_bool(w, "active", s_active) &&
+           json_kv_u32(w, "period_ms", s_active ? s_period_ms : 0) &&
+           json_kv_u32(w, "records", s_records) &&
+           json_kv_u32(w, "missed", s_missed) &&
+           json_obj_end(w);
+}
+
+bool snapshot_watch_get_json(char *buf, size_t len)
+{
+    if (buf == NULL || len == 0)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return snapshot_watch_write_json(&w);
+}
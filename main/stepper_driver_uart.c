@@ -1,5 +1,3 @@
-
-
 // TMC2209 1-wire UART (PDN_UART) reference (KNOWN-GOOD)
 // UART: UART1 @ 115200 8N1, TX=GPIO17, RX=GPIO18
 // Wiring (critical):
@@ -26,8 +24,10 @@
 //   - rx_total==0: RX not on PDN node (wiring/junction wrong).
 //   - rx_total==4: echo only -> TMC not accepting frame (CRC/config/routing/power).
 
-
 #include "stepper_driver_uart.h"
+#include "stepper_uart_hal.h"
+#include "tmc_frame.h"
+#include "tmc2209_regs.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -37,35 +37,158 @@
 #include "motor_driver_defaults.h"
 #include "esp_log.h"
 #include "events.h"
-#include "driver/uart.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
-#define STEPPER_UART UART_NUM_1
-#define STEPPER_UART_BAUD 115200
-#define STEPPER_UART_BUF 512
-#define STEPPER_UART_TX_GPIO 17
-#define STEPPER_UART_RX_GPIO 18
 #define STEPPER_UART_DEBUG 0
 
 static const char *TAG = "stepper_uart";
 
-#define TMC_SYNC 0x05
 #define TMC_SLAVE_ADDR 0x00
+#define STEPPER_UART_PROBE_TIMEOUT_US 3000
+#define STEPPER_UART_PROBE_POLL_US 50
 
-#define TMC_REG_GSTAT 0x01
-#define TMC_REG_IHOLD_IRUN 0x10
-#define TMC_REG_DRV_STATUS 0x6F
-
-#define TMC_GCONF_EN_SPREADCYCLE (1U << 2)
 #define TMC_GSTAT_RESET_MASK 0x07
 
-static bool s_uart_ready = false;
+#ifndef STEPPER_UART_RELIABLE_WRITES_DEFAULT
+#define STEPPER_UART_RELIABLE_WRITES_DEFAULT 0
+#endif
+#define STEPPER_UART_BATCH_MAX 16
+#define STEPPER_UART_WRITE_RETRIES 3
+#define STEPPER_UART_IFCNT_ATTEMPTS 4
+#define STEPPER_UART_BACKOFF_BASE_MS 10
+#define STEPPER_UART_LOCK_TIMEOUT_MS 1000
+#define STEPPER_UART_XFER_QUEUE_LEN 8
+#define STEPPER_UART_BUS_TASK_STACK 3072
+#define STEPPER_UART_BUS_TASK_PRIO 5
+
 static uint16_t s_microsteps = MOTOR_DRIVER_DEFAULT_MICROSTEPS;
 static uint8_t s_run_current = 0;
 static uint8_t s_hold_current = 0;
 static uint8_t s_hold_delay = 0;
 static bool s_stealthchop = MOTOR_DRIVER_DEFAULT_STEALTHCHOP;
+static stepper_uart_stats_t s_stats;
+static bool s_reliable_writes = (STEPPER_UART_RELIABLE_WRITES_DEFAULT != 0);
+static uint8_t s_slave_addr = TMC_SLAVE_ADDR;
+static stepper_driver_scan_t s_scan;
+
+// Bus arbitration: one recursive lock held for every transaction or composite sequence,
+// plus a bus task that serves async transfers (motion queue before telemetry queue).
+static SemaphoreHandle_t s_bus_lock = NULL;
+static QueueHandle_t s_xfer_queue_motion = NULL;
+static QueueHandle_t s_xfer_queue_telemetry = NULL;
+static TaskHandle_t s_bus_task = NULL;
+
+// Read transaction outcome, used for per-transaction counters.
+typedef enum
+{
+    TMC_XFER_OK = 0,
+    TMC_XFER_TIMEOUT,
+    TMC_XFER_ECHO_ONLY,
+    TMC_XFER_CRC_FAIL,
+    TMC_XFER_WRONG_REG,
+} tmc_xfer_result_t;
+
+static tmc_xfer_result_t s_last_xfer = TMC_XFER_OK;
+
+// Probe reads (bus scans) expect silence from absent addresses, so they are only counted in
+// probes; the outcome counters and histogram describe real traffic to a known slave.
+static void tmc_stats_record_read(tmc_xfer_result_t result, int64_t start_us, bool probe)
+{
+    s_last_xfer = result;
+    if (probe)
+    {
+        s_stats.probes++;
+        return;
+    }
+    int64_t elapsed = esp_timer_get_time() - start_us;
+    uint32_t lat_us = (elapsed > 0) ? (uint32_t)elapsed : 0;
+    s_stats.reads++;
+    switch (result)
+    {
+    case TMC_XFER_OK:
+        s_stats.ok++;
+        break;
+    case TMC_XFER_TIMEOUT:
+        s_stats.timeout++;
+        break;
+    case TMC_XFER_ECHO_ONLY:
+        s_stats.echo_only++;
+        break;
+    case TMC_XFER_CRC_FAIL:
+        s_stats.crc_fail++;
+        break;
+    case TMC_XFER_WRONG_REG:
+        s_stats.wrong_reg++;
+        break;
+    default:
+        break;
+    }
+    if (lat_us > s_stats.lat_max_us)
+    {
+        s_stats.lat_max_us = lat_us;
+    }
+    // Bucket i counts latencies below (BASE << i); the last bucket is open-ended.
+    uint32_t scaled = lat_us / STEPPER_UART_LAT_BASE_US;
+    size_t bucket = (scaled == 0) ? 0 : (size_t)(32 - __builtin_clz(scaled));
+    if (bucket >= STEPPER_UART_LAT_BUCKETS)
+    {
+        bucket = STEPPER_UART_LAT_BUCKETS - 1;
+    }
+    s_stats.lat_hist[bucket]++;
+}
+
+// Placeholder transport until a real one is installed: every op fails, so transfers report
+// ESP_ERR_INVALID_STATE instead of touching an unconfigured UART.
+static esp_err_t tmc_hal_none_flush_input(void)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+static int tmc_hal_none_write(const uint8_t *data, size_t len)
+{
+    return -1;
+}
+
+static int tmc_hal_none_read(uint8_t *buf, size_t len, TickType_t timeout_ticks)
+{
+    return -1;
+}
+
+static esp_err_t tmc_hal_none_wait_tx_done(TickType_t timeout_ticks)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+static const stepper_uart_hal_t k_hal_none = {
+    .name = "none",
+    .flush_input = tmc_hal_none_flush_input,
+    .write = tmc_hal_none_write,
+    .read = tmc_hal_none_read,
+    .wait_tx_done = tmc_hal_none_wait_tx_done,
+};
+
+// s_default_hal is what stepper_uart_set_hal(NULL) restores (UART1 once it is initialized).
+static const stepper_uart_hal_t *s_default_hal = &k_hal_none;
+static const stepper_uart_hal_t *s_hal = &k_hal_none;
+
+static bool tmc_transport_ready(void)
+{
+    return s_hal != &k_hal_none;
+}
+
+// Busy-wait between non-blocking probe polls; a tick-based delay would stretch each probe
+// well past STEPPER_UART_PROBE_TIMEOUT_US.
+static void tmc_delay_us(uint32_t us)
+{
+    const int64_t until_us = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < until_us)
+    {
+    }
+}
 
 static void format_hex_bytes(const uint8_t *data, size_t len, char *out, size_t out_len)
 {
@@ -90,41 +213,19 @@ static void format_hex_bytes(const uint8_t *data, size_t len, char *out, size_t
     }
 }
 
-static uint8_t tmc_crc(const uint8_t *data, size_t len)
-{
-    uint8_t crc = 0;
-    for (size_t i = 0; i < len; ++i)
-    {
-        uint8_t cur = data[i];
-        for (int bit = 0; bit < 8; ++bit)
-        {
-            if (((crc >> 7) ^ (cur & 0x01)) != 0)
-            {
-                crc = (uint8_t)((crc << 1) ^ 0x07);
-            }
-            else
-            {
-                crc <<= 1;
-            }
-            cur >>= 1;
-        }
-    }
-    return crc;
-}
-
 static esp_err_t tmc_uart_write(const uint8_t *data, size_t len)
 {
-    if (!s_uart_ready)
+    if (!tmc_transport_ready())
     {
         return ESP_ERR_INVALID_STATE;
     }
-    esp_err_t err = uart_flush_input(STEPPER_UART);
+    esp_err_t err = s_hal->flush_input();
     if (err != ESP_OK)
     {
         ESP_LOGE(TAG, "uart_flush_input failed: %s", esp_err_to_name(err));
         return err;
     }
-    int written = uart_write_bytes(STEPPER_UART, data, len);
+    int written = s_hal->write(data, len);
     if (written != (int)len)
     {
         return ESP_FAIL;
@@ -138,7 +239,7 @@ static void tmc_uart_drain_rx(TickType_t max_ticks)
     TickType_t start = xTaskGetTickCount();
     while ((xTaskGetTickCount() - start) < max_ticks)
     {
-        int read = uart_read_bytes(STEPPER_UART, dump, sizeof(dump), 1);
+        int read = s_hal->read(dump, sizeof(dump), 1);
         if (read <= 0)
         {
             break;
@@ -146,56 +247,53 @@ static void tmc_uart_drain_rx(TickType_t max_ticks)
     }
 }
 
-static bool tmc_find_reply(const uint8_t *rx, size_t total, uint8_t reg, const uint8_t **reply_out)
+// Probe mode (probe_timeout_us > 0): poll without blocking until a valid reply is in or the
+// deadline passes, and stay quiet on failure. Used where absent slaves are expected.
+static size_t tmc_uart_probe_reply(uint8_t *rx, size_t cap, uint8_t reg, uint32_t probe_timeout_us)
 {
-    if (rx == NULL || reply_out == NULL || total < 8)
+    size_t total = 0;
+    const int64_t deadline_us = esp_timer_get_time() + probe_timeout_us;
+    while (total < cap)
     {
-        return false;
-    }
-    const uint8_t reg_masked = (uint8_t)(reg & 0x7F);
-    const uint8_t *reply = NULL;
-    for (size_t i = 0; i + 8 <= total; ++i)
-    {
-        const uint8_t *cand = &rx[i];
-        if (cand[0] != TMC_SYNC || cand[1] != 0xFF)
-        {
-            continue;
-        }
-        if ((cand[2] & 0x7F) != reg_masked)
+        // Sample the clock before reading, so a reply that arrived while this task was
+        // preempted past the deadline is still collected by the last read.
+        const bool expired = (esp_timer_get_time() >= deadline_us);
+        int more = s_hal->read(rx + total, cap - total, 0);
+        if (more <= 0)
         {
+            if (expired)
+            {
+                break;
+            }
+            tmc_delay_us(STEPPER_UART_PROBE_POLL_US);
             continue;
         }
-        uint8_t crc = tmc_crc(cand, 7);
-        if (crc != cand[7])
+        total += (size_t)more;
+        const uint8_t *resp = NULL;
+        if (total >= TMC_FRAME_REPLY_LEN && tmc_frame_decode_reply(rx, total, reg, &resp) == TMC_FRAME_OK)
         {
-            continue;
+            break;
         }
-        reply = cand;
-    }
-    if (reply == NULL)
-    {
-        return false;
     }
-    *reply_out = reply;
-    return true;
+    return total;
 }
 
-static esp_err_t tmc_read_reg_addr(uint8_t addr, uint8_t reg, uint32_t *out, bool emit_events)
+static esp_err_t tmc_read_reg_xfer(uint8_t addr, uint8_t reg, uint32_t *out, uint32_t probe_timeout_us)
 {
     if (out == NULL)
     {
         return ESP_ERR_INVALID_ARG;
     }
-    (void)emit_events;
-    uint8_t req[4] = {TMC_SYNC, addr, (uint8_t)(reg & 0x7F), 0};
-    req[3] = tmc_crc(req, 3);
+    const bool quiet = (probe_timeout_us > 0);
+    uint8_t req[TMC_FRAME_READ_REQ_LEN];
+    tmc_frame_encode_read(req, addr, reg);
+    const int64_t xfer_start_us = esp_timer_get_time();
     esp_err_t err = tmc_uart_write(req, sizeof(req));
     if (err != ESP_OK)
     {
         return err;
     }
-    uart_wait_tx_done(STEPPER_UART, pdMS_TO_TICKS(20));
-    vTaskDelay(pdMS_TO_TICKS(2));
+    s_hal->wait_tx_done(pdMS_TO_TICKS(20));
 #if STEPPER_UART_DEBUG
     {
         char tx_hex[32];
@@ -206,32 +304,40 @@ static esp_err_t tmc_read_reg_addr(uint8_t addr, uint8_t reg, uint32_t *out, boo
 
     // RX can be 8-byte reply-only, or 12-byte (4-byte echo + 8-byte reply).
     uint8_t rx[12] = {0};
-    const TickType_t timeout_ticks = pdMS_TO_TICKS(10);
-    const TickType_t read_timeout_ticks = pdMS_TO_TICKS(10);
-    const TickType_t overall_timeout_ticks = pdMS_TO_TICKS(50);
-    TickType_t start_ticks = xTaskGetTickCount();
-    int read = uart_read_bytes(STEPPER_UART, rx, sizeof(rx), timeout_ticks);
-    size_t rx_len = (read > 0) ? (size_t)read : 0;
-#if STEPPER_UART_DEBUG
-    if (rx_len > 0)
+    size_t total = 0;
+    if (quiet)
     {
-        char rx_hex[48];
-        format_hex_bytes(rx, rx_len, rx_hex, sizeof(rx_hex));
-        ESP_LOGD(TAG, "rx len=%d timeout_ticks=%u data=%s", read, (unsigned)timeout_ticks, rx_hex);
+        total = tmc_uart_probe_reply(rx, sizeof(rx), reg, probe_timeout_us);
     }
-#endif
-    size_t total = rx_len;
-    while (total < sizeof(rx))
+    else
     {
-        TickType_t now = xTaskGetTickCount();
-        if ((now - start_ticks) >= overall_timeout_ticks)
+        vTaskDelay(pdMS_TO_TICKS(2));
+        const TickType_t timeout_ticks = pdMS_TO_TICKS(10);
+        const TickType_t read_timeout_ticks = pdMS_TO_TICKS(10);
+        const TickType_t overall_timeout_ticks = pdMS_TO_TICKS(50);
+        TickType_t start_ticks = xTaskGetTickCount();
+        int read = s_hal->read(rx, sizeof(rx), timeout_ticks);
+        total = (read > 0) ? (size_t)read : 0;
+#if STEPPER_UART_DEBUG
+        if (total > 0)
         {
-            break;
+            char rx_hex[48];
+            format_hex_bytes(rx, total, rx_hex, sizeof(rx_hex));
+            ESP_LOGD(TAG, "rx len=%d timeout_ticks=%u data=%s", read, (unsigned)timeout_ticks, rx_hex);
         }
-        int more = uart_read_bytes(STEPPER_UART, rx + total, sizeof(rx) - total, read_timeout_ticks);
-        if (more > 0)
+#endif
+        while (total < sizeof(rx))
         {
-            total += (size_t)more;
+            TickType_t now = xTaskGetTickCount();
+            if ((now - start_ticks) >= overall_timeout_ticks)
+            {
+                break;
+            }
+            int more = s_hal->read(rx + total, sizeof(rx) - total, read_timeout_ticks);
+            if (more > 0)
+            {
+                total += (size_t)more;
+            }
         }
     }
 #if STEPPER_UART_DEBUG
@@ -246,87 +352,153 @@ static esp_err_t tmc_read_reg_addr(uint8_t addr, uint8_t reg, uint32_t *out, boo
     {
         if (total > 0)
         {
-            char rx_hex[48];
-            size_t dump_len = (total > 16) ? 16 : total;
-            format_hex_bytes(rx, dump_len, rx_hex, sizeof(rx_hex));
-            ESP_LOGE(TAG, "reply_invalid rx_len=%u data=%s", (unsigned)total, rx_hex);
+            if (!quiet)
+            {
+                char rx_hex[48];
+                size_t dump_len = (total > 16) ? 16 : total;
+                format_hex_bytes(rx, dump_len, rx_hex, sizeof(rx_hex));
+                ESP_LOGE(TAG, "reply_invalid rx_len=%u data=%s", (unsigned)total, rx_hex);
+            }
+            tmc_stats_record_read(TMC_XFER_ECHO_ONLY, xfer_start_us, quiet);
             return ESP_ERR_INVALID_RESPONSE;
         }
-        ESP_LOGE(TAG, "rx_len=%u", (unsigned)total);
+        if (!quiet)
+        {
+            ESP_LOGE(TAG, "rx_len=%u", (unsigned)total);
+        }
+        tmc_stats_record_read(TMC_XFER_TIMEOUT, xfer_start_us, quiet);
         return ESP_ERR_TIMEOUT;
     }
     const uint8_t *resp = NULL;
-    if (!tmc_find_reply(rx, total, reg, &resp))
+    tmc_frame_status_t frame_status = tmc_frame_decode_reply(rx, total, reg, &resp);
+    if (frame_status != TMC_FRAME_OK)
     {
-        char rx_hex[48];
-        size_t dump_len = (total > 16) ? 16 : total;
-        format_hex_bytes(rx, dump_len, rx_hex, sizeof(rx_hex));
-        ESP_LOGE(TAG, "reply_invalid rx_len=%u data=%s", (unsigned)total, rx_hex);
+        if (!quiet)
+        {
+            char rx_hex[48];
+            size_t dump_len = (total > 16) ? 16 : total;
+            format_hex_bytes(rx, dump_len, rx_hex, sizeof(rx_hex));
+            ESP_LOGE(TAG, "reply_invalid rx_len=%u data=%s", (unsigned)total, rx_hex);
+        }
+        tmc_stats_record_read((frame_status == TMC_FRAME_WRONG_REG) ? TMC_XFER_WRONG_REG : TMC_XFER_CRC_FAIL,
+                              xfer_start_us, quiet);
         return ESP_ERR_INVALID_RESPONSE;
     }
 #if STEPPER_UART_DEBUG
     ESP_LOGD(TAG, "reply_ok reg=0x%02X data=%02X %02X %02X %02X",
              resp[2], resp[3], resp[4], resp[5], resp[6]);
 #endif
-    *out = ((uint32_t)resp[3] << 24) |
-           ((uint32_t)resp[4] << 16) |
-           ((uint32_t)resp[5] << 8) |
-           ((uint32_t)resp[6]);
+    *out = tmc_frame_reply_value(resp);
+    tmc_stats_record_read(TMC_XFER_OK, xfer_start_us, quiet);
     return ESP_OK;
 }
 
+static esp_err_t tmc_read_reg_addr(uint8_t addr, uint8_t reg, uint32_t *out)
+{
+    return tmc_read_reg_xfer(addr, reg, out, 0);
+}
+
 static esp_err_t tmc_read_reg(uint8_t reg, uint32_t *out)
 {
-    return tmc_read_reg_addr(TMC_SLAVE_ADDR, reg, out, true);
+    return tmc_read_reg_addr(s_slave_addr, reg, out);
 }
 
-esp_err_t stepper_uart_read_reg(uint8_t slave, uint8_t reg, uint32_t *out)
+static esp_err_t tmc_uart_read_reg_locked(uint8_t slave, uint8_t reg, uint32_t *out)
 {
-    return tmc_read_reg_addr(slave, reg, out, false);
+    return tmc_read_reg_addr(slave, reg, out);
 }
 
+// The only raw write path: batches, verified writes and unbatched writes all go through here
+// so every frame gets the same echo handling (wait for TX, drop the echo, drain stragglers).
 static esp_err_t tmc_write_reg_addr(uint8_t addr, uint8_t reg, uint32_t value)
 {
-    uint8_t req[8] = {
-        TMC_SYNC,
-        addr,
-        (uint8_t)(reg | 0x80),
-        (uint8_t)((value >> 24) & 0xFF),
-        (uint8_t)((value >> 16) & 0xFF),
-        (uint8_t)((value >> 8) & 0xFF),
-        (uint8_t)(value & 0xFF),
-        0};
-    req[7] = tmc_crc(req, 7);
+    uint8_t req[TMC_FRAME_WRITE_REQ_LEN];
+    tmc_frame_encode_write(req, addr, reg, value);
     esp_err_t err = tmc_uart_write(req, sizeof(req));
     if (err != ESP_OK)
     {
         return err;
     }
-    uart_wait_tx_done(STEPPER_UART, pdMS_TO_TICKS(20));
-    vTaskDelay(pdMS_TO_TICKS(2));
+    s_stats.writes++;
+    s_hal->wait_tx_done(pdMS_TO_TICKS(20));
+    err = s_hal->flush_input();
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "uart_flush_input failed: %s", esp_err_to_name(err));
+        return err;
+    }
     tmc_uart_drain_rx(pdMS_TO_TICKS(5));
     return ESP_OK;
 }
 
-static void tmc_log_addr_scan(uint8_t reg)
+// Probes every address with IOIN (a read-only register every TMC2209 answers), then IFCNT
+// for the ones that reply. Only an explicit scan (adopt) makes the lowest responding address
+// the default slave and updates the cached result; the diagnostic scan after a failed ping
+// leaves the addressing alone.
+static void tmc_scan_locked(stepper_driver_scan_t *out, bool adopt)
 {
-    uint32_t val = 0;
-    bool found = false;
-    for (uint8_t addr = 0; addr < 4; ++addr)
+    memset(out, 0, sizeof(*out));
+    const int64_t start_us = esp_timer_get_time();
+    for (uint8_t addr = 0; addr < STEPPER_TMC_MAX_SLAVES; ++addr)
     {
-        if (tmc_read_reg_addr(addr, reg, &val, false) == ESP_OK)
+        stepper_driver_slave_info_t *slave = &out->slaves[addr];
+        uint32_t ioin = 0;
+        if (tmc_read_reg_xfer(addr, TMC2209_REG_IOIN, &ioin, STEPPER_UART_PROBE_TIMEOUT_US) != ESP_OK)
+        {
+            continue;
+        }
+        slave->present = true;
+        slave->version = (uint8_t)TMC2209_FIELD_GET(ioin, IOIN, VERSION);
+        uint32_t ifcnt = 0;
+        slave->ifcnt_ok = (tmc_read_reg_xfer(addr, TMC2209_REG_IFCNT, &ifcnt, STEPPER_UART_PROBE_TIMEOUT_US) == ESP_OK);
+        slave->ifcnt = (uint8_t)TMC2209_FIELD_GET(ifcnt, IFCNT, IFCNT);
+        if (out->count == 0)
+        {
+            out->active = addr;
+        }
+        out->count++;
+    }
+    int64_t elapsed = esp_timer_get_time() - start_us;
+    out->elapsed_us = (elapsed > 0) ? (uint32_t)elapsed : 0;
+    out->valid = true;
+    if (!adopt)
+    {
+        return;
+    }
+    if (out->count > 0 && out->active != s_slave_addr)
+    {
+        ESP_LOGI(TAG, "slave address %u -> %u", (unsigned)s_slave_addr, (unsigned)out->active);
+        s_slave_addr = out->active;
+        events_emit("driver_uart", "motor", out->active, "addr_set");
+    }
+    s_scan = *out;
+}
+
+// After a failed ping: report who answers, but keep talking to the configured address so a
+// bus glitch or a second driver cannot silently redirect later writes.
+static void tmc_log_addr_scan(void)
+{
+    stepper_driver_scan_t scan;
+    tmc_scan_locked(&scan, false);
+    for (uint8_t addr = 0; addr < STEPPER_TMC_MAX_SLAVES; ++addr)
+    {
+        if (scan.slaves[addr].present)
         {
             events_emit("driver_uart", "motor", addr, "addr_ok");
-            found = true;
         }
     }
-    if (!found)
+    if (scan.count == 0)
     {
         events_emit("driver_uart", "motor", 255, "addr_none");
     }
+    else if (!scan.slaves[s_slave_addr].present)
+    {
+        ESP_LOGW(TAG, "no reply at slave address %u; run `motor driver scan` to switch",
+                 (unsigned)s_slave_addr);
+    }
 }
 
-esp_err_t stepper_uart_write_reg(uint8_t slave, uint8_t reg, uint32_t val)
+static esp_err_t tmc_uart_write_reg_locked(uint8_t slave, uint8_t reg, uint32_t val)
 {
     esp_err_t err = tmc_write_reg_addr(slave, reg, val);
     if (err != ESP_OK)
@@ -334,7 +506,7 @@ esp_err_t stepper_uart_write_reg(uint8_t slave, uint8_t reg, uint32_t val)
         return err;
     }
     uint32_t verify = 0;
-    err = tmc_read_reg_addr(slave, reg, &verify, false);
+    err = tmc_read_reg_addr(slave, reg, &verify);
     if (err != ESP_OK)
     {
         return err;
@@ -342,10 +514,10 @@ esp_err_t stepper_uart_write_reg(uint8_t slave, uint8_t reg, uint32_t val)
     return ESP_OK;
 }
 
-esp_err_t stepper_uart_ensure_gconf_uart_mode(uint8_t slave)
+static esp_err_t tmc_ensure_gconf_uart_mode_locked(uint8_t slave)
 {
     uint32_t gconf = 0;
-    esp_err_t err = stepper_uart_read_reg(slave, STEPPER_TMC_REG_GCONF, &gconf);
+    esp_err_t err = tmc_uart_read_reg_locked(slave, STEPPER_TMC_REG_GCONF, &gconf);
     if (err != ESP_OK)
     {
         return err;
@@ -354,14 +526,14 @@ esp_err_t stepper_uart_ensure_gconf_uart_mode(uint8_t slave)
     new_gconf &= ~STEPPER_TMC_GCONF_I_SCALE_ANALOG;
     if (new_gconf != gconf)
     {
-        err = stepper_uart_write_reg(slave, STEPPER_TMC_REG_GCONF, new_gconf);
+        err = tmc_uart_write_reg_locked(slave, STEPPER_TMC_REG_GCONF, new_gconf);
         if (err != ESP_OK)
         {
             return err;
         }
     }
     uint32_t verify = 0;
-    err = stepper_uart_read_reg(slave, STEPPER_TMC_REG_GCONF, &verify);
+    err = tmc_uart_read_reg_locked(slave, STEPPER_TMC_REG_GCONF, &verify);
     if (err != ESP_OK)
     {
         return err;
@@ -382,34 +554,156 @@ esp_err_t stepper_uart_ensure_gconf_uart_mode(uint8_t slave)
     return ESP_OK;
 }
 
-static esp_err_t tmc_write_reg(uint8_t reg, uint32_t value)
+// Plain RW registers read back the last written value, so a lost write shows up on readback.
+static bool tmc_reg_reads_back(uint8_t reg)
 {
-    uint8_t req[8] = {
-        TMC_SYNC,
-        TMC_SLAVE_ADDR,
-        (uint8_t)(reg | 0x80),
-        (uint8_t)((value >> 24) & 0xFF),
-        (uint8_t)((value >> 16) & 0xFF),
-        (uint8_t)((value >> 8) & 0xFF),
-        (uint8_t)(value & 0xFF),
-        0};
-    req[7] = tmc_crc(req, 7);
-    esp_err_t err = tmc_uart_write(req, sizeof(req));
+    const tmc2209_reg_t *info = tmc2209_reg_find(reg);
+    return (info != NULL && info->access == TMC2209_RW);
+}
+
+static void tmc_backoff(uint32_t attempt)
+{
+    TickType_t ticks = pdMS_TO_TICKS(STEPPER_UART_BACKOFF_BASE_MS << attempt);
+    vTaskDelay((ticks > 0) ? ticks : 1);
+}
+
+// IFCNT read that backs off and retries on corrupted replies; timeouts fail fast.
+static esp_err_t tmc_read_ifcnt_backoff(uint8_t addr, uint8_t *out)
+{
+    esp_err_t err = ESP_FAIL;
+    for (uint32_t attempt = 0; attempt < STEPPER_UART_IFCNT_ATTEMPTS; ++attempt)
+    {
+        uint32_t val = 0;
+        err = tmc_read_reg_addr(addr, STEPPER_TMC_REG_IFCNT, &val);
+        if (err == ESP_OK)
+        {
+            *out = (uint8_t)(val & 0xFF);
+            return ESP_OK;
+        }
+        if (s_last_xfer != TMC_XFER_CRC_FAIL && s_last_xfer != TMC_XFER_WRONG_REG)
+        {
+            return err;
+        }
+        s_stats.backoffs++;
+        s_stats.retries++;
+        tmc_backoff(attempt);
+    }
+    return err;
+}
+
+// Single write confirmed by its own IFCNT increment; used only to recover lost batch writes.
+static esp_err_t tmc_write_verified(uint8_t addr, uint8_t reg, uint32_t value)
+{
+    esp_err_t err = ESP_ERR_INVALID_RESPONSE;
+    for (uint32_t attempt = 0; attempt < STEPPER_UART_WRITE_RETRIES; ++attempt)
+    {
+        uint8_t before = 0;
+        uint8_t after = 0;
+        err = tmc_read_ifcnt_backoff(addr, &before);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        err = tmc_write_reg_addr(addr, reg, value);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        err = tmc_read_ifcnt_backoff(addr, &after);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        if ((uint8_t)(after - before) == 1)
+        {
+            return ESP_OK;
+        }
+        s_stats.retries++;
+        tmc_backoff(attempt);
+        err = ESP_ERR_INVALID_RESPONSE;
+    }
+    return err;
+}
+
+static esp_err_t tmc_write_batch_locked(uint8_t slave, const stepper_uart_write_t *writes, size_t count)
+{
+    if (writes == NULL || count == 0 || count > STEPPER_UART_BATCH_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t before = 0;
+    uint8_t after = 0;
+    esp_err_t err = tmc_read_ifcnt_backoff(slave, &before);
     if (err != ESP_OK)
     {
         return err;
     }
-    uart_wait_tx_done(STEPPER_UART, pdMS_TO_TICKS(20));
-    err = uart_flush_input(STEPPER_UART);
+    for (size_t i = 0; i < count; ++i)
+    {
+        err = tmc_write_reg_addr(slave, writes[i].reg, writes[i].value);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+    err = tmc_read_ifcnt_backoff(slave, &after);
     if (err != ESP_OK)
     {
-        ESP_LOGE(TAG, "uart_flush_input failed: %s", esp_err_to_name(err));
         return err;
     }
-    tmc_uart_drain_rx(pdMS_TO_TICKS(5));
+    s_stats.batches++;
+    // count <= STEPPER_UART_BATCH_MAX, so the 8-bit IFCNT delta cannot wrap within a batch.
+    // More increments than writes (another master on the bus) still means ours all landed.
+    const size_t landed = (uint8_t)(after - before);
+    if (landed >= count)
+    {
+        return ESP_OK;
+    }
+    // IFCNT only says how many writes were lost, not which. Registers that read back are
+    // compared; write-only registers are resent (TMC2209 writes are idempotent).
+    const size_t lost = count - landed;
+    s_stats.write_lost += (uint32_t)lost;
+    events_emit("driver_uart", "motor", (int)lost, "write_lost");
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (tmc_reg_reads_back(writes[i].reg))
+        {
+            uint32_t readback = 0;
+            err = tmc_read_reg_addr(slave, writes[i].reg, &readback);
+            if (err == ESP_OK && readback == writes[i].value)
+            {
+                continue;
+            }
+        }
+        err = tmc_write_verified(slave, writes[i].reg, writes[i].value);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
     return ESP_OK;
 }
 
+void stepper_driver_set_reliable_writes(bool enable)
+{
+    s_reliable_writes = enable;
+}
+
+bool stepper_driver_get_reliable_writes(void)
+{
+    return s_reliable_writes;
+}
+
+static esp_err_t tmc_write_reg(uint8_t reg, uint32_t value)
+{
+    if (s_reliable_writes)
+    {
+        const stepper_uart_write_t write = {.reg = reg, .value = value};
+        return tmc_write_batch_locked(s_slave_addr, &write, 1);
+    }
+    return tmc_write_reg_addr(s_slave_addr, reg, value);
+}
+
 static bool mres_from_microsteps(uint16_t microsteps, uint8_t *out)
 {
     switch (microsteps)
@@ -436,63 +730,192 @@ static uint16_t microsteps_from_mres(uint8_t mres)
     return (uint16_t)(256U >> mres);
 }
 
-esp_err_t stepper_driver_uart_init(void)
+bool stepper_uart_bus_acquire(uint32_t timeout_ms)
 {
-    uart_config_t cfg = {
-        .baud_rate = STEPPER_UART_BAUD,
-        .data_bits = UART_DATA_8_BITS,
-        .parity = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .source_clk = UART_SCLK_DEFAULT,
-    };
-    esp_err_t err = uart_param_config(STEPPER_UART, &cfg);
-    if (err != ESP_OK)
+    if (s_bus_lock == NULL)
     {
-        ESP_LOGE(TAG, "uart_param_config failed: %s", esp_err_to_name(err));
-        return err;
+        // stepper_uart_bus_init() has not run (or failed): nothing may touch the bus.
+        return false;
     }
-    const int tx_pin = STEPPER_UART_TX_GPIO;
-    const int rx_pin = STEPPER_UART_RX_GPIO;
-    err = uart_set_pin(STEPPER_UART,
-                       tx_pin,
-                       rx_pin,
-                       UART_PIN_NO_CHANGE,
-                       UART_PIN_NO_CHANGE);
-    if (err != ESP_OK)
+    return (xSemaphoreTakeRecursive(s_bus_lock, pdMS_TO_TICKS(timeout_ms)) == pdTRUE);
+}
+
+void stepper_uart_bus_release(void)
+{
+    if (s_bus_lock != NULL)
     {
-        ESP_LOGE(TAG, "uart_set_pin failed: %s", esp_err_to_name(err));
-        return err;
+        xSemaphoreGiveRecursive(s_bus_lock);
     }
-    err = uart_driver_install(STEPPER_UART, STEPPER_UART_BUF, 0, 0, NULL, 0);
+}
+
+static bool tmc_hal_valid(const stepper_uart_hal_t *hal)
+{
+    return hal->flush_input != NULL && hal->write != NULL && hal->read != NULL && hal->wait_tx_done != NULL;
+}
+
+esp_err_t stepper_uart_set_hal(const stepper_uart_hal_t *hal)
+{
+    esp_err_t err = stepper_uart_bus_init();
     if (err != ESP_OK)
     {
-        ESP_LOGE(TAG, "uart_driver_install failed: %s", esp_err_to_name(err));
         return err;
     }
-    err = uart_set_rx_timeout(STEPPER_UART, 2);
-    if (err != ESP_OK)
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
     {
-        ESP_LOGE(TAG, "uart_set_rx_timeout failed: %s", esp_err_to_name(err));
-        return err;
+        return ESP_ERR_TIMEOUT;
+    }
+    if (hal == NULL)
+    {
+        hal = s_default_hal;
     }
-    err = uart_flush_input(STEPPER_UART);
+    if (!tmc_hal_valid(hal))
+    {
+        stepper_uart_bus_release();
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_hal = hal;
+    stepper_uart_bus_release();
+    ESP_LOGI(TAG, "transport=%s", hal->name);
+    return ESP_OK;
+}
+
+esp_err_t stepper_uart_set_default_hal(const stepper_uart_hal_t *hal)
+{
+    if (hal == NULL || !tmc_hal_valid(hal))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = stepper_uart_bus_init();
     if (err != ESP_OK)
     {
-        ESP_LOGE(TAG, "uart_flush_input failed: %s", esp_err_to_name(err));
         return err;
     }
-    ESP_LOGD(TAG, "UART%d init baud=%d tx=%d rx=%d rxbuf=%d",
-             (int)STEPPER_UART,
-             STEPPER_UART_BAUD,
-             tx_pin,
-             rx_pin,
-             STEPPER_UART_BUF);
-    s_uart_ready = true;
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    // An override installed before the default (e.g. the simulator) stays active.
+    if (s_hal == s_default_hal)
+    {
+        s_hal = hal;
+    }
+    s_default_hal = hal;
+    stepper_uart_bus_release();
     return ESP_OK;
 }
 
-esp_err_t stepper_driver_read_ifcnt(uint8_t *out)
+const stepper_uart_hal_t *stepper_uart_get_hal(void)
+{
+    return s_hal;
+}
+
+static void tmc_bus_execute(stepper_uart_xfer_t *xfer)
+{
+    esp_err_t err = ESP_ERR_TIMEOUT;
+    if (stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        if (xfer->op == STEPPER_UART_OP_READ)
+        {
+            err = tmc_read_reg_addr(xfer->slave, xfer->reg, &xfer->value);
+        }
+        else if (s_reliable_writes)
+        {
+            const stepper_uart_write_t write = {.reg = xfer->reg, .value = xfer->value};
+            err = tmc_write_batch_locked(xfer->slave, &write, 1);
+        }
+        else
+        {
+            err = tmc_write_reg_addr(xfer->slave, xfer->reg, xfer->value);
+        }
+        stepper_uart_bus_release();
+    }
+    // Copy completion targets first: the owner may reuse xfer once the callback runs.
+    stepper_uart_done_cb_t done_cb = xfer->done_cb;
+    void *ctx = xfer->ctx;
+    TaskHandle_t notify_task = xfer->notify_task;
+    xfer->result = err;
+    if (done_cb != NULL)
+    {
+        done_cb(xfer, ctx);
+    }
+    if (notify_task != NULL)
+    {
+        xTaskNotifyGive(notify_task);
+    }
+}
+
+static void tmc_bus_task(void *arg)
+{
+    (void)arg;
+    while (true)
+    {
+        stepper_uart_xfer_t *xfer = NULL;
+        // Re-check the motion queue before every transfer so queued telemetry never delays it
+        // by more than the one frame already on the wire.
+        if (xQueueReceive(s_xfer_queue_motion, &xfer, 0) != pdTRUE &&
+            xQueueReceive(s_xfer_queue_telemetry, &xfer, 0) != pdTRUE)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        tmc_bus_execute(xfer);
+    }
+}
+
+esp_err_t stepper_uart_bus_init(void)
+{
+    if (s_bus_task != NULL)
+    {
+        return ESP_OK;
+    }
+    // Each object is created once, so a retry after a partial failure does not leak.
+    if (s_bus_lock == NULL)
+    {
+        s_bus_lock = xSemaphoreCreateRecursiveMutex();
+    }
+    if (s_xfer_queue_motion == NULL)
+    {
+        s_xfer_queue_motion = xQueueCreate(STEPPER_UART_XFER_QUEUE_LEN, sizeof(stepper_uart_xfer_t *));
+    }
+    if (s_xfer_queue_telemetry == NULL)
+    {
+        s_xfer_queue_telemetry = xQueueCreate(STEPPER_UART_XFER_QUEUE_LEN, sizeof(stepper_uart_xfer_t *));
+    }
+    if (s_bus_lock == NULL || s_xfer_queue_motion == NULL || s_xfer_queue_telemetry == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(tmc_bus_task, "tmc_bus", STEPPER_UART_BUS_TASK_STACK, NULL,
+                    STEPPER_UART_BUS_TASK_PRIO, &s_bus_task) != pdPASS)
+    {
+        s_bus_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t stepper_uart_submit(stepper_uart_xfer_t *xfer)
+{
+    if (xfer == NULL || (xfer->op != STEPPER_UART_OP_READ && xfer->op != STEPPER_UART_OP_WRITE))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_bus_task == NULL || !tmc_transport_ready())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    QueueHandle_t queue = (xfer->prio == STEPPER_UART_PRIO_MOTION) ? s_xfer_queue_motion
+                                                                    : s_xfer_queue_telemetry;
+    xfer->result = ESP_ERR_NOT_FINISHED;
+    if (xQueueSend(queue, &xfer, 0) != pdTRUE)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(s_bus_task);
+    return ESP_OK;
+}
+
+static esp_err_t tmc_read_ifcnt_locked(uint8_t *out)
 {
     uint32_t val = 0;
     esp_err_t err = tmc_read_reg(STEPPER_TMC_REG_IFCNT, &val);
@@ -507,24 +930,25 @@ esp_err_t stepper_driver_read_ifcnt(uint8_t *out)
     return ESP_OK;
 }
 
-esp_err_t stepper_driver_ping(void)
+static esp_err_t tmc_ping_locked(void)
 {
     uint8_t ifcnt = 0;
-    if (stepper_driver_read_ifcnt(&ifcnt) == ESP_OK)
+    if (tmc_read_ifcnt_locked(&ifcnt) == ESP_OK)
     {
         events_emit("driver_uart", "motor", 0, "ok");
         return ESP_OK;
     }
-    if (stepper_driver_read_ifcnt(&ifcnt) == ESP_OK)
+    s_stats.retries++;
+    if (tmc_read_ifcnt_locked(&ifcnt) == ESP_OK)
     {
         events_emit("driver_uart", "motor", 0, "ok");
         return ESP_OK;
     }
-    tmc_log_addr_scan(STEPPER_TMC_REG_IFCNT);
+    tmc_log_addr_scan();
     return ESP_ERR_TIMEOUT;
 }
 
-esp_err_t stepper_driver_set_stealthchop(bool enable)
+static esp_err_t tmc_set_stealthchop_locked(bool enable)
 {
     uint32_t gconf = 0;
     esp_err_t err = tmc_read_reg(STEPPER_TMC_REG_GCONF, &gconf);
@@ -534,11 +958,11 @@ esp_err_t stepper_driver_set_stealthchop(bool enable)
     }
     if (enable)
     {
-        gconf &= ~TMC_GCONF_EN_SPREADCYCLE;
+        gconf = TMC2209_FIELD_SET(gconf, GCONF, EN_SPREADCYCLE, 0);
     }
     else
     {
-        gconf |= TMC_GCONF_EN_SPREADCYCLE;
+        gconf = TMC2209_FIELD_SET(gconf, GCONF, EN_SPREADCYCLE, 1);
     }
     err = tmc_write_reg(STEPPER_TMC_REG_GCONF, gconf);
     if (err != ESP_OK)
@@ -550,7 +974,7 @@ esp_err_t stepper_driver_set_stealthchop(bool enable)
     return ESP_OK;
 }
 
-esp_err_t stepper_driver_set_microsteps(uint16_t microsteps)
+static esp_err_t tmc_set_microsteps_locked(uint16_t microsteps)
 {
     uint8_t mres = 0;
     if (!mres_from_microsteps(microsteps, &mres))
@@ -558,30 +982,29 @@ esp_err_t stepper_driver_set_microsteps(uint16_t microsteps)
         return ESP_ERR_INVALID_ARG;
     }
     uint32_t chopconf = 0;
-    esp_err_t err = stepper_uart_ensure_gconf_uart_mode(TMC_SLAVE_ADDR);
+    esp_err_t err = tmc_ensure_gconf_uart_mode_locked(s_slave_addr);
     if (err != ESP_OK)
     {
         return err;
     }
-    err = stepper_uart_read_reg(TMC_SLAVE_ADDR, STEPPER_TMC_REG_CHOPCONF, &chopconf);
+    err = tmc_uart_read_reg_locked(s_slave_addr, STEPPER_TMC_REG_CHOPCONF, &chopconf);
     if (err != ESP_OK)
     {
         return err;
     }
-    chopconf &= ~(0x0F << 24);
-    chopconf |= ((uint32_t)mres << 24);
-    err = stepper_uart_write_reg(TMC_SLAVE_ADDR, STEPPER_TMC_REG_CHOPCONF, chopconf);
+    chopconf = TMC2209_FIELD_SET(chopconf, CHOPCONF, MRES, mres);
+    err = tmc_uart_write_reg_locked(s_slave_addr, STEPPER_TMC_REG_CHOPCONF, chopconf);
     if (err != ESP_OK)
     {
         return err;
     }
     uint32_t verify = 0;
-    err = stepper_uart_read_reg(TMC_SLAVE_ADDR, STEPPER_TMC_REG_CHOPCONF, &verify);
+    err = tmc_uart_read_reg_locked(s_slave_addr, STEPPER_TMC_REG_CHOPCONF, &verify);
     if (err != ESP_OK)
     {
         return err;
     }
-    uint8_t verify_mres = (uint8_t)((verify >> 24) & 0x0F);
+    uint8_t verify_mres = (uint8_t)TMC2209_FIELD_GET(verify, CHOPCONF, MRES);
     if (verify_mres != mres)
     {
         return ESP_ERR_INVALID_RESPONSE;
@@ -591,20 +1014,70 @@ esp_err_t stepper_driver_set_microsteps(uint16_t microsteps)
     return ESP_OK;
 }
 
-esp_err_t stepper_driver_set_current(uint8_t run, uint8_t hold, uint8_t hold_delay)
+// GCONF, CHOPCONF and IHOLD_IRUN go out as one batch: two reads to preserve unrelated bits,
+// three writes, and one IFCNT comparison instead of a readback per register.
+static esp_err_t tmc_apply_config_locked(const motor_driver_defaults_t *cfg)
+{
+    uint8_t mres = 0;
+    if (!mres_from_microsteps(cfg->microsteps, &mres) || cfg->run_current > 31 || cfg->hold_current > 31 ||
+        cfg->hold_delay > 15)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t gconf = 0;
+    uint32_t chopconf = 0;
+    esp_err_t err = tmc_uart_read_reg_locked(s_slave_addr, STEPPER_TMC_REG_GCONF, &gconf);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = tmc_uart_read_reg_locked(s_slave_addr, STEPPER_TMC_REG_CHOPCONF, &chopconf);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    gconf |= STEPPER_TMC_GCONF_PDN_DISABLE | STEPPER_TMC_GCONF_MSTEP_REG_SELECT;
+    gconf &= ~STEPPER_TMC_GCONF_I_SCALE_ANALOG;
+    gconf = TMC2209_FIELD_SET(gconf, GCONF, EN_SPREADCYCLE, cfg->stealthchop ? 0 : 1);
+    chopconf = TMC2209_FIELD_SET(chopconf, CHOPCONF, MRES, mres);
+    uint32_t ihold_irun = 0;
+    ihold_irun = TMC2209_FIELD_SET(ihold_irun, IHOLD_IRUN, IHOLD, cfg->hold_current);
+    ihold_irun = TMC2209_FIELD_SET(ihold_irun, IHOLD_IRUN, IRUN, cfg->run_current);
+    ihold_irun = TMC2209_FIELD_SET(ihold_irun, IHOLD_IRUN, IHOLDDELAY, cfg->hold_delay);
+    const stepper_uart_write_t writes[] = {
+        {.reg = TMC2209_REG_GCONF, .value = gconf},
+        {.reg = TMC2209_REG_CHOPCONF, .value = chopconf},
+        {.reg = TMC2209_REG_IHOLD_IRUN, .value = ihold_irun},
+    };
+    err = tmc_write_batch_locked(s_slave_addr, writes, sizeof(writes) / sizeof(writes[0]));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    s_stealthchop = cfg->stealthchop;
+    s_microsteps = cfg->microsteps;
+    s_run_current = cfg->run_current;
+    s_hold_current = cfg->hold_current;
+    s_hold_delay = cfg->hold_delay;
+    events_emit("driver_config", "motor", 0, "applied");
+    return ESP_OK;
+}
+
+static esp_err_t tmc_set_current_locked(uint8_t run, uint8_t hold, uint8_t hold_delay)
 {
     if (run > 31 || hold > 31 || hold_delay > 15)
     {
         return ESP_ERR_INVALID_ARG;
     }
-    uint32_t val = ((uint32_t)hold & 0x1F) |
-                   (((uint32_t)run & 0x1F) << 8) |
-                   (((uint32_t)hold_delay & 0x0F) << 16);
+    uint32_t val = 0;
+    val = TMC2209_FIELD_SET(val, IHOLD_IRUN, IHOLD, hold);
+    val = TMC2209_FIELD_SET(val, IHOLD_IRUN, IRUN, run);
+    val = TMC2209_FIELD_SET(val, IHOLD_IRUN, IHOLDDELAY, hold_delay);
 #if STEPPER_UART_DEBUG
     ESP_LOGD(TAG, "set_current run=%u hold=%u hold_delay=%u val=0x%08X reg=0x10",
              (unsigned)run, (unsigned)hold, (unsigned)hold_delay, (unsigned)val);
 #endif
-    esp_err_t err = tmc_write_reg(TMC_REG_IHOLD_IRUN, val);
+    esp_err_t err = tmc_write_reg(TMC2209_REG_IHOLD_IRUN, val);
     if (err != ESP_OK)
     {
         return err;
@@ -616,9 +1089,9 @@ esp_err_t stepper_driver_set_current(uint8_t run, uint8_t hold, uint8_t hold_del
     return ESP_OK;
 }
 
-esp_err_t stepper_driver_clear_faults(void)
+static esp_err_t tmc_clear_faults_locked(void)
 {
-    esp_err_t err = tmc_write_reg(TMC_REG_GSTAT, TMC_GSTAT_RESET_MASK);
+    esp_err_t err = tmc_write_reg(TMC2209_REG_GSTAT, TMC_GSTAT_RESET_MASK);
     if (err != ESP_OK)
     {
         return err;
@@ -627,106 +1100,372 @@ esp_err_t stepper_driver_clear_faults(void)
     return ESP_OK;
 }
 
-bool stepper_driver_get_status_json(char *buf, size_t len)
+static void tmc_get_status_locked(stepper_driver_status_t *out)
 {
-    if (buf == NULL || len == 0)
-    {
-        return false;
-    }
+    memset(out, 0, sizeof(*out));
     uint32_t ifcnt = 0;
     uint32_t gstat = 0;
-    uint32_t drv_status = 0;
     uint32_t chopconf = 0;
     uint32_t gconf = 0;
 
-    bool ok_ifcnt = (tmc_read_reg(STEPPER_TMC_REG_IFCNT, &ifcnt) == ESP_OK);
-    bool ok_gstat = (tmc_read_reg(TMC_REG_GSTAT, &gstat) == ESP_OK);
-    bool ok_drv = (tmc_read_reg(TMC_REG_DRV_STATUS, &drv_status) == ESP_OK);
+    out->ifcnt_valid = (tmc_read_reg(STEPPER_TMC_REG_IFCNT, &ifcnt) == ESP_OK);
+    out->gstat_valid = (tmc_read_reg(TMC2209_REG_GSTAT, &gstat) == ESP_OK);
+    out->drv_status_valid = (tmc_read_reg(TMC2209_REG_DRV_STATUS, &out->drv_status) == ESP_OK);
     bool ok_chop = (tmc_read_reg(STEPPER_TMC_REG_CHOPCONF, &chopconf) == ESP_OK);
-    bool ok_gconf = (tmc_read_reg(STEPPER_TMC_REG_GCONF, &gconf) == ESP_OK);
-
-    char ifcnt_buf[8];
-    char gstat_buf[12];
-    char drv_buf[12];
-    char micro_buf[8];
-    char run_buf[8];
-    char hold_buf[8];
-    char hold_delay_buf[8];
-    char stst_buf[8];
-    char cs_buf[8];
-    const char *ifcnt_str = "null";
-    const char *gstat_str = "null";
-    const char *drv_str = "null";
-    const char *micro_str = "null";
-    const char *run_str = "null";
-    const char *hold_str = "null";
-    const char *hold_delay_str = "null";
-    const char *stst_str = "null";
-    const char *cs_str = "null";
-    const char *stealth_str = "null";
-    const char *micro_source_str = "null";
-
-    if (ok_ifcnt)
-    {
-        snprintf(ifcnt_buf, sizeof(ifcnt_buf), "%u", (unsigned)(ifcnt & 0xFF));
-        ifcnt_str = ifcnt_buf;
-    }
-    if (ok_gstat)
-    {
-        snprintf(gstat_buf, sizeof(gstat_buf), "0x%02X", (unsigned)(gstat & 0xFF));
-        gstat_str = gstat_buf;
-    }
-    if (ok_drv)
-    {
-        snprintf(drv_buf, sizeof(drv_buf), "0x%08X", (unsigned)drv_status);
-        drv_str = drv_buf;
-    }
-    if (ok_gconf)
-    {
-        bool mstep_sel = (gconf & STEPPER_TMC_GCONF_MSTEP_REG_SELECT) != 0;
-        micro_source_str = mstep_sel ? "\"reg\"" : "\"pins\"";
-    }
-    if (ok_chop)
-    {
-        uint8_t mres = (uint8_t)((chopconf >> 24) & 0x0F);
-        uint16_t micro = microsteps_from_mres(mres);
-        if (ok_gconf && micro_source_str != NULL && strcmp(micro_source_str, "\"reg\"") == 0 && micro != 0)
+    out->stealthchop_valid = (tmc_read_reg(STEPPER_TMC_REG_GCONF, &gconf) == ESP_OK);
+
+    out->ifcnt = (uint8_t)(ifcnt & 0xFF);
+    out->gstat = (uint8_t)(gstat & 0xFF);
+    // microsteps is only meaningful when MRES (not the MS pins) selects the resolution.
+    if (ok_chop && out->stealthchop_valid && (gconf & STEPPER_TMC_GCONF_MSTEP_REG_SELECT) != 0)
+    {
+        out->microsteps = microsteps_from_mres((uint8_t)TMC2209_FIELD_GET(chopconf, CHOPCONF, MRES));
+    }
+    if (out->drv_status_valid)
+    {
+        tmc2209_drv_status_t drv;
+        tmc2209_decode_drv_status(out->drv_status, &drv);
+        out->stst = drv.stst;
+        out->cs_actual = drv.cs_actual;
+    }
+    if (out->stealthchop_valid)
+    {
+        out->stealthchop = (TMC2209_FIELD_GET(gconf, GCONF, EN_SPREADCYCLE) == 0);
+    }
+    out->run_current_cmd = s_run_current;
+    out->hold_current_cmd = s_hold_current;
+    out->hold_delay_cmd = s_hold_delay;
+}
+
+bool stepper_driver_write_status_json(const stepper_driver_status_t *st, json_writer_t *w)
+{
+    if (st == NULL)
+    {
+        return false;
+    }
+    // gstat/drv_status keep their historical unquoted hex form; hosts parse them with base 0.
+    return json_obj_begin(w) &&
+           (st->ifcnt_valid ? json_kv_u32(w, "ifcnt", st->ifcnt) : json_kv_null(w, "ifcnt")) &&
+           json_write_key(w, "gstat") &&
+           (st->gstat_valid ? json_write_fmt(w, "0x%02X", (unsigned)st->gstat) : json_write_null(w)) &&
+           json_write_key(w, "drv_status") &&
+           (st->drv_status_valid ? json_write_fmt(w, "0x%08X", (unsigned)st->drv_status) : json_write_null(w)) &&
+           ((st->microsteps != 0) ? json_kv_u32(w, "microsteps", st->microsteps) : json_kv_null(w, "microsteps")) &&
+           json_kv_u32(w, "run_current_cmd", st->run_current_cmd) &&
+           json_kv_u32(w, "hold_current_cmd", st->hold_current_cmd) &&
+           json_kv_u32(w, "hold_delay_cmd", st->hold_delay_cmd) &&
+           (st->drv_status_valid ? json_kv_u32(w, "stst", st->stst ? 1U : 0U) : json_kv_null(w, "stst")) &&
+           (st->drv_status_valid ? json_kv_u32(w, "cs_actual", st->cs_actual) : json_kv_null(w, "cs_actual")) &&
+           (st->stealthchop_valid ? json_kv_bool(w, "stealthchop", st->stealthchop) : json_kv_null(w, "stealthchop")) &&
+           json_obj_end(w);
+}
+
+static size_t tmc_dump_regs_locked(stepper_driver_reg_value_t *out, size_t max)
+{
+    size_t reg_count = 0;
+    const tmc2209_reg_t *regs = tmc2209_regs(&reg_count);
+    size_t used = 0;
+    for (size_t i = 0; i < reg_count && used < max; ++i)
+    {
+        if ((regs[i].access & TMC2209_ACCESS_READ) == 0)
         {
-            snprintf(micro_buf, sizeof(micro_buf), "%u", (unsigned)micro);
-            micro_str = micro_buf;
+            continue;
         }
+        out[used].reg = &regs[i];
+        out[used].value = 0;
+        out[used].err = tmc_read_reg(regs[i].addr, &out[used].value);
+        used++;
+    }
+    return used;
+}
+
+void stepper_uart_get_stats(stepper_uart_stats_t *out)
+{
+    if (out != NULL)
+    {
+        *out = s_stats;
+    }
+}
+
+esp_err_t stepper_uart_reset_stats(void)
+{
+    // Under the bus lock so a transaction in flight cannot count into half-cleared stats.
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+    stepper_uart_bus_release();
+    return ESP_OK;
+}
+
+bool stepper_uart_write_stats_json(json_writer_t *w)
+{
+    stepper_uart_stats_t st = s_stats;
+    bool ok = json_obj_begin(w) &&
+              json_kv_u32(w, "reads", st.reads) &&
+              json_kv_u32(w, "writes", st.writes) &&
+              json_kv_u32(w, "ok", st.ok) &&
+              json_kv_u32(w, "timeout", st.timeout) &&
+              json_kv_u32(w, "echo_only", st.echo_only) &&
+              json_kv_u32(w, "crc_fail", st.crc_fail) &&
+              json_kv_u32(w, "wrong_reg", st.wrong_reg) &&
+              json_kv_u32(w, "retries", st.retries) &&
+              json_kv_u32(w, "batches", st.batches) &&
+              json_kv_u32(w, "write_lost", st.write_lost) &&
+              json_kv_u32(w, "backoffs", st.backoffs) &&
+              json_kv_u32(w, "probes", st.probes) &&
+              json_kv_bool(w, "reliable", s_reliable_writes) &&
+              json_kv_u32(w, "lat_max_us", st.lat_max_us) &&
+              json_kv_u32(w, "lat_base_us", STEPPER_UART_LAT_BASE_US) &&
+              json_write_key(w, "lat_hist") &&
+              json_arr_begin(w);
+    for (size_t i = 0; ok && i < STEPPER_UART_LAT_BUCKETS; ++i)
+    {
+        ok = json_write_u32(w, st.lat_hist[i]);
+    }
+    return ok && json_arr_end(w) && json_obj_end(w);
+}
+
+bool stepper_uart_get_stats_json(char *buf, size_t len)
+{
+    if (buf == NULL || len == 0)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return stepper_uart_write_stats_json(&w);
+}
+
+// Compact counters-only form for the snapshot (histogram lives in `motor driver uartstats`).
+bool stepper_uart_write_stats_summary_json(json_writer_t *w)
+{
+    stepper_uart_stats_t st = s_stats;
+    return json_obj_begin(w) &&
+           json_kv_u32(w, "ok", st.ok) &&
+           json_kv_u32(w, "timeout", st.timeout) &&
+           json_kv_u32(w, "echo_only", st.echo_only) &&
+           json_kv_u32(w, "crc_fail", st.crc_fail) &&
+           json_kv_u32(w, "wrong_reg", st.wrong_reg) &&
+           json_kv_u32(w, "retries", st.retries) &&
+           json_obj_end(w);
+}
+
+bool stepper_uart_get_stats_summary_json(char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return stepper_uart_write_stats_summary_json(&w);
+}
+
+// Public entry points hold the bus lock for their whole register sequence, so
+// read-modify-write steps cannot interleave with the bus task or other callers.
+esp_err_t stepper_uart_read_reg(uint8_t slave, uint8_t reg, uint32_t *out)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_uart_read_reg_locked(slave, reg, out);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_uart_write_reg(uint8_t slave, uint8_t reg, uint32_t val)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_uart_write_reg_locked(slave, reg, val);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_uart_ensure_gconf_uart_mode(uint8_t slave)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_ensure_gconf_uart_mode_locked(slave);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_uart_write_batch(uint8_t slave, const stepper_uart_write_t *writes, size_t count)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_write_batch_locked(slave, writes, count);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_read_ifcnt(uint8_t *out)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_read_ifcnt_locked(out);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_ping(void)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_ping_locked();
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_set_stealthchop(bool enable)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_set_stealthchop_locked(enable);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_set_microsteps(uint16_t microsteps)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_set_microsteps_locked(microsteps);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_set_current(uint8_t run, uint8_t hold, uint8_t hold_delay)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_set_current_locked(run, hold, hold_delay);
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_clear_faults(void)
+{
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_clear_faults_locked();
+    stepper_uart_bus_release();
+    return err;
+}
+
+esp_err_t stepper_driver_get_status(stepper_driver_status_t *out)
+{
+    if (out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    tmc_get_status_locked(out);
+    stepper_uart_bus_release();
+    return ESP_OK;
+}
+
+bool stepper_driver_get_status_json(char *buf, size_t len)
+{
+    stepper_driver_status_t st;
+    if (stepper_driver_get_status(&st) != ESP_OK)
+    {
+        return false;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    return stepper_driver_write_status_json(&st, &w);
+}
+
+// Reads every readable register back-to-back under one bus hold.
+size_t stepper_driver_dump_regs(stepper_driver_reg_value_t *out, size_t max)
+{
+    if (out == NULL || max == 0)
+    {
+        return 0;
+    }
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return 0;
+    }
+    size_t count = tmc_dump_regs_locked(out, max);
+    stepper_uart_bus_release();
+    return count;
+}
+
+esp_err_t stepper_driver_scan(stepper_driver_scan_t *out)
+{
+    if (out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    tmc_scan_locked(out, true);
+    stepper_uart_bus_release();
+    return (out->count > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void stepper_driver_get_last_scan(stepper_driver_scan_t *out)
+{
+    if (out != NULL)
+    {
+        *out = s_scan;
+    }
+}
+
+uint8_t stepper_driver_get_slave_addr(void)
+{
+    return s_slave_addr;
+}
+
+esp_err_t stepper_driver_apply_config(const motor_driver_defaults_t *cfg)
+{
+    if (cfg == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!stepper_uart_bus_acquire(STEPPER_UART_LOCK_TIMEOUT_MS))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = tmc_apply_config_locked(cfg);
+    stepper_uart_bus_release();
+    return err;
+}
+
+void stepper_driver_get_config(motor_driver_defaults_t *out)
+{
+    if (out == NULL)
+    {
+        return;
     }
-    // *_cmd fields are cached last-commanded values (not readable registers).
-    // cs_actual comes from DRV_STATUS (hardware-reported).
-    snprintf(run_buf, sizeof(run_buf), "%u", (unsigned)s_run_current);
-    snprintf(hold_buf, sizeof(hold_buf), "%u", (unsigned)s_hold_current);
-    snprintf(hold_delay_buf, sizeof(hold_delay_buf), "%u", (unsigned)s_hold_delay);
-    run_str = run_buf;
-    hold_str = hold_buf;
-    hold_delay_str = hold_delay_buf;
-    if (ok_drv)
-    {
-        uint8_t stst = (uint8_t)((drv_status >> 31) & 0x01);
-        uint8_t cs_actual = (uint8_t)((drv_status >> 16) & 0x1F);
-        snprintf(stst_buf, sizeof(stst_buf), "%u", (unsigned)stst);
-        snprintf(cs_buf, sizeof(cs_buf), "%u", (unsigned)cs_actual);
-        stst_str = stst_buf;
-        cs_str = cs_buf;
-    }
-    if (ok_gconf)
-    {
-        bool stealth = ((gconf & TMC_GCONF_EN_SPREADCYCLE) == 0);
-        stealth_str = stealth ? "true" : "false";
-    }
-
-    int written = snprintf(buf, len,
-                           "{\"ifcnt\":%s,\"gstat\":%s,\"drv_status\":%s,"
-                           "\"microsteps\":%s,\"run_current_cmd\":%s,\"hold_current_cmd\":%s,"
-                           "\"hold_delay_cmd\":%s,\"stst\":%s,\"cs_actual\":%s,"
-                           "\"stealthchop\":%s}",
-                           ifcnt_str, gstat_str, drv_str,
-                           micro_str, run_str, hold_str,
-                           hold_delay_str, stst_str, cs_str,
-                           stealth_str);
-    return (written >= 0 && (size_t)written < len);
+    out->run_current = s_run_current;
+    out->hold_current = s_hold_current;
+    out->hold_delay = s_hold_delay;
+    out->microsteps = s_microsteps;
+    out->stealthchop = s_stealthchop;
 }
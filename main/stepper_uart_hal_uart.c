@@ -0,0 +1,106 @@
+// UART1 transport for the TMC2209 driver (PDN_UART, single wire).
+// UART: UART1 @ 115200 8N1, TX=GPIO17, RX=GPIO18; see stepper_driver_uart.c for wiring.
+// This is the only driver file that depends on the IDF UART driver.
+
+#include "stepper_driver_uart.h"
+#include "stepper_uart_hal.h"
+
+#include "esp_log.h"
+#include "driver/uart.h"
+
+#define STEPPER_UART UART_NUM_1
+#define STEPPER_UART_BAUD 115200
+#define STEPPER_UART_BUF 512
+#define STEPPER_UART_TX_GPIO 17
+#define STEPPER_UART_RX_GPIO 18
+
+static const char *TAG = "stepper_uart";
+
+static esp_err_t tmc_hal_uart_flush_input(void)
+{
+    return uart_flush_input(STEPPER_UART);
+}
+
+static int tmc_hal_uart_write(const uint8_t *data, size_t len)
+{
+    return uart_write_bytes(STEPPER_UART, data, len);
+}
+
+static int tmc_hal_uart_read(uint8_t *buf, size_t len, TickType_t timeout_ticks)
+{
+    return uart_read_bytes(STEPPER_UART, buf, len, timeout_ticks);
+}
+
+static esp_err_t tmc_hal_uart_wait_tx_done(TickType_t timeout_ticks)
+{
+    return uart_wait_tx_done(STEPPER_UART, timeout_ticks);
+}
+
+static const stepper_uart_hal_t k_hal_uart = {
+    .name = "uart1",
+    .flush_input = tmc_hal_uart_flush_input,
+    .write = tmc_hal_uart_write,
+    .read = tmc_hal_uart_read,
+    .wait_tx_done = tmc_hal_uart_wait_tx_done,
+};
+
+esp_err_t stepper_driver_uart_init(void)
+{
+    uart_config_t cfg = {
+        .baud_rate = STEPPER_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    esp_err_t err = uart_param_config(STEPPER_UART, &cfg);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "uart_param_config failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    const int tx_pin = STEPPER_UART_TX_GPIO;
+    const int rx_pin = STEPPER_UART_RX_GPIO;
+    err = uart_set_pin(STEPPER_UART,
+                       tx_pin,
+                       rx_pin,
+                       UART_PIN_NO_CHANGE,
+                       UART_PIN_NO_CHANGE);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "uart_set_pin failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = uart_driver_install(STEPPER_UART, STEPPER_UART_BUF, 0, 0, NULL, 0);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "uart_driver_install failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = uart_set_rx_timeout(STEPPER_UART, 2);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "uart_set_rx_timeout failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = uart_flush_input(STEPPER_UART);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "uart_flush_input failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGD(TAG, "UART%d init baud=%d tx=%d rx=%d rxbuf=%d",
+             (int)STEPPER_UART,
+             STEPPER_UART_BAUD,
+             tx_pin,
+             rx_pin,
+             STEPPER_UART_BUF);
+    err = stepper_uart_set_default_hal(&k_hal_uart);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "bus task start failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    return ESP_OK;
+}
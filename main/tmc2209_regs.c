@@ -0,0 +1,54 @@
+#include "tmc2209_regs.h"
+
+#define TMC2209_FIELD_TABLE_ENTRY(reg, field, name, offset, width) {#name, (offset), (width)},
+#define TMC2209_REG_FIELD_TABLE(reg, addr, access) \
+    static const tmc2209_field_t k_fields_##reg[] = {TMC2209_##reg##_FIELDS(TMC2209_FIELD_TABLE_ENTRY)};
+TMC2209_REG_LIST(TMC2209_REG_FIELD_TABLE)
+
+#define TMC2209_REG_TABLE_ENTRY(reg, addr, access) \
+    {#reg, (addr), (access), k_fields_##reg, (uint8_t)(sizeof(k_fields_##reg) / sizeof(k_fields_##reg[0]))},
+static const tmc2209_reg_t k_regs[] = {TMC2209_REG_LIST(TMC2209_REG_TABLE_ENTRY)};
+
+const tmc2209_reg_t *tmc2209_regs(size_t *count)
+{
+    if (count != NULL)
+    {
+        *count = sizeof(k_regs) / sizeof(k_regs[0]);
+    }
+    return k_regs;
+}
+
+const tmc2209_reg_t *tmc2209_reg_find(uint8_t addr)
+{
+    for (size_t i = 0; i < sizeof(k_regs) / sizeof(k_regs[0]); ++i)
+    {
+        if (k_regs[i].addr == addr)
+        {
+            return &k_regs[i];
+        }
+    }
+    return NULL;
+}
+
+void tmc2209_decode_drv_status(uint32_t raw, tmc2209_drv_status_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    out->otpw = TMC2209_FIELD_GET(raw, DRV_STATUS, OTPW) != 0;
+    out->ot = TMC2209_FIELD_GET(raw, DRV_STATUS, OT) != 0;
+    out->s2ga = TMC2209_FIELD_GET(raw, DRV_STATUS, S2GA) != 0;
+    out->s2gb = TMC2209_FIELD_GET(raw, DRV_STATUS, S2GB) != 0;
+    out->s2vsa = TMC2209_FIELD_GET(raw, DRV_STATUS, S2VSA) != 0;
+    out->s2vsb = TMC2209_FIELD_GET(raw, DRV_STATUS, S2VSB) != 0;
+    out->ola = TMC2209_FIELD_GET(raw, DRV_STATUS, OLA) != 0;
+    out->olb = TMC2209_FIELD_GET(raw, DRV_STATUS, OLB) != 0;
+    out->t120 = TMC2209_FIELD_GET(raw, DRV_STATUS, T120) != 0;
+    out->t143 = TMC2209_FIELD_GET(raw, DRV_STATUS, T143) != 0;
+    out->t150 = TMC2209_FIELD_GET(raw, DRV_STATUS, T150) != 0;
+    out->t157 = TMC2209_FIELD_GET(raw, DRV_STATUS, T157) != 0;
+    out->cs_actual = (uint8_t)TMC2209_FIELD_GET(raw, DRV_STATUS, CS_ACTUAL);
+    out->stealth = TMC2209_FIELD_GET(raw, DRV_STATUS, STEALTH) != 0;
+    out->stst = TMC2209_FIELD_GET(raw, DRV_STATUS, STST) != 0;
+}
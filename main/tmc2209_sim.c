@@ -0,0 +1,402 @@
+#include "tmc2209_sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "tmc2209_regs.h"
+#include "tmc_frame.h"
+
+static const char *TAG = "tmc2209_sim";
+
+#define TMC2209_SIM_RX_BUF 64
+#define TMC2209_SIM_BYTE_US 87 // 10 bit times at 115200 baud
+#define TMC2209_SIM_VERSION 0x21
+#define TMC2209_SIM_DEFAULT_SEED 0x2209
+
+// All sim state below is shared between the bus user (HAL ops, called under the driver's bus
+// lock) and the console (fault/config setters, status); s_mux covers both sides.
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool s_initialized = false;
+static uint32_t s_regs[128];
+static uint8_t s_ifcnt = 0;
+static uint8_t s_slave = 0;
+static uint32_t s_rng = TMC2209_SIM_DEFAULT_SEED;
+static tmc2209_sim_faults_t s_faults;
+static tmc2209_sim_stats_t s_stats;
+
+// Frame assembly from the TX stream.
+static uint8_t s_frame[TMC_FRAME_WRITE_REQ_LEN];
+static size_t s_frame_len = 0;
+
+// RX line: bytes [0, s_rx_visible) are readable now, the rest become readable at s_rx_due_us
+// (one due time for everything in flight; good enough for a single outstanding reply).
+static uint8_t s_rx[TMC2209_SIM_RX_BUF];
+static size_t s_rx_len = 0;
+static size_t s_rx_visible = 0;
+static int64_t s_rx_due_us = 0;
+
+static uint32_t sim_rand_pct(void)
+{
+    // xorshift32: reproducible for a given seed.
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng % 100U;
+}
+
+static bool sim_roll(uint8_t pct)
+{
+    return (pct > 0) && (sim_rand_pct() < pct);
+}
+
+static void sim_rx_push(const uint8_t *data, size_t len, bool visible_now)
+{
+    if (len > TMC2209_SIM_RX_BUF - s_rx_len)
+    {
+        len = TMC2209_SIM_RX_BUF - s_rx_len;
+    }
+    memcpy(&s_rx[s_rx_len], data, len);
+    s_rx_len += len;
+    if (visible_now && s_rx_visible + len == s_rx_len)
+    {
+        s_rx_visible = s_rx_len;
+    }
+}
+
+static void sim_rx_update(void)
+{
+    if (s_rx_visible < s_rx_len && esp_timer_get_time() >= s_rx_due_us)
+    {
+        s_rx_visible = s_rx_len;
+    }
+}
+
+static uint32_t sim_read_value(uint8_t reg)
+{
+    switch (reg)
+    {
+    case TMC2209_REG_IFCNT:
+        return s_ifcnt;
+    case TMC2209_REG_IOIN:
+        return TMC2209_FIELD_SET(0, IOIN, VERSION, TMC2209_SIM_VERSION);
+    case TMC2209_REG_DRV_STATUS:
+    {
+        // Standstill at the commanded run current; mode follows GCONF.
+        uint32_t v = 0;
+        uint32_t irun = TMC2209_FIELD_GET(s_regs[TMC2209_REG_IHOLD_IRUN], IHOLD_IRUN, IRUN);
+        uint32_t spread = TMC2209_FIELD_GET(s_regs[TMC2209_REG_GCONF], GCONF, EN_SPREADCYCLE);
+        v = TMC2209_FIELD_SET(v, DRV_STATUS, CS_ACTUAL, irun);
+        v = TMC2209_FIELD_SET(v, DRV_STATUS, STEALTH, spread ? 0 : 1);
+        v = TMC2209_FIELD_SET(v, DRV_STATUS, STST, 1);
+        return v;
+    }
+    default:
+        break;
+    }
+    const tmc2209_reg_t *info = tmc2209_reg_find(reg);
+    if (info == NULL || (info->access & TMC2209_ACCESS_READ) == 0)
+    {
+        return 0;
+    }
+    return s_regs[reg];
+}
+
+static void sim_handle_write(uint8_t reg, uint32_t value)
+{
+    s_stats.writes++;
+    if (sim_roll(s_faults.lose_pct))
+    {
+        s_stats.lost++;
+        return;
+    }
+    const tmc2209_reg_t *info = tmc2209_reg_find(reg);
+    if (info != NULL && (info->access & TMC2209_ACCESS_WRITE) != 0)
+    {
+        if ((info->access & TMC2209_ACCESS_CLEAR) != 0)
+        {
+            s_regs[reg] &= ~value;
+        }
+        else
+        {
+            s_regs[reg] = value;
+        }
+    }
+    // The chip counts every CRC-valid write addressed to it, known register or not.
+    s_ifcnt++;
+}
+
+static void sim_handle_read(uint8_t reg, size_t tx_len)
+{
+    s_stats.reads++;
+    if (sim_roll(s_faults.drop_pct))
+    {
+        s_stats.dropped++;
+        return;
+    }
+    uint32_t value = sim_read_value(reg);
+    uint8_t reply[TMC_FRAME_REPLY_LEN];
+    reply[0] = TMC_FRAME_SYNC;
+    reply[1] = TMC_FRAME_MASTER_ADDR;
+    reply[2] = reg;
+    reply[3] = (uint8_t)(value >> 24);
+    reply[4] = (uint8_t)(value >> 16);
+    reply[5] = (uint8_t)(value >> 8);
+    reply[6] = (uint8_t)value;
+    reply[7] = tmc_frame_crc(reply, 7);
+    if (sim_roll(s_faults.corrupt_pct))
+    {
+        s_stats.corrupted++;
+        reply[3 + (s_rng & 0x03)] ^= (uint8_t)(1U << ((s_rng >> 2) & 0x07));
+    }
+    int64_t due_us = esp_timer_get_time() + (int64_t)(tx_len + TMC_FRAME_REPLY_LEN) * TMC2209_SIM_BYTE_US;
+    if (s_faults.delay_ms > 0)
+    {
+        s_stats.delayed++;
+        due_us += (int64_t)s_faults.delay_ms * 1000;
+    }
+    s_rx_due_us = due_us;
+    sim_rx_push(reply, sizeof(reply), false);
+}
+
+static void sim_handle_frame(const uint8_t *frame, size_t len)
+{
+    s_stats.frames++;
+    if (tmc_frame_crc(frame, len - 1) != frame[len - 1])
+    {
+        s_stats.bad_crc++;
+        return;
+    }
+    if (frame[1] != s_slave)
+    {
+        s_stats.other_slave++;
+        return;
+    }
+    uint8_t reg = frame[2] & (uint8_t)~TMC_FRAME_WRITE_BIT;
+    if (len == TMC_FRAME_WRITE_REQ_LEN)
+    {
+        uint32_t value = ((uint32_t)frame[3] << 24) | ((uint32_t)frame[4] << 16) |
+                         ((uint32_t)frame[5] << 8) | (uint32_t)frame[6];
+        sim_handle_write(reg, value);
+        return;
+    }
+    sim_handle_read(reg, len);
+}
+
+static esp_err_t sim_flush_input(void)
+{
+    // Only bytes already on the line are discarded; a reply still in flight arrives later,
+    // as it would on hardware.
+    portENTER_CRITICAL(&s_mux);
+    sim_rx_update();
+    memmove(s_rx, &s_rx[s_rx_visible], s_rx_len - s_rx_visible);
+    s_rx_len -= s_rx_visible;
+    s_rx_visible = 0;
+    portEXIT_CRITICAL(&s_mux);
+    return ESP_OK;
+}
+
+static int sim_write(const uint8_t *data, size_t len)
+{
+    if (data == NULL)
+    {
+        return -1;
+    }
+    portENTER_CRITICAL(&s_mux);
+    if (!s_faults.no_echo)
+    {
+        sim_rx_push(data, len, true);
+    }
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (s_frame_len == 0 && data[i] != TMC_FRAME_SYNC)
+        {
+            continue;
+        }
+        s_frame[s_frame_len++] = data[i];
+        if (s_frame_len == TMC_FRAME_READ_REQ_LEN && (s_frame[2] & TMC_FRAME_WRITE_BIT) == 0)
+        {
+            sim_handle_frame(s_frame, s_frame_len);
+            s_frame_len = 0;
+        }
+        else if (s_frame_len == TMC_FRAME_WRITE_REQ_LEN)
+        {
+            sim_handle_frame(s_frame, s_frame_len);
+            s_frame_len = 0;
+        }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return (int)len;
+}
+
+static int sim_read(uint8_t *buf, size_t len, TickType_t timeout_ticks)
+{
+    if (buf == NULL)
+    {
+        return -1;
+    }
+    portENTER_CRITICAL(&s_mux);
+    sim_rx_update();
+    if (s_rx_visible == 0 && timeout_ticks > 0)
+    {
+        int64_t wait_us = (int64_t)timeout_ticks * portTICK_PERIOD_MS * 1000;
+        if (s_rx_len > 0)
+        {
+            int64_t until_due = s_rx_due_us - esp_timer_get_time();
+            if (until_due < wait_us)
+            {
+                wait_us = (until_due > 0) ? until_due : 0;
+            }
+        }
+        TickType_t ticks = (TickType_t)((wait_us + (portTICK_PERIOD_MS * 1000) - 1) / (portTICK_PERIOD_MS * 1000));
+        // Wait with the lock released so the console can still reach the sim meanwhile.
+        portEXIT_CRITICAL(&s_mux);
+        vTaskDelay((ticks > timeout_ticks) ? timeout_ticks : ticks);
+        portENTER_CRITICAL(&s_mux);
+        sim_rx_update();
+    }
+    size_t n = (len < s_rx_visible) ? len : s_rx_visible;
+    memcpy(buf, s_rx, n);
+    memmove(s_rx, &s_rx[n], s_rx_len - n);
+    s_rx_len -= n;
+    s_rx_visible -= n;
+    portEXIT_CRITICAL(&s_mux);
+    return (int)n;
+}
+
+static esp_err_t sim_wait_tx_done(TickType_t timeout_ticks)
+{
+    (void)timeout_ticks;
+    return ESP_OK;
+}
+
+static const stepper_uart_hal_t k_sim_hal = {
+    .name = "sim",
+    .flush_input = sim_flush_input,
+    .write = sim_write,
+    .read = sim_read,
+    .wait_tx_done = sim_wait_tx_done,
+};
+
+const stepper_uart_hal_t *tmc2209_sim_hal(void)
+{
+    portENTER_CRITICAL(&s_mux);
+    bool initialized = s_initialized;
+    portEXIT_CRITICAL(&s_mux);
+    if (!initialized)
+    {
+        tmc2209_sim_reset();
+    }
+    return &k_sim_hal;
+}
+
+void tmc2209_sim_reset(void)
+{
+    portENTER_CRITICAL(&s_mux);
+    memset(s_regs, 0, sizeof(s_regs));
+    // Datasheet power-on values for the registers the driver touches.
+    s_regs[TMC2209_REG_GCONF] = 0x00000041;
+    s_regs[TMC2209_REG_IHOLD_IRUN] = 0x00071F10;
+    s_regs[TMC2209_REG_TPOWERDOWN] = 0x00000014;
+    s_regs[TMC2209_REG_CHOPCONF] = 0x10000053;
+    s_regs[TMC2209_REG_PWMCONF] = 0xC10D0024;
+    s_regs[TMC2209_REG_GSTAT] = 0x00000001;
+    s_ifcnt = 0;
+    s_frame_len = 0;
+    s_rx_len = 0;
+    s_rx_visible = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_initialized = true;
+    const uint8_t slave = s_slave;
+    portEXIT_CRITICAL(&s_mux);
+    ESP_LOGI(TAG, "reset slave=%u", (unsigned)slave);
+}
+
+void tmc2209_sim_set_slave(uint8_t slave)
+{
+    portENTER_CRITICAL(&s_mux);
+    s_slave = slave & 0x03;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void tmc2209_sim_seed(uint32_t seed)
+{
+    portENTER_CRITICAL(&s_mux);
+    s_rng = (seed != 0) ? seed : TMC2209_SIM_DEFAULT_SEED;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void tmc2209_sim_set_faults(const tmc2209_sim_faults_t *faults)
+{
+    portENTER_CRITICAL(&s_mux);
+    if (faults == NULL)
+    {
+        memset(&s_faults, 0, sizeof(s_faults));
+    }
+    else
+    {
+        s_faults = *faults;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void tmc2209_sim_get_faults(tmc2209_sim_faults_t *out)
+{
+    if (out != NULL)
+    {
+        portENTER_CRITICAL(&s_mux);
+        *out = s_faults;
+        portEXIT_CRITICAL(&s_mux);
+    }
+}
+
+void tmc2209_sim_get_stats(tmc2209_sim_stats_t *out)
+{
+    if (out != NULL)
+    {
+        portENTER_CRITICAL(&s_mux);
+        *out = s_stats;
+        portEXIT_CRITICAL(&s_mux);
+    }
+}
+
+uint32_t tmc2209_sim_peek_reg(uint8_t reg)
+{
+    portENTER_CRITICAL(&s_mux);
+    uint32_t value = sim_read_value(reg & 0x7F);
+    portEXIT_CRITICAL(&s_mux);
+    return value;
+}
+
+bool tmc2209_sim_get_status_json(char *buf, size_t len)
+{
+    if (buf == NULL || len == 0)
+    {
+        return false;
+    }
+    portENTER_CRITICAL(&s_mux);
+    const uint8_t slave = s_slave;
+    const uint8_t ifcnt = s_ifcnt;
+    const tmc2209_sim_faults_t faults = s_faults;
+    const tmc2209_sim_stats_t stats = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+    int written = snprintf(buf, len,
+                           "{\"active\":%s,\"slave\":%u,\"ifcnt\":%u,"
+                           "\"faults\":{\"drop_pct\":%u,\"corrupt_pct\":%u,\"lose_pct\":%u,\"delay_ms\":%u,\"no_echo\":%s},"
+                           "\"frames\":%lu,\"reads\":%lu,\"writes\":%lu,\"bad_crc\":%lu,\"other_slave\":%lu,"
+                           "\"dropped\":%lu,\"corrupted\":%lu,\"lost\":%lu,\"delayed\":%lu}",
+                           (stepper_uart_get_hal() == &k_sim_hal) ? "true" : "false",
+                           (unsigned)slave, (unsigned)ifcnt,
+                           (unsigned)faults.drop_pct, (unsigned)faults.corrupt_pct,
+                           (unsigned)faults.lose_pct, (unsigned)faults.delay_ms,
+                           faults.no_echo ? "true" : "false",
+                           (unsigned long)stats.frames, (unsigned long)stats.reads,
+                           (unsigned long)stats.writes, (unsigned long)stats.bad_crc,
+                           (unsigned long)stats.other_slave, (unsigned long)stats.dropped,
+                           (unsigned long)stats.corrupted, (unsigned long)stats.lost,
+                           (unsigned long)stats.delayed);
+    return (written > 0 && (size_t)written < len);
+}
@@ -0,0 +1,373 @@
+#include "torque_capture.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "events.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "loadcell_scale.h"
+#include "motor.h"
+#include "stepper_driver_uart.h"
+
+#define TORQUE_CAPTURE_TASK_STACK 3072
+#define TORQUE_CAPTURE_TASK_PRIO 4
+#define TORQUE_CAPTURE_DEFAULT_DWELL_MS 1000
+#define TORQUE_CAPTURE_DEFAULT_DROP_PCT 50
+// Step rate slope between levels (steps/s^2); an abrupt jump loses steps near pull-out and
+// reads as a force drop.
+#define TORQUE_CAPTURE_ACCEL_HZ_PER_S 2000
+// Peak force (raw counts from the baseline) needed before a drop counts as a stall.
+#define TORQUE_CAPTURE_MIN_PEAK_RAW 200
+#define TORQUE_CAPTURE_BASELINE_LEVEL UINT16_MAX
+
+static const char *TAG = "torque_capture";
+
+typedef struct
+{
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+    uint32_t count;
+} torque_bin_t;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task = NULL;
+static volatile bool s_stop_req = false;
+static volatile bool s_binning = false;
+static uint16_t s_level_idx = 0;
+static torque_bin_t s_bin;
+static int64_t s_start_us = 0;
+
+static torque_capture_summary_t s_summary = {.state = TORQUE_CAPTURE_IDLE, .reason = "none"};
+static torque_level_t s_levels[TORQUE_CAPTURE_MAX_LEVELS];
+static torque_sample_t *s_trace = NULL;
+static size_t s_trace_count = 0;
+static uint32_t s_trace_dropped = 0;
+
+static const char *const k_state_names[] = {
+    [TORQUE_CAPTURE_IDLE] = "idle",
+    [TORQUE_CAPTURE_RUNNING] = "running",
+    [TORQUE_CAPTURE_STALLED] = "stalled",
+    [TORQUE_CAPTURE_COMPLETE] = "complete",
+    [TORQUE_CAPTURE_ABORTED] = "aborted",
+    [TORQUE_CAPTURE_FAILED] = "failed",
+};
+
+void torque_capture_default_config(torque_capture_config_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->dwell_ms = TORQUE_CAPTURE_DEFAULT_DWELL_MS;
+    out->stall_drop_pct = TORQUE_CAPTURE_DEFAULT_DROP_PCT;
+}
+
+// Runs in the load cell sampling task: tag and bin, nothing that can block.
+static void torque_capture_on_sample(const loadcell_sample_t *sample)
+{
+    if (!s_binning)
+    {
+        return;
+    }
+    int32_t pos = motor_get_step_pos();
+    uint32_t hz = motor_get_speed_hz();
+    portENTER_CRITICAL(&s_mux);
+    torque_bin_t *bin = &s_bin;
+    if (bin->count == 0 || sample->raw < bin->min)
+    {
+        bin->min = sample->raw;
+    }
+    if (bin->count == 0 || sample->raw > bin->max)
+    {
+        bin->max = sample->raw;
+    }
+    bin->sum += sample->raw;
+    bin->count++;
+    if (s_trace != NULL && s_trace_count < TORQUE_CAPTURE_TRACE_LEN)
+    {
+        s_trace[s_trace_count++] = (torque_sample_t){
+            .raw = sample->raw,
+            .step_pos = pos,
+            .t_ms = (uint32_t)((sample->ts_us - s_start_us) / 1000),
+            .step_hz = (uint16_t)hz,
+            .level = s_level_idx,
+        };
+    }
+    else
+    {
+        s_trace_dropped++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+// Sleeps for ms unless a stop request wakes the task early; returns false on stop.
+static bool torque_capture_wait(uint32_t ms)
+{
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+    ulTaskNotifyTake(pdTRUE, (ticks > 0) ? ticks : 1);
+    return !s_stop_req;
+}
+
+static bool torque_capture_measure(uint16_t level, uint32_t ms, torque_bin_t *out)
+{
+    portENTER_CRITICAL(&s_mux);
+    memset(&s_bin, 0, sizeof(s_bin));
+    s_level_idx = level;
+    portEXIT_CRITICAL(&s_mux);
+    s_binning = true;
+    bool ok = torque_capture_wait(ms);
+    s_binning = false;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_bin;
+    portEXIT_CRITICAL(&s_mux);
+    return ok;
+}
+
+static void torque_capture_finish(torque_capture_state_t state, const char *reason)
+{
+    motor_stop();
+    loadcell_scale_set_sample_listener(NULL);
+    portENTER_CRITICAL(&s_mux);
+    s_summary.state = state;
+    s_summary.reason = reason;
+    s_summary.trace_count = s_trace_count;
+    s_summary.trace_dropped = s_trace_dropped;
+    portEXIT_CRITICAL(&s_mux);
+    events_emit("torque_capture", "motor", 0, reason);
+}
+
+static void torque_capture_task(void *arg)
+{
+    (void)arg;
+    const torque_capture_config_t cfg = s_summary.cfg;
+    const uint32_t half_ms = cfg.dwell_ms / 2;
+    torque_bin_t bin;
+
+    // Baseline with the motor enabled but not stepping.
+    if (!torque_capture_measure(TORQUE_CAPTURE_BASELINE_LEVEL, half_ms, &bin) || bin.count == 0)
+    {
+        torque_capture_finish(s_stop_req ? TORQUE_CAPTURE_ABORTED : TORQUE_CAPTURE_FAILED,
+                              s_stop_req ? "stopped" : "no_data");
+        s_task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    const int32_t baseline = (int32_t)(bin.sum / bin.count);
+    portENTER_CRITICAL(&s_mux);
+    s_summary.baseline_raw = baseline;
+    portEXIT_CRITICAL(&s_mux);
+
+    torque_capture_state_t final_state = TORQUE_CAPTURE_COMPLETE;
+    const char *reason = "complete";
+    if (motor_set_speed_hz(MOTOR_MIN_HZ) != ESP_OK || motor_start() != ESP_OK)
+    {
+        torque_capture_finish(TORQUE_CAPTURE_FAILED, "motor");
+        s_task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    int64_t peak = 0;
+    size_t levels = 0;
+    for (uint32_t hz = cfg.start_hz; hz <= cfg.end_hz && levels < TORQUE_CAPTURE_MAX_LEVELS; hz += cfg.step_hz)
+    {
+        if (motor_ramp_speed_hz(hz, TORQUE_CAPTURE_ACCEL_HZ_PER_S) != ESP_OK)
+        {
+            final_state = TORQUE_CAPTURE_FAILED;
+            reason = "motor";
+            break;
+        }
+        if (!torque_capture_wait(half_ms))
+        {
+            final_state = TORQUE_CAPTURE_ABORTED;
+            reason = "stopped";
+            break;
+        }
+        int32_t pos0 = motor_get_step_pos();
+        bool ok = torque_capture_measure((uint16_t)levels, half_ms, &bin);
+        int32_t pos1 = motor_get_step_pos();
+
+        torque_level_t level = {
+            .step_hz = hz,
+            .samples = bin.count,
+            .raw_mean = (bin.count > 0) ? (int32_t)(bin.sum / bin.count) : 0,
+            .raw_min = bin.min,
+            .raw_max = bin.max,
+            .steps = pos1 - pos0,
+        };
+        level.drv_ok =
+            (stepper_uart_read_reg(stepper_driver_get_slave_addr(), TMC2209_REG_DRV_STATUS, &level.drv_status) == ESP_OK);
+        s_levels[levels] = level;
+        levels++;
+        portENTER_CRITICAL(&s_mux);
+        s_summary.level_count = levels;
+        portEXIT_CRITICAL(&s_mux);
+        if (!ok)
+        {
+            final_state = TORQUE_CAPTURE_ABORTED;
+            reason = "stopped";
+            break;
+        }
+        if (bin.count == 0)
+        {
+            final_state = TORQUE_CAPTURE_FAILED;
+            reason = "no_data";
+            break;
+        }
+
+        tmc2209_drv_status_t drv;
+        tmc2209_decode_drv_status(level.drv_status, &drv);
+        if (level.drv_ok && (drv.ot || drv.s2ga || drv.s2gb || drv.s2vsa || drv.s2vsb))
+        {
+            final_state = TORQUE_CAPTURE_STALLED;
+            reason = "driver_fault";
+            portENTER_CRITICAL(&s_mux);
+            s_summary.stall_hz = hz;
+            portEXIT_CRITICAL(&s_mux);
+            break;
+        }
+        int64_t force = (int64_t)level.raw_mean - baseline;
+        int64_t force_abs = (force < 0) ? -force : force;
+        if (levels >= 2 && peak >= TORQUE_CAPTURE_MIN_PEAK_RAW &&
+            force_abs * 100 < peak * (100 - cfg.stall_drop_pct))
+        {
+            final_state = TORQUE_CAPTURE_STALLED;
+            reason = "force_drop";
+            portENTER_CRITICAL(&s_mux);
+            s_summary.stall_hz = hz;
+            portEXIT_CRITICAL(&s_mux);
+            break;
+        }
+        if (force_abs > peak)
+        {
+            peak = force_abs;
+        }
+        portENTER_CRITICAL(&s_mux);
+        s_summary.pullout_hz = hz;
+        portEXIT_CRITICAL(&s_mux);
+    }
+    ESP_LOGI(TAG, "%s: %u levels, pullout %u Hz", reason, (unsigned)levels, (unsigned)s_summary.pullout_hz);
+    torque_capture_finish(final_state, reason);
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t torque_capture_start(const torque_capture_config_t *cfg)
+{
+    if (cfg == NULL || cfg->start_hz < MOTOR_MIN_HZ || cfg->end_hz > MOTOR_MAX_HZ || cfg->start_hz > cfg->end_hz ||
+        cfg->step_hz == 0 || cfg->dwell_ms < 2 || cfg->stall_drop_pct == 0 || cfg->stall_drop_pct >= 100)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task != NULL || motor_get_state() != MOTOR_STATE_ENABLED_IDLE)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_trace == NULL)
+    {
+        s_trace = malloc(TORQUE_CAPTURE_TRACE_LEN * sizeof(torque_sample_t));
+        if (s_trace == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    portENTER_CRITICAL(&s_mux);
+    memset(&s_summary, 0, sizeof(s_summary));
+    s_summary.state = TORQUE_CAPTURE_RUNNING;
+    s_summary.reason = "running";
+    s_summary.cfg = *cfg;
+    s_trace_count = 0;
+    s_trace_dropped = 0;
+    s_start_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_mux);
+    s_stop_req = false;
+    s_binning = false;
+    loadcell_scale_set_sample_listener(torque_capture_on_sample);
+    if (xTaskCreate(torque_capture_task, "torque_cap", TORQUE_CAPTURE_TASK_STACK, NULL, TORQUE_CAPTURE_TASK_PRIO,
+                    &s_task) != pdPASS)
+    {
+        s_task = NULL;
+        loadcell_scale_set_sample_listener(NULL);
+        portENTER_CRITICAL(&s_mux);
+        s_summary.state = TORQUE_CAPTURE_FAILED;
+        s_summary.reason = "no_mem";
+        portEXIT_CRITICAL(&s_mux);
+        return ESP_ERR_NO_MEM;
+    }
+    events_emit("torque_capture", "motor", 0, "start");
+    return ESP_OK;
+}
+
+void torque_capture_stop(void)
+{
+    s_stop_req = true;
+    TaskHandle_t task = s_task;
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+}
+
+torque_capture_state_t torque_capture_get_state(void)
+{
+    return s_summary.state;
+}
+
+const char *torque_capture_state_name(torque_capture_state_t state)
+{
+    if ((unsigned)state >= sizeof(k_state_names) / sizeof(k_state_names[0]))
+    {
+        return "unknown";
+    }
+    return k_state_names[state];
+}
+
+void torque_capture_get_summary(torque_capture_summary_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&s_mux);
+    *out = s_summary;
+    out->trace_count = s_trace_count;
+    out->trace_dropped = s_trace_dropped;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool torque_capture_get_level(size_t index, torque_level_t *out)
+{
+    if (out == NULL || index >= s_summary.level_count)
+    {
+        return false;
+    }
+    *out = s_levels[index];
+    return true;
+}
+
+size_t torque_capture_read_trace(size_t start, torque_sample_t *out, size_t max)
+{
+    if (out == NULL || s_trace == NULL)
+    {
+        return 0;
+    }
+    portENTER_CRITICAL(&s_mux);
+    size_t count = s_trace_count;
+    portEXIT_CRITICAL(&s_mux);
+    if (start >= count)
+    {
+        return 0;
+    }
+    size_t n = count - start;
+    if (n > max)
+    {
+        n = max;
+    }
+    // Entries below s_trace_count are never rewritten during a capture.
+    memcpy(out, &s_trace[start], n * sizeof(out[0]));
+    return n;
+}
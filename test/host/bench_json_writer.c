@@ -0,0 +1,119 @@
+// Host cost of the streaming JSON writer against the snprintf chain it replaced, on the
+// largest counters producer (`motor driver uartstats`). The stats are filled by a couple of hundred
+// transactions against the simulator first; the snprintf reference is the old producer body,
+// and the two outputs must match byte for byte. The writer's hand-rolled integer formatting is
+// also checked against printf at the range limits. Prints one JSON line; exits non-zero only if
+// the outputs differ or a producer fails.
+
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "json_helpers.h"
+#include "stepper_driver_uart.h"
+#include "tmc2209_regs.h"
+#include "tmc2209_sim.h"
+
+#define BENCH_ITERATIONS 200000u
+
+static bool ref_stats_json(const stepper_uart_stats_t *st, bool reliable, char *buf, size_t len)
+{
+    int written = snprintf(buf, len,
+                           "{\"reads\":%u,\"writes\":%u,\"ok\":%u,\"timeout\":%u,"
+                           "\"echo_only\":%u,\"crc_fail\":%u,\"wrong_reg\":%u,"
+                           "\"retries\":%u,\"batches\":%u,\"write_lost\":%u,\"backoffs\":%u,\"probes\":%u,"
+                           "\"reliable\":%s,\"lat_max_us\":%u,\"lat_base_us\":%u,\"lat_hist\":[",
+                           (unsigned)st->reads, (unsigned)st->writes, (unsigned)st->ok, (unsigned)st->timeout,
+                           (unsigned)st->echo_only, (unsigned)st->crc_fail, (unsigned)st->wrong_reg,
+                           (unsigned)st->retries, (unsigned)st->batches, (unsigned)st->write_lost,
+                           (unsigned)st->backoffs, (unsigned)st->probes, reliable ? "true" : "false",
+                           (unsigned)st->lat_max_us, (unsigned)STEPPER_UART_LAT_BASE_US);
+    if (written < 0 || (size_t)written >= len)
+    {
+        return false;
+    }
+    size_t used = (size_t)written;
+    for (size_t i = 0; i < STEPPER_UART_LAT_BUCKETS; ++i)
+    {
+        written = snprintf(buf + used, len - used, "%s%u", (i == 0) ? "" : ",", (unsigned)st->lat_hist[i]);
+        if (written < 0 || (size_t)written >= len - used)
+        {
+            return false;
+        }
+        used += (size_t)written;
+    }
+    written = snprintf(buf + used, len - used, "]}");
+    return (written >= 0 && (size_t)written < len - used);
+}
+
+static void check_integer_limits(void)
+{
+    static const int64_t k_values[] = {0, 9, 10, -1, INT32_MIN, INT32_MAX, UINT32_MAX, (int64_t)UINT32_MAX + 1,
+                                       INT64_MIN, INT64_MAX};
+    for (size_t i = 0; i < sizeof(k_values) / sizeof(k_values[0]); ++i)
+    {
+        const int64_t v = k_values[i];
+        char expect[96];
+        char got[96];
+        snprintf(expect, sizeof(expect), "[%lu,%ld,%lld]", (unsigned long)(uint32_t)v, (long)(int32_t)v,
+                 (long long)v);
+        json_writer_t w;
+        json_writer_init(&w, got, sizeof(got));
+        HOST_CHECK(json_arr_begin(&w) && json_write_u32(&w, (uint32_t)v) && json_write_i32(&w, (int32_t)v) &&
+                   json_write_i64(&w, v) && json_arr_end(&w));
+        HOST_CHECK_STR(got, expect);
+    }
+}
+
+static double ns_per(double elapsed_s, uint32_t n)
+{
+    return (n > 0) ? elapsed_s * 1e9 / (double)n : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCH_ITERATIONS;
+
+    check_integer_limits();
+    HOST_CHECK_EQ_U(stepper_uart_set_hal(tmc2209_sim_hal()), ESP_OK);
+    const tmc2209_sim_faults_t faults = {.lose_pct = 5};
+    tmc2209_sim_seed(11);
+    tmc2209_sim_set_faults(&faults);
+    for (int i = 0; i < 100; ++i)
+    {
+        uint32_t value = 0;
+        (void)stepper_uart_read_reg(0, TMC2209_REG_IOIN, &value);
+        (void)stepper_uart_write_reg(0, TMC2209_REG_GCONF, 0x000000C0);
+    }
+    tmc2209_sim_set_faults(NULL);
+
+    stepper_uart_stats_t st;
+    stepper_uart_get_stats(&st);
+    static char ref_buf[512];
+    static char buf[512];
+    bool ok = true;
+
+    double start = host_now_s();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        ok = ref_stats_json(&st, stepper_driver_get_reliable_writes(), ref_buf, sizeof(ref_buf));
+    }
+    const double ref_s = host_now_s() - start;
+    HOST_CHECK(ok);
+
+    start = host_now_s();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf));
+        ok = stepper_uart_write_stats_json(&w);
+    }
+    const double writer_s = host_now_s() - start;
+    HOST_CHECK(ok);
+    HOST_CHECK_STR(buf, ref_buf);
+
+    const double ref_ns = ns_per(ref_s, iterations);
+    const double writer_ns = ns_per(writer_s, iterations);
+    printf("{\"iterations\":%lu,\"bytes\":%zu,\"snprintf_ns\":%.1f,\"writer_ns\":%.1f,\"writer_ratio\":%.2f}\n",
+           (unsigned long)iterations, strlen(buf), ref_ns, writer_ns, (ref_ns > 0.0) ? writer_ns / ref_ns : 0.0);
+    return s_host_test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+// Host comparison of the two snapshot encoders, mirroring `snapshot bench`: the same schema
+// built as JSON (snapshot_build) and as CBOR (snapshot_build_cbor), with the status fields
+// faked to fixed values and the optional boot field enabled. Prints one JSON line; exits
+// non-zero only if an encoder fails.
+
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "snapshot.h"
+
+#define BENCH_ITERATIONS 200000u
+
+static double ns_per(double elapsed_s, uint32_t n)
+{
+    return (n > 0) ? elapsed_s * 1e9 / (double)n : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCH_ITERATIONS;
+    static char json_buf[1024];
+    static uint8_t cbor_buf[1024];
+    size_t cbor_bytes = 0;
+    bool ok = true;
+
+    double start = host_now_s();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        ok = snapshot_build(json_buf, sizeof(json_buf));
+    }
+    const double json_s = host_now_s() - start;
+    HOST_CHECK(ok);
+    const size_t json_bytes = strlen(json_buf);
+
+    start = host_now_s();
+    for (uint32_t i = 0; i < iterations && ok; ++i)
+    {
+        ok = snapshot_build_cbor(cbor_buf, sizeof(cbor_buf), &cbor_bytes);
+    }
+    const double cbor_s = host_now_s() - start;
+    HOST_CHECK(ok);
+    // Definite-length map header carrying one entry per schema field.
+    HOST_CHECK(cbor_bytes > 0 && (cbor_buf[0] >> 5) == 5 && (cbor_buf[0] & 0x1F) == snapshot_field_count());
+
+    const double json_ns = ns_per(json_s, iterations);
+    const double cbor_ns = ns_per(cbor_s, iterations);
+    printf("{\"iterations\":%lu,\"json_bytes\":%zu,\"json_ns\":%.1f,\"cbor_bytes\":%zu,\"cbor_ns\":%.1f,"
+           "\"cbor_size_pct\":%.1f,\"cbor_speedup\":%.2f}\n",
+           (unsigned long)iterations, json_bytes, json_ns, cbor_bytes, cbor_ns,
+           (json_bytes > 0) ? 100.0 * (double)cbor_bytes / (double)json_bytes : 0.0,
+           (cbor_ns > 0.0) ? json_ns / cbor_ns : 0.0);
+    return s_host_test_failures == 0 ? 0 : 1;
+}
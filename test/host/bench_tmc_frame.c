@@ -0,0 +1,95 @@
+// Host throughput of the TMC2209 frame codec. Mirrors `motor driver codecbench` (decode of a
+// 12-byte echo+reply buffer) and adds encode and CRC rates, with the datasheet's bitwise CRC
+// as the baseline the lookup table replaced. Prints one JSON line; exits non-zero only if a
+// decode fails.
+
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "tmc_frame.h"
+
+#define BENCH_FRAMES 2000000u
+
+static volatile uint32_t s_sink;
+
+static uint8_t ref_crc(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        uint8_t byte = data[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (((crc >> 7) ^ (byte & 0x01)) != 0) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
+
+static double per_s(uint32_t n, double elapsed_s)
+{
+    return (elapsed_s > 0.0) ? (double)n / elapsed_s : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCH_FRAMES;
+
+    uint8_t rx[TMC_FRAME_READ_REQ_LEN + TMC_FRAME_REPLY_LEN];
+    tmc_frame_encode_read(rx, 0, 0x02);
+    uint8_t *reply = &rx[TMC_FRAME_READ_REQ_LEN];
+    reply[0] = TMC_FRAME_SYNC;
+    reply[1] = TMC_FRAME_MASTER_ADDR;
+    reply[2] = 0x02;
+    reply[3] = 0;
+    reply[4] = 0;
+    reply[5] = 0;
+    reply[6] = 0x2A;
+    reply[7] = tmc_frame_crc(reply, 7);
+
+    uint32_t decoded = 0;
+    double start = host_now_s();
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        const uint8_t *found = NULL;
+        if (tmc_frame_decode_reply(rx, sizeof(rx), 0x02, &found) == TMC_FRAME_OK)
+        {
+            decoded++;
+        }
+    }
+    const double decode_s = host_now_s() - start;
+
+    uint8_t req[TMC_FRAME_WRITE_REQ_LEN];
+    uint32_t acc = 0;
+    start = host_now_s();
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        tmc_frame_encode_write(req, (uint8_t)(i & 3), 0x10, i);
+        acc += req[7];
+    }
+    const double encode_s = host_now_s() - start;
+
+    start = host_now_s();
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        req[3] = (uint8_t)i;
+        acc += tmc_frame_crc(req, 7);
+    }
+    const double crc_table_s = host_now_s() - start;
+
+    start = host_now_s();
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        req[3] = (uint8_t)i;
+        acc += ref_crc(req, 7);
+    }
+    const double crc_bitwise_s = host_now_s() - start;
+    s_sink = acc;
+
+    printf("{\"frames\":%u,\"decoded\":%u,\"decode_frames_per_s\":%.0f,\"encode_frames_per_s\":%.0f,"
+           "\"crc_table_per_s\":%.0f,\"crc_bitwise_per_s\":%.0f}\n",
+           (unsigned)frames, (unsigned)decoded, per_s(decoded, decode_s), per_s(frames, encode_s),
+           per_s(frames, crc_table_s), per_s(frames, crc_bitwise_s));
+    return (decoded == frames) ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+// Host stand-in for the cached-status side of loadcell_scale.c: a calibrated scale whose
+// latest filtered sample is a fixed reading, written the same way loadcell_scale.c writes it.
+
+#include "loadcell_scale.h"
+
+#include <string.h>
+
+void loadcell_scale_get_status(loadcell_scale_status_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->has_raw = true;
+    out->raw = 181422;
+    out->age_ms = 12;
+    out->has_grams = true;
+    out->grams = 123.456f;
+    out->tare_offset_raw = 84211;
+    out->scale_factor = 787.418f;
+    out->calibrated = true;
+}
+
+bool loadcell_scale_write_status_json(json_writer_t *w)
+{
+    loadcell_scale_status_t st;
+    loadcell_scale_get_status(&st);
+    return json_obj_begin(w) &&
+           (st.has_raw ? json_kv_i32(w, "raw", st.raw) : json_kv_null(w, "raw")) &&
+           (st.has_grams ? json_kv_float(w, "grams", st.grams, 3) : json_kv_null(w, "grams")) &&
+           (st.has_raw ? json_kv_u32(w, "age_ms", st.age_ms) : json_kv_null(w, "age_ms")) &&
+           json_kv_i32(w, "tare_offset_raw", st.tare_offset_raw) &&
+           json_kv_float(w, "scale_factor", st.scale_factor, 6) &&
+           json_kv_bool(w, "calibrated", st.calibrated) &&
+           json_obj_end(w);
+}
@@ -0,0 +1,121 @@
+// Host stand-in for the STEP/DIR/EN side of motor.c: no timer or GPIO, just the state the
+// callers can observe. Enough for driver_acceptance.c, which only sequences these calls, and
+// for the snapshot, whose motor object is written the same way motor.c writes it.
+
+#include <stdio.h>
+
+#include "motor.h"
+
+static motor_state_t s_state = MOTOR_STATE_DISABLED;
+static motor_dir_t s_dir = MOTOR_DIR_FWD;
+static uint32_t s_speed_hz = MOTOR_MIN_HZ;
+
+esp_err_t motor_enable(void)
+{
+    if (s_state == MOTOR_STATE_DISABLED)
+    {
+        s_state = MOTOR_STATE_ENABLED_IDLE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t motor_disable(void)
+{
+    s_state = MOTOR_STATE_DISABLED;
+    return ESP_OK;
+}
+
+esp_err_t motor_set_dir(motor_dir_t dir)
+{
+    s_dir = dir;
+    return ESP_OK;
+}
+
+esp_err_t motor_set_speed_hz(uint32_t step_hz)
+{
+    if (step_hz < MOTOR_MIN_HZ || step_hz > MOTOR_MAX_HZ)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_speed_hz = step_hz;
+    return ESP_OK;
+}
+
+esp_err_t motor_start(void)
+{
+    if (s_state == MOTOR_STATE_DISABLED)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_state = MOTOR_STATE_RUNNING;
+    return ESP_OK;
+}
+
+esp_err_t motor_stop(void)
+{
+    if (s_state == MOTOR_STATE_RUNNING)
+    {
+        s_state = MOTOR_STATE_ENABLED_IDLE;
+    }
+    return ESP_OK;
+}
+
+motor_state_t motor_get_state(void)
+{
+    return s_state;
+}
+
+uint32_t motor_get_speed_hz(void)
+{
+    return (s_state == MOTOR_STATE_RUNNING) ? s_speed_hz : 0;
+}
+
+const char *motor_state_to_str(motor_state_t state)
+{
+    switch (state)
+    {
+    case MOTOR_STATE_DISABLED:
+        return "disabled";
+    case MOTOR_STATE_ENABLED_IDLE:
+        return "enabled_idle";
+    case MOTOR_STATE_RUNNING:
+        return "running";
+    case MOTOR_STATE_FAULT:
+        return "fault";
+    default:
+        return "unknown";
+    }
+}
+
+const char *motor_dir_to_str(motor_dir_t dir)
+{
+    return (dir == MOTOR_DIR_REV) ? "CCW" : "CW";
+}
+
+void motor_get_status(motor_status_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    out->state = s_state;
+    out->enabled = (s_state != MOTOR_STATE_DISABLED);
+    out->step_hz = out->enabled ? s_speed_hz : 0;
+    out->dir = s_dir;
+    out->fault_code = 0;
+    snprintf(out->fault_reason, sizeof(out->fault_reason), "%s", "none");
+}
+
+bool motor_write_status_json(json_writer_t *w)
+{
+    motor_status_t st;
+    motor_get_status(&st);
+    return json_obj_begin(w) &&
+           json_kv_str(w, "state", motor_state_to_str(st.state)) &&
+           json_kv_bool(w, "enabled", st.enabled) &&
+           json_kv_u32(w, "step_hz", st.step_hz) &&
+           json_kv_str(w, "dir", motor_dir_to_str(st.dir)) &&
+           json_kv_i32(w, "fault_code", st.fault_code) &&
+           json_kv_str(w, "fault_reason", st.fault_reason) &&
+           json_obj_end(w);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Minimal assertion helpers for the host test executables. A failed check prints its location
+// and keeps going; HOST_TEST_RESULT() turns the failure count into the process exit code.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int s_host_test_failures __attribute__((unused)) = 0;
+
+#define HOST_CHECK(cond)                                                              \
+    do                                                                                \
+    {                                                                                 \
+        if (!(cond))                                                                  \
+        {                                                                             \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            s_host_test_failures++;                                                   \
+        }                                                                             \
+    } while (0)
+
+#define HOST_CHECK_EQ_U(actual, expected)                                                   \
+    do                                                                                      \
+    {                                                                                       \
+        unsigned long long a_ = (unsigned long long)(actual);                               \
+        unsigned long long e_ = (unsigned long long)(expected);                             \
+        if (a_ != e_)                                                                       \
+        {                                                                                   \
+            fprintf(stderr, "%s:%d: %s == %llu, expected %llu\n", __FILE__, __LINE__,       \
+                    #actual, a_, e_);                                                       \
+            s_host_test_failures++;                                                         \
+        }                                                                                   \
+    } while (0)
+
+#define HOST_CHECK_STR(actual, expected)                                                    \
+    do                                                                                      \
+    {                                                                                       \
+        const char *a_ = (actual);                                                          \
+        const char *e_ = (expected);                                                        \
+        if (a_ == NULL || strcmp(a_, e_) != 0)                                              \
+        {                                                                                   \
+            fprintf(stderr, "%s:%d: %s == \"%s\", expected \"%s\"\n", __FILE__, __LINE__,   \
+                    #actual, a_ ? a_ : "(null)", e_);                                       \
+            s_host_test_failures++;                                                         \
+        }                                                                                   \
+    } while (0)
+
+#define HOST_TEST_RESULT(name)                                                      \
+    (s_host_test_failures == 0 ? (printf("%s: ok\n", (name)), 0)                     \
+                               : (printf("%s: %d failure(s)\n", (name), s_host_test_failures), 1))
+
+// Deterministic xorshift32 so fuzz and benchmark inputs are reproducible across runs.
+static inline uint32_t host_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static inline double host_now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for esp_attr.h: memory placement attributes have no meaning off-target.
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define FORCE_INLINE_ATTR static inline __attribute__((always_inline))
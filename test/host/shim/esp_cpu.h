@@ -0,0 +1,10 @@
+#pragma once
+
+// Host stand-in for esp_cpu.h. The "cycle counter" runs at 1 GHz (nanoseconds from
+// CLOCK_MONOTONIC), so cycle deltas convert to time with HOST_CPU_TICKS_PER_US.
+
+#include <stdint.h>
+
+#define HOST_CPU_TICKS_PER_US 1000U
+
+uint32_t esp_cpu_get_cycle_count(void);
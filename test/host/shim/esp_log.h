@@ -0,0 +1,22 @@
+#pragma once
+
+// Host stand-in for esp_log.h: errors and warnings go to stderr, the rest is compiled out
+// (arguments are still type-checked).
+
+#include <stdio.h>
+
+#define ESP_HOST_LOG(level, tag, fmt, ...) fprintf(stderr, level " (%s) " fmt "\n", (tag), ##__VA_ARGS__)
+#define ESP_HOST_LOG_OFF(tag, fmt, ...)                       \
+    do                                                        \
+    {                                                         \
+        if (0)                                                \
+        {                                                     \
+            fprintf(stderr, "%s" fmt, (tag), ##__VA_ARGS__); \
+        }                                                     \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) ESP_HOST_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) ESP_HOST_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) ESP_HOST_LOG_OFF(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_HOST_LOG_OFF(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_HOST_LOG_OFF(tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,44 @@
+// Fixed answers for the esp_system/esp_mac/esp_cpu queries declared in the host shim headers.
+
+#include <stddef.h>
+#include <time.h>
+
+#include "esp_cpu.h"
+#include "esp_mac.h"
+#include "esp_system.h"
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return 245760;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return 201728;
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    static const uint8_t k_mac[6] = {0x7C, 0xDF, 0xA1, 0x00, 0x02, 0x01};
+    if (mac == NULL || type != ESP_MAC_WIFI_STA)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < 6; ++i)
+    {
+        mac[i] = k_mac[i];
+    }
+    return ESP_OK;
+}
+
+uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for esp_timer.h: microseconds since the first call, from CLOCK_MONOTONIC.
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
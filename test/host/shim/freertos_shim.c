@@ -0,0 +1,359 @@
+// pthread implementation of the FreeRTOS/esp_timer subset declared in the host shim headers.
+// Semantics follow FreeRTOS where the firmware depends on them: recursive mutexes count
+// nested takes per owner, task notifications are counting, timeouts are in 10 ms ticks.
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_task
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    TaskFunction_t fn;
+    void *arg;
+    pthread_t thread;
+};
+
+struct host_semaphore
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool recursive;
+    pthread_t owner;
+    uint32_t depth;
+};
+
+struct host_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t item_size;
+    size_t length;
+    size_t head;
+    size_t count;
+    uint8_t *items;
+};
+
+static __thread struct host_task *s_current;
+
+static int64_t host_mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_epoch_us;
+static pthread_once_t s_epoch_once = PTHREAD_ONCE_INIT;
+
+static void host_epoch_init(void)
+{
+    s_epoch_us = host_mono_us();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    pthread_once(&s_epoch_once, host_epoch_init);
+    return host_mono_us() - s_epoch_us;
+}
+
+static void host_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec host_deadline(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t ns = ts.tv_nsec + (int64_t)ticks * portTICK_PERIOD_MS * 1000000LL;
+    ts.tv_sec += (time_t)(ns / 1000000000LL);
+    ts.tv_nsec = (long)(ns % 1000000000LL);
+    return ts;
+}
+
+// Waits on cond until pred holds or the tick timeout expires; caller holds lock.
+#define HOST_WAIT_UNTIL(pred, cond, lock, ticks)                                    \
+    ({                                                                              \
+        bool ok_ = true;                                                            \
+        struct timespec dl_ = host_deadline(ticks);                                 \
+        while (!(pred))                                                             \
+        {                                                                           \
+            if ((ticks) == 0)                                                       \
+            {                                                                       \
+                ok_ = false;                                                        \
+                break;                                                              \
+            }                                                                       \
+            if ((ticks) == portMAX_DELAY)                                           \
+            {                                                                       \
+                pthread_cond_wait((cond), (lock));                                  \
+            }                                                                       \
+            else if (pthread_cond_timedwait((cond), (lock), &dl_) == ETIMEDOUT)     \
+            {                                                                       \
+                ok_ = (pred);                                                       \
+                break;                                                              \
+            }                                                                       \
+        }                                                                           \
+        ok_;                                                                        \
+    })
+
+static struct host_task *host_task_new(TaskFunction_t fn, void *arg)
+{
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&task->lock, NULL);
+    host_cond_init(&task->cond);
+    task->fn = fn;
+    task->arg = arg;
+    return task;
+}
+
+static void *host_task_entry(void *arg)
+{
+    struct host_task *task = arg;
+    s_current = task;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core)
+{
+    (void)name;
+    (void)stack;
+    (void)prio;
+    (void)core;
+    struct host_task *task = host_task_new(fn, arg);
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+    if (out != NULL)
+    {
+        *out = task;
+    }
+    if (pthread_create(&task->thread, NULL, host_task_entry, task) != 0)
+    {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio,
+                       TaskHandle_t *out)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == s_current)
+    {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(task->thread);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (s_current == NULL)
+    {
+        // Threads not created through xTaskCreate (the test's main) get a handle on first use.
+        s_current = host_task_new(NULL, NULL);
+        s_current->thread = pthread_self();
+    }
+    return s_current;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(ticks / configTICK_RATE_HZ),
+        .tv_nsec = (long)(ticks % configTICK_RATE_HZ) * portTICK_PERIOD_MS * 1000000L,
+    };
+    if (ticks == 0)
+    {
+        sched_yield();
+        return;
+    }
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (portTICK_PERIOD_MS * 1000));
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken != NULL)
+    {
+        *woken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&task->lock);
+    HOST_WAIT_UNTIL(task->notify > 0, &task->cond, &task->lock, ticks);
+    uint32_t value = task->notify;
+    if (value > 0)
+    {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+static SemaphoreHandle_t host_semaphore_new(bool recursive)
+{
+    struct host_semaphore *sem = calloc(1, sizeof(*sem));
+    if (sem == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    host_cond_init(&sem->cond);
+    sem->recursive = recursive;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return host_semaphore_new(false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return host_semaphore_new(true);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem != NULL)
+    {
+        pthread_cond_destroy(&sem->cond);
+        pthread_mutex_destroy(&sem->lock);
+        free(sem);
+    }
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    const pthread_t self = pthread_self();
+    pthread_mutex_lock(&sem->lock);
+    bool ok = HOST_WAIT_UNTIL(sem->depth == 0 || (sem->recursive && pthread_equal(sem->owner, self)),
+                              &sem->cond, &sem->lock, ticks);
+    if (ok)
+    {
+        sem->owner = self;
+        sem->depth++;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    if (sem->depth == 0)
+    {
+        pthread_mutex_unlock(&sem->lock);
+        return pdFALSE;
+    }
+    if (--sem->depth == 0)
+    {
+        pthread_cond_broadcast(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL)
+    {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    host_cond_init(&queue->cond);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (queue != NULL)
+    {
+        free(queue->items);
+        free(queue);
+    }
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    pthread_mutex_lock(&queue->lock);
+    bool ok = HOST_WAIT_UNTIL(queue->count < queue->length, &queue->cond, &queue->lock, ticks);
+    if (ok)
+    {
+        size_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *out, TickType_t ticks)
+{
+    pthread_mutex_lock(&queue->lock);
+    bool ok = HOST_WAIT_UNTIL(queue->count > 0, &queue->cond, &queue->lock, ticks);
+    if (ok)
+    {
+        memcpy(out, &queue->items[queue->head * queue->item_size], queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
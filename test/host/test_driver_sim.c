@@ -0,0 +1,130 @@
+// Host test of the TMC2209 driver against the simulator, with no IDF UART anywhere in the
+// build: transport switching, scan (probe accounting), IFCNT-checked batches under injected
+// write loss, async bus transfers, and the full acceptance sequence used by the boot canary.
+
+#include <stdlib.h>
+
+#include "driver_acceptance.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_test.h"
+#include "json_helpers.h"
+#include "stepper_driver_uart.h"
+#include "tmc2209_regs.h"
+#include "tmc2209_sim.h"
+
+static void test_no_transport(void)
+{
+    HOST_CHECK_STR(stepper_uart_get_hal()->name, "none");
+    HOST_CHECK(stepper_driver_ping() != ESP_OK);
+}
+
+static void test_scan_counts_probes(void)
+{
+    stepper_uart_stats_t before;
+    stepper_uart_stats_t after;
+    HOST_CHECK_EQ_U(stepper_uart_reset_stats(), ESP_OK);
+    stepper_uart_get_stats(&before);
+    stepper_driver_scan_t scan;
+    HOST_CHECK_EQ_U(stepper_driver_scan(&scan), ESP_OK);
+    stepper_uart_get_stats(&after);
+    HOST_CHECK_EQ_U(scan.count, 1);
+    HOST_CHECK_EQ_U(scan.active, 0);
+    HOST_CHECK(scan.slaves[0].present && scan.slaves[0].ifcnt_ok);
+    // IOIN on all four addresses plus IFCNT on the one that answered; no timeouts recorded.
+    HOST_CHECK_EQ_U(after.probes - before.probes, STEPPER_TMC_MAX_SLAVES + 1);
+    HOST_CHECK_EQ_U(after.reads, before.reads);
+    HOST_CHECK_EQ_U(after.timeout, before.timeout);
+}
+
+static void test_batch_recovers_lost_writes(void)
+{
+    const stepper_uart_write_t writes[] = {
+        {.reg = TMC2209_REG_GCONF, .value = 0x000000C0},
+        {.reg = TMC2209_REG_IHOLD_IRUN, .value = 0x00010A02},
+        {.reg = TMC2209_REG_TPOWERDOWN, .value = 0x00000014},
+        {.reg = TMC2209_REG_CHOPCONF, .value = 0x14000053},
+    };
+    const tmc2209_sim_faults_t faults = {.lose_pct = 20};
+    tmc2209_sim_seed(7);
+    tmc2209_sim_set_faults(&faults);
+    for (int round = 0; round < 10; ++round)
+    {
+        HOST_CHECK_EQ_U(stepper_uart_write_batch(0, writes, sizeof(writes) / sizeof(writes[0])), ESP_OK);
+    }
+    tmc2209_sim_set_faults(NULL);
+    HOST_CHECK_EQ_U(tmc2209_sim_peek_reg(TMC2209_REG_GCONF), writes[0].value);
+    HOST_CHECK_EQ_U(tmc2209_sim_peek_reg(TMC2209_REG_CHOPCONF), writes[3].value);
+    // IHOLD_IRUN is write-only; the sim reports IRUN back as DRV_STATUS.CS_ACTUAL.
+    HOST_CHECK_EQ_U(TMC2209_FIELD_GET(tmc2209_sim_peek_reg(TMC2209_REG_DRV_STATUS), DRV_STATUS, CS_ACTUAL), 0x0A);
+    stepper_uart_stats_t stats;
+    stepper_uart_get_stats(&stats);
+    HOST_CHECK(stats.write_lost > 0);
+}
+
+static void test_async_read(void)
+{
+    stepper_uart_xfer_t xfer = {
+        .op = STEPPER_UART_OP_READ,
+        .prio = STEPPER_UART_PRIO_TELEMETRY,
+        .slave = 0,
+        .reg = TMC2209_REG_IOIN,
+        .notify_task = xTaskGetCurrentTaskHandle(),
+    };
+    HOST_CHECK_EQ_U(stepper_uart_submit(&xfer), ESP_OK);
+    HOST_CHECK(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) > 0);
+    HOST_CHECK_EQ_U(xfer.result, ESP_OK);
+    HOST_CHECK_EQ_U(TMC2209_FIELD_GET(xfer.value, IOIN, VERSION), 0x21);
+}
+
+static void test_acceptance(const char *expect_overall, const char *expect_first_error)
+{
+    driver_acceptance_result_t result;
+    driver_acceptance_run(&result);
+    char buf[512];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    HOST_CHECK(driver_acceptance_write_json(&result, &w));
+    printf("%s\n", buf);
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "{\"overall\":\"%s\"", expect_overall);
+    HOST_CHECK(strncmp(buf, prefix, strlen(prefix)) == 0);
+    if (expect_first_error == NULL)
+    {
+        HOST_CHECK_EQ_U(result.error_count, 0);
+        HOST_CHECK_EQ_U(result.cs31, 31);
+        HOST_CHECK_EQ_U(result.cs2, 10);
+        HOST_CHECK_EQ_U(result.microsteps, 16);
+        HOST_CHECK_EQ_U(result.stealthchop, 0);
+    }
+    else
+    {
+        HOST_CHECK(result.error_count > 0);
+        HOST_CHECK_STR(result.errors[0], expect_first_error);
+    }
+}
+
+int main(void)
+{
+    test_no_transport();
+
+    HOST_CHECK_EQ_U(stepper_uart_set_hal(tmc2209_sim_hal()), ESP_OK);
+    HOST_CHECK_STR(stepper_uart_get_hal()->name, "sim");
+    HOST_CHECK_EQ_U(stepper_driver_ping(), ESP_OK);
+    test_scan_counts_probes();
+    test_batch_recovers_lost_writes();
+    test_async_read();
+
+    tmc2209_sim_reset();
+    test_acceptance("PASS", NULL);
+
+    // Driver still addresses slave 0; the sim now answers only on 2, so every read times out.
+    tmc2209_sim_set_slave(2);
+    test_acceptance("FAIL", "microsteps_set");
+    tmc2209_sim_set_slave(0);
+
+    // NULL restores the default transport, which on the host is still "none".
+    HOST_CHECK_EQ_U(stepper_uart_set_hal(NULL), ESP_OK);
+    test_no_transport();
+    return HOST_TEST_RESULT("test_driver_sim");
+}
@@ -0,0 +1,140 @@
+// Multi-producer stress of the lock-free event ring: several threads emit concurrently while
+// a reader tails the ring. Every record a reader gets back must be whole (type, code and
+// reason all from the same emit) and tails must come back oldest-first with increasing ids.
+// Drops are allowed (a producer preempted for a full lap); torn records are not.
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "events.h"
+#include "host_test.h"
+
+#define PRODUCERS 4
+#define EMITS_PER_PRODUCER 50000
+#define RING_CAPACITY 64 // EVENTS_CAPACITY in events.c
+
+typedef struct
+{
+    int index;
+    uint32_t emitted;
+    uint32_t dropped;
+} producer_t;
+
+typedef struct
+{
+    uint32_t records;
+    uint32_t torn;
+    uint32_t out_of_order;
+    uint32_t last_id;
+} tail_check_t;
+
+static volatile bool s_producers_done;
+
+static void *producer_main(void *arg)
+{
+    producer_t *p = arg;
+    char type[EVENTS_TYPE_MAX];
+    char reason[EVENTS_REASON_MAX];
+    snprintf(type, sizeof(type), "p%d", p->index);
+    for (int seq = 0; seq < EMITS_PER_PRODUCER; ++seq)
+    {
+        snprintf(reason, sizeof(reason), "p%d:%d", p->index, seq);
+        if (events_emit(type, "stress", seq, reason))
+        {
+            p->emitted++;
+        }
+        else
+        {
+            p->dropped++;
+        }
+    }
+    return NULL;
+}
+
+static void check_record(const events_record_t *rec, void *ctx)
+{
+    tail_check_t *check = ctx;
+    char expect[EVENTS_REASON_MAX];
+    snprintf(expect, sizeof(expect), "%s:%d", rec->type, rec->code);
+    if (rec->type[0] != 'p' || strcmp(rec->subsystem, "stress") != 0 || strcmp(rec->reason, expect) != 0)
+    {
+        if (check->torn++ == 0)
+        {
+            fprintf(stderr, "torn record id %lu: type %s subsystem %s code %d reason %s\n",
+                    (unsigned long)rec->id, rec->type, rec->subsystem, rec->code, rec->reason);
+        }
+    }
+    if (check->records > 0 && (int32_t)(rec->id - check->last_id) <= 0)
+    {
+        check->out_of_order++;
+    }
+    check->last_id = rec->id;
+    check->records++;
+}
+
+static void *reader_main(void *arg)
+{
+    tail_check_t *total = arg;
+    while (!__atomic_load_n(&s_producers_done, __ATOMIC_ACQUIRE))
+    {
+        tail_check_t check = {0};
+        events_tail(RING_CAPACITY, check_record, &check);
+        total->records += check.records;
+        total->torn += check.torn;
+        total->out_of_order += check.out_of_order;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    events_init();
+    producer_t producers[PRODUCERS];
+    pthread_t producer_threads[PRODUCERS];
+    pthread_t reader_thread;
+    tail_check_t during = {0};
+
+    HOST_CHECK(pthread_create(&reader_thread, NULL, reader_main, &during) == 0);
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        producers[i] = (producer_t){.index = i};
+        HOST_CHECK(pthread_create(&producer_threads[i], NULL, producer_main, &producers[i]) == 0);
+    }
+    uint32_t emitted = 0;
+    uint32_t dropped = 0;
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        pthread_join(producer_threads[i], NULL);
+        emitted += producers[i].emitted;
+        dropped += producers[i].dropped;
+    }
+    __atomic_store_n(&s_producers_done, true, __ATOMIC_RELEASE);
+    pthread_join(reader_thread, NULL);
+
+    HOST_CHECK_EQ_U(emitted + dropped, PRODUCERS * EMITS_PER_PRODUCER);
+    HOST_CHECK(emitted > 0);
+    HOST_CHECK_EQ_U(during.torn, 0);
+    HOST_CHECK_EQ_U(during.out_of_order, 0);
+
+    // Quiescent ring: everything still in it reads back whole, newest last.
+    tail_check_t after = {0};
+    events_tail(RING_CAPACITY, check_record, &after);
+    HOST_CHECK(after.records > 0 && after.records <= RING_CAPACITY);
+    HOST_CHECK_EQ_U(after.torn, 0);
+    HOST_CHECK_EQ_U(after.out_of_order, 0);
+    HOST_CHECK(after.last_id <= PRODUCERS * EMITS_PER_PRODUCER &&
+               after.last_id > PRODUCERS * EMITS_PER_PRODUCER - RING_CAPACITY);
+
+    // Clear hides everything emitted so far; new records still show up.
+    HOST_CHECK(events_clear());
+    tail_check_t cleared = {0};
+    events_tail(RING_CAPACITY, check_record, &cleared);
+    HOST_CHECK_EQ_U(cleared.records, 0);
+    HOST_CHECK(events_emit("p0", "stress", 7, "p0:7"));
+    events_tail(RING_CAPACITY, check_record, &cleared);
+    HOST_CHECK_EQ_U(cleared.records, 1);
+
+    printf("{\"emitted\":%lu,\"dropped\":%lu,\"tail_records\":%lu}\n", (unsigned long)emitted,
+           (unsigned long)dropped, (unsigned long)during.records);
+    return HOST_TEST_RESULT("test_events_stress");
+}
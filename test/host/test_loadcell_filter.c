@@ -0,0 +1,185 @@
+// Host test of the load cell filter chain: exact unity DC gain of the Q14 notch across rates
+// and centre frequencies, per-stage behaviour, and the default-style chain run over a trace.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "loadcell_filter.h"
+
+#define TRACE_MAX 2048
+
+static const uint16_t k_sample_rates[] = {10, 40, 80, 320};
+static const int32_t k_dc_inputs[] = {0, 1, -1, 123456, -98765, 8388607, -8388608};
+
+static void test_notch_dc_gain_exact(void)
+{
+    for (size_t i = 0; i < sizeof(k_sample_rates) / sizeof(k_sample_rates[0]); ++i)
+    {
+        const uint16_t hz = k_sample_rates[i];
+        for (uint16_t f = 1; (uint32_t)f * 2U < hz; ++f)
+        {
+            loadcell_filter_chain_t chain;
+            loadcell_filter_chain_init(&chain, hz);
+            HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_NOTCH, f), ESP_OK);
+            const loadcell_filter_stage_t *st = &chain.stages[0];
+            HOST_CHECK_EQ_U(st->b0 + st->b1 + st->b2, 16384 + st->a1 + st->a2);
+            for (size_t k = 0; k < sizeof(k_dc_inputs) / sizeof(k_dc_inputs[0]); ++k)
+            {
+                loadcell_filter_chain_reset(&chain);
+                int32_t y = 0;
+                for (int n = 0; n < 400; ++n)
+                {
+                    y = loadcell_filter_chain_apply(&chain, k_dc_inputs[k]);
+                }
+                if (y != k_dc_inputs[k])
+                {
+                    fprintf(stderr, "notch %u Hz @ %u SPS: DC %ld -> %ld\n", (unsigned)f, (unsigned)hz,
+                            (long)k_dc_inputs[k], (long)y);
+                    s_host_test_failures++;
+                }
+            }
+        }
+    }
+}
+
+// Peak-to-peak of the notch output for a sine at freq_hz, after the transient has decayed.
+static int32_t notch_sine_p2p(uint16_t notch_hz, float freq_hz)
+{
+    loadcell_filter_chain_t chain;
+    loadcell_filter_chain_init(&chain, 80);
+    loadcell_filter_chain_add(&chain, LOADCELL_FILTER_NOTCH, notch_hz);
+    int32_t lo = INT32_MAX;
+    int32_t hi = INT32_MIN;
+    for (int n = 0; n < 1600; ++n)
+    {
+        int32_t x = 50000 + (int32_t)lroundf(10000.0f * sinf(2.0f * (float)M_PI * freq_hz * (float)n / 80.0f));
+        int32_t y = loadcell_filter_chain_apply(&chain, x);
+        if (n >= 800)
+        {
+            lo = (y < lo) ? y : lo;
+            hi = (y > hi) ? y : hi;
+        }
+    }
+    return hi - lo;
+}
+
+static void test_notch_response(void)
+{
+    // 20000 p-p in: at the centre frequency the residue is a few counts, well off it the
+    // signal passes almost untouched.
+    HOST_CHECK(notch_sine_p2p(2, 2.0f) < 100);
+    HOST_CHECK(notch_sine_p2p(2, 20.0f) > 19000);
+}
+
+static void test_median_rejects_spike(void)
+{
+    loadcell_filter_chain_t chain;
+    loadcell_filter_chain_init(&chain, 80);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_MEDIAN, 3), ESP_OK);
+    const int32_t in[] = {10, 10, 900000, 10, 10, -900000, 10, 10};
+    for (size_t i = 0; i < sizeof(in) / sizeof(in[0]); ++i)
+    {
+        HOST_CHECK_EQ_U(loadcell_filter_chain_apply(&chain, in[i]), 10);
+    }
+}
+
+static void test_ma_and_iir_dc(void)
+{
+    loadcell_filter_chain_t chain;
+    loadcell_filter_chain_init(&chain, 80);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_MA, 16), ESP_OK);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_IIR, 8), ESP_OK);
+    int32_t y = 0;
+    for (int n = 0; n < 4000; ++n)
+    {
+        y = loadcell_filter_chain_apply(&chain, -777777);
+    }
+    HOST_CHECK(y == -777777);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_MEDIAN, 4), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_NOTCH, 40), ESP_ERR_INVALID_ARG);
+}
+
+static void test_set_sample_rate_drops_notch(void)
+{
+    loadcell_filter_chain_t chain;
+    loadcell_filter_chain_init(&chain, 80);
+    loadcell_filter_chain_add(&chain, LOADCELL_FILTER_MEDIAN, 3);
+    loadcell_filter_chain_add(&chain, LOADCELL_FILTER_NOTCH, 8);
+    loadcell_filter_chain_set_sample_rate(&chain, 10);
+    HOST_CHECK_EQ_U(chain.count, 1);
+    HOST_CHECK_EQ_U(chain.stages[0].kind, LOADCELL_FILTER_MEDIAN);
+    char buf[128];
+    HOST_CHECK(loadcell_filter_chain_get_json(&chain, buf, sizeof(buf)));
+    HOST_CHECK_STR(buf, "[{\"type\":\"median\",\"param\":3}]");
+    // One byte short of the text plus its NUL fails instead of truncating.
+    HOST_CHECK(!loadcell_filter_chain_get_json(&chain, buf, strlen(buf)));
+}
+
+// Reads "raw,load" rows; '#' comment lines and the header are skipped.
+static size_t load_trace(const char *path, int32_t *raw, int32_t *load, size_t max)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 0;
+    }
+    char line[128];
+    size_t n = 0;
+    while (n < max && fgets(line, sizeof(line), f) != NULL)
+    {
+        long r = 0;
+        long l = 0;
+        if (line[0] != '#' && sscanf(line, "%ld,%ld", &r, &l) == 2)
+        {
+            raw[n] = (int32_t)r;
+            load[n] = (int32_t)l;
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+static void test_trace(void)
+{
+    static int32_t raw[TRACE_MAX];
+    static int32_t load[TRACE_MAX];
+    const size_t n = load_trace(FW_HOST_TRACE_DIR "/loadcell_80sps_vibration.csv", raw, load, TRACE_MAX);
+    HOST_CHECK(n >= 800);
+    loadcell_filter_chain_t chain;
+    loadcell_filter_chain_init(&chain, 80);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_MEDIAN, 3), ESP_OK);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_NOTCH, 2), ESP_OK);
+    HOST_CHECK_EQ_U(loadcell_filter_chain_add(&chain, LOADCELL_FILTER_MA, 8), ESP_OK);
+    int32_t worst_raw = 0;
+    int32_t worst = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int32_t y = loadcell_filter_chain_apply(&chain, raw[i]);
+        // Skip the settling time after the start and after the load step.
+        if ((i >= 160 && i < 400) || i >= 560)
+        {
+            const int32_t e_raw = abs(raw[i] - load[i]);
+            const int32_t e = abs(y - load[i]);
+            worst_raw = (e_raw > worst_raw) ? e_raw : worst_raw;
+            worst = (e > worst) ? e : worst;
+        }
+    }
+    printf("trace: %zu samples, worst error raw %ld, filtered %ld counts\n", n, (long)worst_raw, (long)worst);
+    // Spikes and vibration dominate the raw error; what remains after filtering is noise.
+    HOST_CHECK(worst_raw > 50000);
+    HOST_CHECK(worst < 150);
+}
+
+int main(void)
+{
+    test_notch_dc_gain_exact();
+    test_notch_response();
+    test_median_rejects_spike();
+    test_ma_and_iir_dc();
+    test_set_sample_rate_drops_notch();
+    test_trace();
+    return HOST_TEST_RESULT("test_loadcell_filter");
+}
@@ -0,0 +1,171 @@
+// Stress of the load cell sample ring: one producer pushes samples as fast as it can while
+// several readers fetch the newest ones and stream with cursors. Every sample a reader gets
+// back must be whole (raw and ts_us both derived from its seq); misses are allowed (the
+// slot was overwritten or being written), torn samples are not.
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "loadcell_ring.h"
+
+#define READERS 3
+#define PUSHES 2000000u
+
+typedef struct
+{
+    uint32_t got;
+    uint32_t missed;
+    uint32_t torn;
+    uint32_t out_of_order;
+} reader_stats_t;
+
+static loadcell_ring_t s_ring;
+static volatile bool s_done;
+
+// raw and ts_us are both functions of seq, so a mix of two writes cannot pass.
+static int32_t sample_raw(uint32_t seq)
+{
+    return (int32_t)(seq * 2654435761u);
+}
+
+static int64_t sample_ts(uint32_t seq)
+{
+    return (int64_t)seq * 12500 + 7;
+}
+
+static void check_sample(reader_stats_t *st, uint32_t seq, const loadcell_sample_t *s)
+{
+    if (s->seq != seq || s->raw != sample_raw(seq) || s->ts_us != sample_ts(seq))
+    {
+        if (st->torn++ == 0)
+        {
+            fprintf(stderr, "torn sample seq %lu: got seq %lu raw %ld ts %lld\n", (unsigned long)seq,
+                    (unsigned long)s->seq, (long)s->raw, (long long)s->ts_us);
+        }
+    }
+    st->got++;
+}
+
+static void *producer_main(void *arg)
+{
+    (void)arg;
+    for (uint32_t i = 0; i < PUSHES; ++i)
+    {
+        loadcell_ring_push(&s_ring, sample_raw(i), sample_ts(i));
+    }
+    __atomic_store_n(&s_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Mixes newest-sample reads, reads of the slot about to be overwritten, and a cursor walk
+// over the last ring's worth.
+static void *reader_main(void *arg)
+{
+    reader_stats_t *st = arg;
+    uint32_t cursor = 0;
+    while (!__atomic_load_n(&s_done, __ATOMIC_ACQUIRE))
+    {
+        uint32_t head = loadcell_ring_head(&s_ring);
+        if (head == 0)
+        {
+            continue;
+        }
+        loadcell_sample_t s;
+        if (loadcell_ring_get(&s_ring, head - 1, &s))
+        {
+            check_sample(st, head - 1, &s);
+        }
+        else
+        {
+            st->missed++;
+        }
+        // The oldest sample's slot is the next one the producer overwrites.
+        for (int i = 0; i < 8 && head >= LOADCELL_RING_LEN; ++i)
+        {
+            const uint32_t oldest = head - LOADCELL_RING_LEN;
+            if (loadcell_ring_get(&s_ring, oldest, &s))
+            {
+                check_sample(st, oldest, &s);
+            }
+            else
+            {
+                st->missed++;
+            }
+        }
+        if (head - cursor > LOADCELL_RING_LEN)
+        {
+            cursor = head - LOADCELL_RING_LEN;
+        }
+        uint32_t last = 0;
+        bool have_last = false;
+        for (; cursor != head; ++cursor)
+        {
+            if (!loadcell_ring_get(&s_ring, cursor, &s))
+            {
+                st->missed++;
+                continue;
+            }
+            check_sample(st, cursor, &s);
+            if (have_last && (int32_t)(s.seq - last) <= 0)
+            {
+                st->out_of_order++;
+            }
+            last = s.seq;
+            have_last = true;
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t producer;
+    pthread_t readers[READERS];
+    reader_stats_t stats[READERS] = {0};
+    for (int i = 0; i < READERS; ++i)
+    {
+        HOST_CHECK(pthread_create(&readers[i], NULL, reader_main, &stats[i]) == 0);
+    }
+    HOST_CHECK(pthread_create(&producer, NULL, producer_main, NULL) == 0);
+    pthread_join(producer, NULL);
+    reader_stats_t total = {0};
+    for (int i = 0; i < READERS; ++i)
+    {
+        pthread_join(readers[i], NULL);
+        total.got += stats[i].got;
+        total.missed += stats[i].missed;
+        total.torn += stats[i].torn;
+        total.out_of_order += stats[i].out_of_order;
+    }
+    HOST_CHECK(total.got > 0);
+    HOST_CHECK_EQ_U(total.torn, 0);
+    HOST_CHECK_EQ_U(total.out_of_order, 0);
+
+    // Quiescent: the newest ring's worth reads back whole, anything older is gone.
+    HOST_CHECK_EQ_U(loadcell_ring_head(&s_ring), PUSHES);
+    reader_stats_t after = {0};
+    for (uint32_t seq = PUSHES - LOADCELL_RING_LEN; seq != PUSHES; ++seq)
+    {
+        loadcell_sample_t s;
+        HOST_CHECK(loadcell_ring_get(&s_ring, seq, &s));
+        check_sample(&after, seq, &s);
+    }
+    HOST_CHECK_EQ_U(after.torn, 0);
+    loadcell_sample_t old;
+    HOST_CHECK(!loadcell_ring_get(&s_ring, PUSHES - LOADCELL_RING_LEN - 1, &old));
+
+    // Invalidate (gain switch): everything buffered disappears, new pushes are visible.
+    loadcell_ring_invalidate(&s_ring);
+    HOST_CHECK_EQ_U(loadcell_ring_valid_from(&s_ring), PUSHES);
+    HOST_CHECK(!loadcell_ring_get(&s_ring, PUSHES - 1, &old));
+    HOST_CHECK_EQ_U(loadcell_ring_push(&s_ring, sample_raw(PUSHES), sample_ts(PUSHES)), PUSHES);
+    loadcell_sample_t s;
+    HOST_CHECK(loadcell_ring_get(&s_ring, PUSHES, &s));
+    check_sample(&after, PUSHES, &s);
+    HOST_CHECK_EQ_U(after.torn, 0);
+
+    printf("{\"pushes\":%lu,\"got\":%lu,\"missed\":%lu}\n", (unsigned long)PUSHES, (unsigned long)total.got,
+           (unsigned long)total.missed);
+    return HOST_TEST_RESULT("test_loadcell_ring");
+}
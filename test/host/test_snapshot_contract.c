@@ -0,0 +1,292 @@
+// Host check of the snapshot schema against docs/firmware_contract.md: the documented
+// top-level keys (plus the optional objects) and the compiled X-macro table must be the same
+// set, and the built snapshot must carry exactly the table's keys, in table order. Each
+// object's fallback must carry the same keys as the object it stands in for.
+
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "snapshot.h"
+
+#define MAX_KEYS 32
+#define KEY_MAX 32
+
+typedef struct
+{
+    char keys[MAX_KEYS][KEY_MAX];
+    size_t count;
+} key_set_t;
+
+static bool key_set_has(const key_set_t *set, const char *key)
+{
+    for (size_t i = 0; i < set->count; ++i)
+    {
+        if (strcmp(set->keys[i], key) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void key_set_add(key_set_t *set, const char *key, size_t len)
+{
+    if (set->count < MAX_KEYS && len < KEY_MAX)
+    {
+        memcpy(set->keys[set->count], key, len);
+        set->keys[set->count][len] = '\0';
+        set->count++;
+    }
+}
+
+// Adds every `identifier` in text (up to limit occurrences; 0 for all).
+static void add_backticked(key_set_t *set, const char *text, size_t limit)
+{
+    size_t added = 0;
+    const char *p = text;
+    while ((p = strchr(p, '`')) != NULL && (limit == 0 || added < limit))
+    {
+        const char *end = strchr(p + 1, '`');
+        if (end == NULL)
+        {
+            break;
+        }
+        key_set_add(set, p + 1, (size_t)(end - p - 1));
+        added++;
+        p = end + 1;
+    }
+}
+
+// Same rules as main/CMakeLists.txt: the first "  - Top-level keys:" line, and the key of each
+// "  - Optional `key` object" line.
+static bool parse_contract(const char *path, key_set_t *required, key_set_t *optional)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    char line[2048];
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (required->count == 0 && strncmp(line, "  - Top-level keys:", 19) == 0)
+        {
+            add_backticked(required, line, 0);
+        }
+        else if (strncmp(line, "  - Optional `", 14) == 0)
+        {
+            add_backticked(optional, line, 1);
+        }
+    }
+    fclose(f);
+    return required->count > 0;
+}
+
+// Top-level keys of a JSON object, in order; nested objects, arrays and strings are skipped.
+static bool parse_top_level_keys(const char *json, key_set_t *out)
+{
+    int depth = 0;
+    bool expect_key = false;
+    for (const char *p = json; *p != '\0'; ++p)
+    {
+        if (*p == '"')
+        {
+            const char *start = p + 1;
+            for (++p; *p != '"'; ++p)
+            {
+                if (*p == '\0')
+                {
+                    return false;
+                }
+                if (*p == '\\' && p[1] != '\0')
+                {
+                    ++p;
+                }
+            }
+            if (depth == 1 && expect_key)
+            {
+                key_set_add(out, start, (size_t)(p - start));
+                expect_key = false;
+            }
+        }
+        else if (*p == '{' || *p == '[')
+        {
+            depth++;
+            expect_key = (depth == 1);
+        }
+        else if (*p == '}' || *p == ']')
+        {
+            depth--;
+        }
+        else if (*p == ',' && depth == 1)
+        {
+            expect_key = true;
+        }
+    }
+    return depth == 0;
+}
+
+// Copies the value of top-level member key (a nested object or scalar) into out.
+static bool copy_top_level_value(const char *json, const char *key, char *out, size_t out_len)
+{
+    char pattern[KEY_MAX + 4];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *start = strstr(json, pattern);
+    if (start == NULL)
+    {
+        return false;
+    }
+    start += strlen(pattern);
+    int depth = 0;
+    bool in_str = false;
+    const char *p = start;
+    for (; *p != '\0'; ++p)
+    {
+        if (in_str)
+        {
+            if (*p == '\\' && p[1] != '\0')
+            {
+                ++p;
+            }
+            else if (*p == '"')
+            {
+                in_str = false;
+            }
+            continue;
+        }
+        if (*p == '"')
+        {
+            in_str = true;
+        }
+        else if (*p == '{' || *p == '[')
+        {
+            depth++;
+        }
+        else if (*p == '}' || *p == ']')
+        {
+            if (depth == 0)
+            {
+                break;
+            }
+            depth--;
+        }
+        else if (*p == ',' && depth == 0)
+        {
+            break;
+        }
+    }
+    size_t len = (size_t)(p - start);
+    if (len >= out_len)
+    {
+        return false;
+    }
+    memcpy(out, start, len);
+    out[len] = '\0';
+    return true;
+}
+
+static void test_schema_matches_contract(void)
+{
+    key_set_t required = {0};
+    key_set_t optional = {0};
+    HOST_CHECK(parse_contract(FW_HOST_CONTRACT_DOC, &required, &optional));
+    HOST_CHECK(key_set_has(&optional, "boot"));
+    key_set_t schema = {0};
+    for (size_t i = 0; i < snapshot_field_count(); ++i)
+    {
+        const char *key = snapshot_field_key(i);
+        key_set_add(&schema, key, strlen(key));
+        if (!key_set_has(&required, key) && !key_set_has(&optional, key))
+        {
+            fprintf(stderr, "schema key %s is not documented\n", key);
+            s_host_test_failures++;
+        }
+    }
+    for (size_t i = 0; i < required.count; ++i)
+    {
+        if (!key_set_has(&schema, required.keys[i]))
+        {
+            fprintf(stderr, "documented key %s is not in the schema\n", required.keys[i]);
+            s_host_test_failures++;
+        }
+    }
+    // This build enables every optional object, so the schema is exactly required + optional.
+    HOST_CHECK_EQ_U(schema.count, required.count + optional.count);
+}
+
+static void test_output_matches_schema(void)
+{
+    static char buf[1024];
+    HOST_CHECK(snapshot_build(buf, sizeof(buf)));
+    HOST_CHECK(strpbrk(buf, "\r\n") == NULL);
+    key_set_t out = {0};
+    HOST_CHECK(parse_top_level_keys(buf, &out));
+    HOST_CHECK_EQ_U(out.count, snapshot_field_count());
+    for (size_t i = 0; i < out.count && i < snapshot_field_count(); ++i)
+    {
+        HOST_CHECK_STR(out.keys[i], snapshot_field_key(i));
+    }
+}
+
+static void test_fallbacks_match_output(void)
+{
+    static char buf[1024];
+    HOST_CHECK(snapshot_build(buf, sizeof(buf)));
+    size_t objects = 0;
+    for (size_t i = 0; i < snapshot_field_count(); ++i)
+    {
+        const char *key = snapshot_field_key(i);
+        char fallback[256];
+        if (!snapshot_field_fallback_json(i, fallback, sizeof(fallback)))
+        {
+            continue;
+        }
+        if (strcmp(fallback, "null") == 0)
+        {
+            continue;
+        }
+        char live[512];
+        HOST_CHECK(copy_top_level_value(buf, key, live, sizeof(live)));
+        key_set_t live_keys = {0};
+        key_set_t fallback_keys = {0};
+        HOST_CHECK(parse_top_level_keys(live, &live_keys));
+        HOST_CHECK(parse_top_level_keys(fallback, &fallback_keys));
+        HOST_CHECK(live_keys.count > 0);
+        HOST_CHECK_EQ_U(fallback_keys.count, live_keys.count);
+        for (size_t k = 0; k < live_keys.count && k < fallback_keys.count; ++k)
+        {
+            if (strcmp(fallback_keys.keys[k], live_keys.keys[k]) != 0)
+            {
+                fprintf(stderr, "%s fallback key %s, output key %s\n", key, fallback_keys.keys[k], live_keys.keys[k]);
+                s_host_test_failures++;
+            }
+        }
+        objects++;
+    }
+    // scale, motor and driver_uart.
+    HOST_CHECK_EQ_U(objects, 3);
+    char out[8];
+    HOST_CHECK(!snapshot_field_fallback_json(0, out, sizeof(out)));
+
+    // A buffer that is too small is a failed build, never an object swapped for its fallback.
+    const size_t full = strlen(buf);
+    static char small[1024];
+    for (size_t len = 1; len <= full; ++len)
+    {
+        if (snapshot_build(small, len))
+        {
+            fprintf(stderr, "snapshot built into %zu bytes: %s\n", len, small);
+            s_host_test_failures++;
+            break;
+        }
+    }
+}
+
+int main(void)
+{
+    test_schema_matches_contract();
+    test_output_matches_schema();
+    test_fallbacks_match_output();
+    return HOST_TEST_RESULT("test_snapshot_contract");
+}
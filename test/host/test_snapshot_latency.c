@@ -0,0 +1,74 @@
+// Snapshot latency guard: builds the snapshot repeatedly through snapshot_build_profiled() and
+// fails when the median build, or any single field, exceeds its host budget. The device budget
+// (SNAPSHOT_BUILD_BUDGET_US, checked by selftest) is far looser; these limits sit roughly ten
+// times above what the current fields need on a desktop CPU (about 9 us per build), so a field
+// that starts blocking or doing real work shows up here before it gets near the device limit.
+
+#include <stdlib.h>
+
+#include "esp_cpu.h"
+#include "host_test.h"
+#include "snapshot.h"
+
+#define ITERATIONS 2000
+#define MAX_FIELDS 24
+#define HOST_BUILD_BUDGET_US 100
+#define HOST_FIELD_BUDGET_US 25
+
+static uint32_t s_total[ITERATIONS];
+static uint32_t s_field[MAX_FIELDS][ITERATIONS];
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_us(uint32_t *cycles, size_t n)
+{
+    qsort(cycles, n, sizeof(cycles[0]), cmp_u32);
+    return (double)cycles[n / 2] / (double)HOST_CPU_TICKS_PER_US;
+}
+
+int main(void)
+{
+    static char buf[1024];
+    snapshot_field_timing_t timings[MAX_FIELDS];
+    const char *keys[MAX_FIELDS] = {0};
+    size_t count = 0;
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        uint32_t start = esp_cpu_get_cycle_count();
+        bool ok = snapshot_build_profiled(buf, sizeof(buf), timings, MAX_FIELDS, &count);
+        s_total[i] = esp_cpu_get_cycle_count() - start;
+        HOST_CHECK(ok);
+        HOST_CHECK_EQ_U(count, snapshot_field_count());
+        for (size_t f = 0; f < count && f < MAX_FIELDS; ++f)
+        {
+            keys[f] = timings[f].key;
+            s_field[f][i] = timings[f].cycles;
+        }
+    }
+
+    const double total_us = median_us(s_total, ITERATIONS);
+    printf("{\"iterations\":%d,\"bytes\":%zu,\"median_us\":%.2f,\"budget_us\":%d,\"fields_us\":{", ITERATIONS,
+           strlen(buf), total_us, HOST_BUILD_BUDGET_US);
+    for (size_t f = 0; f < count && f < MAX_FIELDS; ++f)
+    {
+        const double us = median_us(s_field[f], ITERATIONS);
+        printf("%s\"%s\":%.2f", (f > 0) ? "," : "", keys[f], us);
+        if (us > HOST_FIELD_BUDGET_US)
+        {
+            fprintf(stderr, "field %s: median %.2f us over the %d us budget\n", keys[f], us, HOST_FIELD_BUDGET_US);
+            s_host_test_failures++;
+        }
+    }
+    printf("}}\n");
+    if (total_us > HOST_BUILD_BUDGET_US)
+    {
+        fprintf(stderr, "snapshot build: median %.2f us over the %d us budget\n", total_us, HOST_BUILD_BUDGET_US);
+        s_host_test_failures++;
+    }
+    return HOST_TEST_RESULT("test_snapshot_latency");
+}
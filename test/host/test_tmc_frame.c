@@ -0,0 +1,237 @@
+// Host tests for the TMC2209 frame codec (main/tmc_frame.c): CRC against the datasheet's
+// bitwise reference, encode/decode round-trips, truncated and corrupted replies, and a
+// seeded random-byte fuzz of the reply scanner.
+
+#include "host_test.h"
+#include "tmc_frame.h"
+
+#define FUZZ_ITERATIONS 200000
+#define FUZZ_MAX_LEN 64
+
+// CRC8 exactly as the TMC2209 datasheet writes it: poly 0x07, bytes fed LSB-first.
+static uint8_t ref_crc(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        uint8_t byte = data[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            if (((crc >> 7) ^ (byte & 0x01)) != 0)
+            {
+                crc = (uint8_t)((crc << 1) ^ 0x07);
+            }
+            else
+            {
+                crc = (uint8_t)(crc << 1);
+            }
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
+
+// A reply frame as the driver sends it: sync, master address, register, value, CRC.
+static void make_reply(uint8_t out[TMC_FRAME_REPLY_LEN], uint8_t reg, uint32_t value)
+{
+    out[0] = TMC_FRAME_SYNC;
+    out[1] = TMC_FRAME_MASTER_ADDR;
+    out[2] = (uint8_t)(reg & 0x7F);
+    out[3] = (uint8_t)(value >> 24);
+    out[4] = (uint8_t)(value >> 16);
+    out[5] = (uint8_t)(value >> 8);
+    out[6] = (uint8_t)value;
+    out[7] = tmc_frame_crc(out, 7);
+}
+
+static void test_crc_matches_reference(void)
+{
+    // Datasheet example: read request for GCONF on slave 0.
+    const uint8_t gconf_read[3] = {0x05, 0x00, 0x00};
+    HOST_CHECK_EQ_U(tmc_frame_crc(gconf_read, 3), 0x48);
+
+    uint32_t rng = 0x1234567u;
+    uint8_t buf[16];
+    for (int iter = 0; iter < 10000; ++iter)
+    {
+        size_t len = host_rand(&rng) % sizeof(buf);
+        for (size_t i = 0; i < len; ++i)
+        {
+            buf[i] = (uint8_t)host_rand(&rng);
+        }
+        HOST_CHECK_EQ_U(tmc_frame_crc(buf, len), ref_crc(buf, len));
+    }
+}
+
+static void test_encode_layout(void)
+{
+    uint8_t req[TMC_FRAME_WRITE_REQ_LEN];
+    HOST_CHECK_EQ_U(tmc_frame_encode_read(req, 3, 0x86), TMC_FRAME_READ_REQ_LEN);
+    HOST_CHECK_EQ_U(req[0], TMC_FRAME_SYNC);
+    HOST_CHECK_EQ_U(req[1], 3);
+    HOST_CHECK_EQ_U(req[2], 0x06); // read requests never carry the write bit
+    HOST_CHECK_EQ_U(req[3], ref_crc(req, 3));
+
+    HOST_CHECK_EQ_U(tmc_frame_encode_write(req, 1, 0x10, 0x00011F0Au), TMC_FRAME_WRITE_REQ_LEN);
+    HOST_CHECK_EQ_U(req[0], TMC_FRAME_SYNC);
+    HOST_CHECK_EQ_U(req[1], 1);
+    HOST_CHECK_EQ_U(req[2], 0x90);
+    HOST_CHECK_EQ_U(req[3], 0x00);
+    HOST_CHECK_EQ_U(req[4], 0x01);
+    HOST_CHECK_EQ_U(req[5], 0x1F);
+    HOST_CHECK_EQ_U(req[6], 0x0A);
+    HOST_CHECK_EQ_U(req[7], ref_crc(req, 7));
+}
+
+static void test_round_trip(void)
+{
+    uint32_t rng = 0xC0FFEEu;
+    for (int iter = 0; iter < 20000; ++iter)
+    {
+        const uint8_t slave = (uint8_t)(host_rand(&rng) & 0x03);
+        const uint8_t reg = (uint8_t)(host_rand(&rng) & 0x7F);
+        const uint32_t value = host_rand(&rng);
+
+        // Single-wire RX sees the 4-byte request echo followed by the 8-byte reply.
+        uint8_t rx[TMC_FRAME_READ_REQ_LEN + TMC_FRAME_REPLY_LEN];
+        tmc_frame_encode_read(rx, slave, reg);
+        make_reply(&rx[TMC_FRAME_READ_REQ_LEN], reg, value);
+
+        const uint8_t *reply = NULL;
+        HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, sizeof(rx), reg, &reply), TMC_FRAME_OK);
+        HOST_CHECK(reply == &rx[TMC_FRAME_READ_REQ_LEN]);
+        if (reply != NULL)
+        {
+            HOST_CHECK_EQ_U(tmc_frame_reply_value(reply), value);
+        }
+
+        // Reply alone (echo already consumed) decodes the same.
+        reply = NULL;
+        HOST_CHECK_EQ_U(tmc_frame_decode_reply(&rx[TMC_FRAME_READ_REQ_LEN], TMC_FRAME_REPLY_LEN, reg, &reply),
+                        TMC_FRAME_OK);
+        HOST_CHECK(reply == &rx[TMC_FRAME_READ_REQ_LEN]);
+    }
+}
+
+static void test_echo_only_and_truncated(void)
+{
+    uint8_t rx[TMC_FRAME_READ_REQ_LEN + TMC_FRAME_REPLY_LEN];
+    tmc_frame_encode_read(rx, 0, 0x02);
+    make_reply(&rx[TMC_FRAME_READ_REQ_LEN], 0x02, 0x2A);
+
+    HOST_CHECK_EQ_U(tmc_frame_decode_reply(NULL, 12, 0x02, NULL), TMC_FRAME_SHORT);
+    for (size_t len = 0; len < TMC_FRAME_REPLY_LEN; ++len)
+    {
+        HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, len, 0x02, NULL), TMC_FRAME_SHORT);
+    }
+    // Echo plus a reply cut short by any number of bytes never decodes.
+    for (size_t len = TMC_FRAME_REPLY_LEN; len < sizeof(rx); ++len)
+    {
+        HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, len, 0x02, NULL), TMC_FRAME_CRC_FAIL);
+    }
+    // A write echo is 8 bytes with a valid CRC, but it is addressed to a slave, not the master.
+    uint8_t write_echo[TMC_FRAME_WRITE_REQ_LEN];
+    tmc_frame_encode_write(write_echo, 0, 0x02, 0x2A);
+    HOST_CHECK_EQ_U(tmc_frame_decode_reply(write_echo, sizeof(write_echo), 0x02, NULL), TMC_FRAME_CRC_FAIL);
+}
+
+static void test_corrupt_reply(void)
+{
+    uint8_t reply[TMC_FRAME_REPLY_LEN];
+    make_reply(reply, 0x6F, 0x80000140u);
+    // CRC8 detects every single-bit error, and a flipped sync/master byte fails the header check.
+    for (size_t byte = 0; byte < sizeof(reply); ++byte)
+    {
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            uint8_t bad[TMC_FRAME_REPLY_LEN];
+            memcpy(bad, reply, sizeof(bad));
+            bad[byte] ^= (uint8_t)(1u << bit);
+            HOST_CHECK_EQ_U(tmc_frame_decode_reply(bad, sizeof(bad), 0x6F, NULL), TMC_FRAME_CRC_FAIL);
+        }
+    }
+}
+
+static void test_wrong_reg_and_last_reply(void)
+{
+    uint8_t rx[2 * TMC_FRAME_REPLY_LEN];
+    make_reply(rx, 0x6F, 1);
+    HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, TMC_FRAME_REPLY_LEN, 0x02, NULL), TMC_FRAME_WRONG_REG);
+    // The write bit on the requested register is ignored.
+    HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, TMC_FRAME_REPLY_LEN, 0xEF, NULL), TMC_FRAME_OK);
+
+    // Two valid replies for the same register: the later one is the answer to this request.
+    make_reply(&rx[TMC_FRAME_REPLY_LEN], 0x6F, 2);
+    const uint8_t *reply = NULL;
+    HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, sizeof(rx), 0x6F, &reply), TMC_FRAME_OK);
+    HOST_CHECK(reply == &rx[TMC_FRAME_REPLY_LEN]);
+    HOST_CHECK_EQ_U(tmc_frame_reply_value(reply), 2);
+
+    // A stale reply for another register after ours does not hide ours.
+    make_reply(rx, 0x6F, 3);
+    make_reply(&rx[TMC_FRAME_REPLY_LEN], 0x41, 4);
+    reply = NULL;
+    HOST_CHECK_EQ_U(tmc_frame_decode_reply(rx, sizeof(rx), 0x6F, &reply), TMC_FRAME_OK);
+    HOST_CHECK(reply == rx);
+}
+
+// Random bytes, with and without a valid reply planted at a random offset. The decoder must
+// stay inside the buffer and anything it accepts must be a well-formed reply for the register.
+static void test_fuzz(void)
+{
+    uint32_t rng = 0x9E3779B9u;
+    uint8_t rx[FUZZ_MAX_LEN];
+    unsigned accepted = 0;
+    for (int iter = 0; iter < FUZZ_ITERATIONS; ++iter)
+    {
+        const size_t len = host_rand(&rng) % (FUZZ_MAX_LEN + 1);
+        const uint8_t reg = (uint8_t)(host_rand(&rng) & 0x7F);
+        for (size_t i = 0; i < len; ++i)
+        {
+            // Bias towards sync/master bytes so the header filter is actually exercised.
+            const uint32_t r = host_rand(&rng);
+            rx[i] = ((r & 0x300) == 0) ? TMC_FRAME_SYNC : ((r & 0x300) == 0x100) ? TMC_FRAME_MASTER_ADDR : (uint8_t)r;
+        }
+        size_t planted = len;
+        if (len >= TMC_FRAME_REPLY_LEN && (iter & 1) != 0)
+        {
+            planted = host_rand(&rng) % (len - TMC_FRAME_REPLY_LEN + 1);
+            make_reply(&rx[planted], reg, host_rand(&rng));
+        }
+
+        const uint8_t *reply = NULL;
+        const tmc_frame_status_t status = tmc_frame_decode_reply(rx, len, reg, &reply);
+        if (len < TMC_FRAME_REPLY_LEN)
+        {
+            HOST_CHECK_EQ_U(status, TMC_FRAME_SHORT);
+            continue;
+        }
+        if (planted < len)
+        {
+            HOST_CHECK_EQ_U(status, TMC_FRAME_OK);
+            HOST_CHECK(reply >= &rx[planted]);
+        }
+        if (status == TMC_FRAME_OK)
+        {
+            accepted++;
+            HOST_CHECK(reply >= rx && reply + TMC_FRAME_REPLY_LEN <= rx + len);
+            HOST_CHECK_EQ_U(reply[0], TMC_FRAME_SYNC);
+            HOST_CHECK_EQ_U(reply[1], TMC_FRAME_MASTER_ADDR);
+            HOST_CHECK_EQ_U(reply[2] & 0x7F, reg);
+            HOST_CHECK_EQ_U(ref_crc(reply, 7), reply[7]);
+        }
+    }
+    HOST_CHECK(accepted > 0);
+}
+
+int main(void)
+{
+    test_crc_matches_reference();
+    test_encode_layout();
+    test_round_trip();
+    test_echo_only_and_truncated();
+    test_corrupt_reply();
+    test_wrong_reg_and_last_reply();
+    test_fuzz();
+    return HOST_TEST_RESULT("test_tmc_frame");
+}